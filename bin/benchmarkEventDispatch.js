@@ -0,0 +1,69 @@
+#!/usr/bin/env node
+
+// Measures how long it takes to deliver entry events to one region as the number of regions with
+// event listeners grows. Run it after building the debug addon; it only uses LOCAL regions, so no
+// server is needed.
+
+const async = require("async");
+
+const gemfire = require("../spec/support/gemfire.js");
+gemfire.configure("xml/ExampleClient.xml");
+const cache = gemfire.getCache();
+
+const eventCount = 20000;
+const regionCounts = [1, 10, 40, 100];
+const lookupsPerRegion = 10;
+
+var keyPrefix = 0;
+
+function getOrCreateRegion(name) {
+  return cache.getRegion(name) || cache.createRegion(name, {type: "LOCAL"});
+}
+
+function benchmark(regionCount, callback) {
+  const regions = [];
+  for (var i = 0; i < regionCount; i++) {
+    const region = getOrCreateRegion("eventDispatchBenchmark" + i);
+
+    // Looking a region up repeatedly used to leave a wrapper behind for every lookup.
+    for (var j = 0; j < lookupsPerRegion; j++) {
+      cache.getRegion(region.name).on("update", function() {});
+    }
+
+    regions.push(region);
+  }
+
+  const target = regions[0];
+  const prefix = "benchmark" + (keyPrefix++) + "-";
+  var received = 0;
+  var startedAt;
+
+  function onCreate() {
+    received++;
+    if (received < eventCount) {
+      return;
+    }
+
+    const elapsed = process.hrtime(startedAt);
+    const milliseconds = elapsed[0] * 1e3 + elapsed[1] / 1e6;
+
+    console.log(regionCount + " regions: " + eventCount + " events in " + milliseconds.toFixed(1) + " ms (" +
+                (eventCount / milliseconds).toFixed(1) + " events/ms)");
+
+    target.removeListener("create", onCreate);
+    regions.forEach(function(region) { region.removeAllListeners("update"); });
+    callback();
+  }
+
+  target.on("create", onCreate);
+
+  startedAt = process.hrtime();
+  for (var k = 0; k < eventCount; k++) {
+    target.putSync(prefix + k, k);
+  }
+}
+
+async.eachSeries(regionCounts, benchmark, function() {
+  cache.close();
+  process.exit(0);
+});
@@ -23,6 +23,7 @@
       "src/cache.cpp",
       "src/region.cpp",
       "src/select_results.cpp",
+      "src/aggregation.cpp",
       "src/gemfire_worker.cpp",
       "src/streaming_result_collector.cpp",
       "src/result_stream.cpp",
@@ -31,7 +32,21 @@
       "src/region_event_listener.cpp",
       "src/region_event_registry.cpp",
       "src/event_stream.cpp",
+      "src/event_payload.cpp",
+      "src/continuous_query.cpp",
+      "src/key_watchers.cpp",
+      "src/query_cache.cpp",
+      "src/query_result_cache.cpp",
+      "src/prepared_query.cpp",
       "src/region_shortcuts.cpp",
+      "src/decoded_value_cache.cpp",
+      "src/negative_cache.cpp",
+      "src/loader.cpp",
+      "src/write_behind_buffer.cpp",
+      "src/keyed_work_queue.cpp",
+      "src/cancel_token.cpp",
+      "src/operation_options.cpp",
+      "src/work_limiter.cpp",
     ]
   },
   "targets": [
@@ -1,6 +1,9 @@
 const nodePreGyp = require('node-pre-gyp');
 const path = require('path');
 const EventEmitter = require('events').EventEmitter;
+const SelectResultsCursor = require('./select_results_cursor.js');
+const QueryStream = require('./query_stream.js');
+const FunctionResultStream = require('./function_result_stream.js');
 
 function inherits(target, source) {
   for (var key in source.prototype) {
@@ -8,6 +11,60 @@ function inherits(target, source) {
   }
 }
 
+// Shared by caches and regions, whose executeFunction() takes the same options.
+function executeFunctionStream(functionName, options) {
+  if (Array.isArray(options)) {
+    options = { arguments: options };
+  } else if (options === undefined) {
+    options = {};
+  } else if (typeof options !== "object" || options === null) {
+    throw new Error(
+      "You must pass either an Array of arguments or an options Object to executeFunctionStream()."
+    );
+  }
+
+  if (options.synchronous) {
+    throw new Error("executeFunctionStream: the synchronous option is not supported.");
+  }
+
+  // The stream counts single results against its highWaterMark.
+  if (options.batch) {
+    throw new Error("executeFunctionStream: the batch option is not supported.");
+  }
+
+  const highWaterMark = (options.highWaterMark !== undefined) ?
+    options.highWaterMark : FunctionResultStream.defaultHighWaterMark;
+
+  if (!(highWaterMark > 0 && highWaterMark % 1 === 0)) {
+    throw new Error("executeFunctionStream: highWaterMark must be a positive integer.");
+  }
+
+  const executeOptions = {};
+  for (var key in options) {
+    executeOptions[key] = options[key];
+  }
+  executeOptions.highWaterMark = highWaterMark;
+
+  const stream = new FunctionResultStream(highWaterMark);
+  stream.attach(this.executeFunction(functionName, executeOptions));
+
+  return stream;
+}
+
+// Regions only ask GemFire for entry events while something listens for them. The "newListener" and
+// "removeListener" events can't drive this on their own: the former is emitted before the listener is
+// added, and removeAllListeners() removes listeners for both of them too.
+function subscribeOnDemand(target) {
+  ["addListener", "on", "once", "removeListener", "removeAllListeners"].forEach(function(methodName) {
+    const method = target.prototype[methodName];
+    target.prototype[methodName] = function() {
+      const result = method.apply(this, arguments);
+      this._updateEventSubscriptions();
+      return result;
+    };
+  });
+}
+
 module.exports = function binding(options) {
   const bindingPath = nodePreGyp.find(
     path.resolve(path.join(__dirname,'../package.json')),
@@ -42,10 +99,63 @@ module.exports = function binding(options) {
     return cacheSingleton;
   };
 
+  inherits(Cache, EventEmitter);
   delete gemfire.Cache;
 
+  Cache.prototype.queryStream = function queryStream(query, parameters, options) {
+    if (typeof query !== "string") {
+      throw new Error("You must pass a query string to queryStream().");
+    }
+
+    if (!Array.isArray(parameters)) {
+      options = parameters;
+      parameters = undefined;
+    }
+
+    if (options === undefined) {
+      options = {};
+    } else if (typeof options !== "object" || options === null) {
+      throw new Error("You must pass an options object to queryStream().");
+    }
+
+    const pageSize = (options.pageSize !== undefined) ? options.pageSize : QueryStream.defaultPageSize;
+    if (!(pageSize > 0 && pageSize % 1 === 0)) {
+      throw new Error("queryStream: pageSize must be a positive integer.");
+    }
+
+    const stream = new QueryStream(pageSize);
+    const callback = stream.receive.bind(stream);
+
+    if (parameters) {
+      this.executeQuery(query, parameters, options, callback);
+    } else {
+      this.executeQuery(query, options, callback);
+    }
+
+    return stream;
+  };
+
+  Cache.prototype.executeFunctionStream = executeFunctionStream;
+
   inherits(gemfire.Region, EventEmitter);
+  gemfire.Region.prototype.executeFunctionStream = executeFunctionStream;
+  subscribeOnDemand(gemfire.Region);
   delete gemfire.Region;
 
+  inherits(gemfire.ContinuousQuery, EventEmitter);
+  delete gemfire.ContinuousQuery;
+
+  gemfire.SelectResults.prototype.cursor = function cursor(options) {
+    const chunkSize = (options && options.chunkSize !== undefined) ?
+      options.chunkSize : SelectResultsCursor.defaultChunkSize;
+
+    if (!(chunkSize > 0 && chunkSize % 1 === 0)) {
+      throw new Error("cursor: chunkSize must be a positive integer.");
+    }
+
+    return new SelectResultsCursor(this, chunkSize);
+  };
+  delete gemfire.SelectResults;
+
   return gemfire;
 };
@@ -0,0 +1,66 @@
+const Readable = require('stream').Readable;
+
+// A readable stream of the results of a function. The emitter returned by executeFunction() is
+// paused whenever the stream's buffer is full and resumed when the consumer reads, and while it is
+// paused the native collector waits once it holds highWaterMark results, so a slow consumer holds
+// back the function instead of letting its results pile up in memory.
+function FunctionResultStream(highWaterMark) {
+  Readable.call(this, {objectMode: true, highWaterMark: highWaterMark});
+
+  this.emitter = null;
+  this.destroyed = false;
+}
+
+FunctionResultStream.prototype = Object.create(Readable.prototype, {
+  constructor: { value: FunctionResultStream }
+});
+
+// Takes over the emitter returned by executeFunction() with the highWaterMark option.
+FunctionResultStream.prototype.attach = function attach(emitter) {
+  const stream = this;
+
+  this.emitter = emitter;
+  emitter.pause();
+
+  emitter.on("data", function(result) {
+    // Null would end the stream, so it can't be passed on.
+    if (result === null || result === undefined) {
+      return;
+    }
+
+    if (!stream.push(result)) {
+      emitter.pause();
+    }
+  });
+
+  emitter.on("error", function(error) {
+    stream.emit("error", error);
+  });
+
+  emitter.on("end", function() {
+    stream.push(null);
+  });
+};
+
+FunctionResultStream.prototype._read = function _read() {
+  if (this.emitter && !this.destroyed) {
+    this.emitter.resume();
+  }
+};
+
+// Stops reading and drops the remaining results, for consumers that give up early.
+FunctionResultStream.prototype.destroy = function destroy() {
+  if (this.destroyed) {
+    return;
+  }
+
+  this.destroyed = true;
+  if (this.emitter) {
+    this.emitter.destroy();
+  }
+  this.emit("close");
+};
+
+FunctionResultStream.defaultHighWaterMark = 1000;
+
+module.exports = FunctionResultStream;
@@ -0,0 +1,85 @@
+const Readable = require('stream').Readable;
+
+// A readable stream of query results, in pages of rows. Each page is converted to JavaScript only
+// when the consumer asks for more, so a slow consumer holds at most a page or two of converted
+// rows, and the native results are released as soon as the last page has been read.
+function QueryStream(pageSize) {
+  Readable.call(this, {objectMode: true, highWaterMark: 1});
+
+  this.pageSize = pageSize;
+  this.position = 0;
+  this.selectResults = null;
+  this.reading = false;
+  this.destroyed = false;
+}
+
+QueryStream.prototype = Object.create(Readable.prototype, {
+  constructor: { value: QueryStream }
+});
+
+// Called back by cache.executeQuery() once the results have arrived.
+QueryStream.prototype.receive = function receive(error, selectResults) {
+  if (this.destroyed) {
+    if (selectResults) {
+      selectResults.release();
+    }
+    return;
+  }
+
+  if (error) {
+    this.emit("error", error);
+    return;
+  }
+
+  this.selectResults = selectResults;
+  if (this.reading) {
+    this._read();
+  }
+};
+
+QueryStream.prototype._read = function _read() {
+  if (this.destroyed) {
+    return;
+  }
+
+  if (!this.selectResults) {
+    this.reading = true;
+    return;
+  }
+
+  var page;
+  try {
+    page = this.selectResults.slice(this.position, this.position + this.pageSize);
+  } catch (error) {
+    this.emit("error", error);
+    return;
+  }
+
+  this.position += page.length;
+
+  if (page.length > 0) {
+    this.push(page);
+  }
+
+  if (this.position >= this.selectResults.length) {
+    this.selectResults.release();
+    this.push(null);
+  }
+};
+
+// Stops reading and releases the results, for consumers that give up early.
+QueryStream.prototype.destroy = function destroy() {
+  if (this.destroyed) {
+    return;
+  }
+
+  this.destroyed = true;
+  if (this.selectResults) {
+    this.selectResults.release();
+  }
+  this.emit("close");
+};
+
+QueryStream.defaultPageSize = 1000;
+
+module.exports = QueryStream;
@@ -0,0 +1,32 @@
+// Walks select results in chunks. Each call to next() converts one chunk on a later tick, so that
+// large results never hold up the event loop for longer than a chunk takes.
+function SelectResultsCursor(selectResults, chunkSize) {
+  this.selectResults = selectResults;
+  this.chunkSize = chunkSize;
+  this.position = 0;
+}
+
+// Calls back with the next chunk of rows, or with null once every row has been passed.
+SelectResultsCursor.prototype.next = function next(callback) {
+  if (typeof callback !== "function") {
+    throw new Error("You must pass a callback to next().");
+  }
+
+  const cursor = this;
+  setImmediate(function() {
+    var rows;
+    try {
+      rows = cursor.selectResults.slice(cursor.position, cursor.position + cursor.chunkSize);
+    } catch (error) {
+      callback(error);
+      return;
+    }
+
+    cursor.position += rows.length;
+    callback(null, rows.length > 0 ? rows : null);
+  });
+};
+
+SelectResultsCursor.defaultChunkSize = 100;
+
+module.exports = SelectResultsCursor;
@@ -112,6 +112,10 @@ describe("gemfire.Cache", function() {
       expect(region.constructor.name).toEqual("Region");
     });
 
+    it("returns the same object for every call", function() {
+      expect(cache.getRegion("exampleRegion")).toBe(cache.getRegion("exampleRegion"));
+    });
+
     it("returns undefined if the region is unknown", function(){
       expect(cache.getRegion("there is no such region")).toBeUndefined();
     });
@@ -554,6 +558,307 @@ describe("gemfire.Cache", function() {
     });
   });
 
+  describe(".prepareQuery", function() {
+    var cache, region;
+
+    beforeEach(function(done) {
+      cache = factories.getCache();
+      region = cache.getRegion("exampleRegion");
+      region.clear(done);
+    });
+
+    it("returns a query that can be executed with different parameters", function(done) {
+      const query = cache.prepareQuery("SELECT DISTINCT * FROM /exampleRegion r WHERE r = $1", {poolName: "myPool"});
+      expect(query.query).toEqual("SELECT DISTINCT * FROM /exampleRegion r WHERE r = $1");
+
+      async.series([
+        function(next) { region.put("foo", "bar", next); },
+        function(next) { region.put("baz", "qux", next); },
+        function(next) {
+          query.execute(["bar"], function(error, response) {
+            expect(error).not.toBeError();
+            expect(response.toArray()).toEqual(["bar"]);
+            next();
+          });
+        },
+        function(next) {
+          query.execute(["qux"], {timeout: 5000}, function(error, response) {
+            expect(error).not.toBeError();
+            expect(response.toArray()).toEqual(["qux"]);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("reuses the GemFire query for the same pool and query string", function() {
+      const queryString = "SELECT DISTINCT * FROM /exampleRegion r WHERE r = $1 AND r != 'prepareQuery'";
+      const misses = cache.statistics.queryCache.misses;
+      const hits = cache.statistics.queryCache.hits;
+
+      cache.prepareQuery(queryString, {poolName: "myPool"});
+      cache.prepareQuery(queryString, {poolName: "myPool"});
+
+      expect(cache.statistics.queryCache.misses).toEqual(misses + 1);
+      expect(cache.statistics.queryCache.hits).toEqual(hits + 1);
+      expect(cache.statistics.queryCache.maxEntries).toEqual(256);
+    });
+
+    it("shares cached queries with executeQuery", function(done) {
+      const queryString = "SELECT DISTINCT * FROM /exampleRegion r WHERE r = 'shared'";
+      cache.prepareQuery(queryString, {poolName: "myPool"});
+      const hits = cache.statistics.queryCache.hits;
+
+      cache.executeQuery(queryString, {poolName: "myPool"}, function(error) {
+        expect(error).not.toBeError();
+        expect(cache.statistics.queryCache.hits).toEqual(hits + 1);
+        done();
+      });
+    });
+
+    it("passes an error to the callback for invalid queries", function(done) {
+      cache.prepareQuery("INVALID;", {poolName: "myPool"}).execute(function(error, results) {
+        expect(error).toBeError("gemfire::QueryException");
+        expect(results).toBeUndefined();
+        done();
+      });
+    });
+
+    it("requires a query string", function() {
+      expect(function() { cache.prepareQuery(); }).toThrow(
+        new Error("You must pass a query string to prepareQuery().")
+      );
+    });
+
+    it("throws an error for an invalid poolName", function() {
+      expect(function() { cache.prepareQuery("SELECT * FROM /exampleRegion", {poolName: "invalidPool"}); }).toThrow(
+        new Error("prepareQuery: `invalidPool` is not a valid pool name")
+      );
+    });
+
+    it("requires a callback to execute", function() {
+      const query = cache.prepareQuery("SELECT * FROM /exampleRegion", {poolName: "myPool"});
+
+      expect(function() { query.execute(["foo"]); }).toThrow(
+        new Error("You must pass a function as the callback to execute().")
+      );
+    });
+
+    it("requires an array of parameters", function() {
+      const query = cache.prepareQuery("SELECT * FROM /exampleRegion", {poolName: "myPool"});
+
+      expect(function() { query.execute("foo", {}, function() {}); }).toThrow(
+        new Error("You must pass an array of parameters to execute().")
+      );
+    });
+  });
+
+  describe(".queryStream", function() {
+    var cache, region;
+
+    beforeEach(function(done) {
+      cache = factories.getCache();
+      region = cache.getRegion("exampleRegion");
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) { region.putAll({a: 1, b: 2, c: 3, d: 4, e: 5}, next); }
+      ], done);
+    });
+
+    function readAll(stream, callback) {
+      const pages = [];
+      stream.on("data", function(page) { pages.push(page); });
+      stream.on("error", callback);
+      stream.on("end", function() { callback(null, pages); });
+    }
+
+    it("streams the results in pages", function(done) {
+      const stream = cache.queryStream("SELECT * FROM /exampleRegion", {poolName: "myPool", pageSize: 2});
+
+      readAll(stream, function(error, pages) {
+        expect(error).not.toBeError();
+        expect(pages.map(function(page) { return page.length; })).toEqual([2, 2, 1]);
+        expect(_.flatten(pages).sort()).toEqual([1, 2, 3, 4, 5]);
+        done();
+      });
+    });
+
+    it("binds parameters", function(done) {
+      const stream = cache.queryStream("SELECT * FROM /exampleRegion r WHERE r > $1", [3], {poolName: "myPool"});
+
+      readAll(stream, function(error, pages) {
+        expect(error).not.toBeError();
+        expect(_.flatten(pages).sort()).toEqual([4, 5]);
+        done();
+      });
+    });
+
+    it("ends without pages for empty results", function(done) {
+      const stream = cache.queryStream("SELECT * FROM /exampleRegion r WHERE r > 10", {poolName: "myPool"});
+
+      readAll(stream, function(error, pages) {
+        expect(error).not.toBeError();
+        expect(pages).toEqual([]);
+        done();
+      });
+    });
+
+    it("emits an error for invalid queries", function(done) {
+      cache.queryStream("INVALID;", {poolName: "myPool"}).on("error", function(error) {
+        expect(error).toBeError("gemfire::QueryException");
+        done();
+      }).resume();
+    });
+
+    it("requires a query string", function() {
+      expect(function() { cache.queryStream(); }).toThrow(
+        new Error("You must pass a query string to queryStream().")
+      );
+    });
+
+    it("requires a positive integer pageSize", function() {
+      expect(function() { cache.queryStream("SELECT * FROM /exampleRegion", {pageSize: 0}); }).toThrow(
+        new Error("queryStream: pageSize must be a positive integer.")
+      );
+    });
+  });
+
+  describe(".executeCq", function() {
+    var cache, region, continuousQuery;
+
+    beforeEach(function(done) {
+      cache = factories.getCache();
+      region = cache.getRegion("exampleRegion");
+      region.clear(done);
+    });
+
+    afterEach(function() {
+      if (continuousQuery) {
+        continuousQuery.close();
+        continuousQuery = null;
+      }
+    });
+
+    it("emits the initial results once the query has started", function(done) {
+      async.series([
+        function(next) { region.put("foo", "bar", next); },
+        function(next) { region.put("baz", "qux", next); },
+        function(next) {
+          const query = "SELECT * FROM /exampleRegion r WHERE r = 'bar'";
+          continuousQuery = cache.executeCq(query, {poolName: "myPool", initialResults: true});
+
+          continuousQuery.on("initialResults", function(results) {
+            expect(results.toArray().length).toEqual(1);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("emits only the changes that match the query", function(done) {
+      const query = "SELECT * FROM /exampleRegion r WHERE r = 'match'";
+      continuousQuery = cache.executeCq(query, {poolName: "myPool"});
+
+      continuousQuery.on("create", function(event) {
+        expect(event.key).toEqual("matching");
+        expect(event.newValue).toEqual("match");
+        done();
+      });
+
+      continuousQuery.on("ready", function() {
+        async.series([
+          function(next) { region.put("other", "no match", next); },
+          function(next) { region.put("matching", "match", next); }
+        ]);
+      });
+    });
+
+    it("stops emitting events once it is closed", function(done) {
+      const query = "SELECT * FROM /exampleRegion r WHERE r = 'match'";
+      const closedQuery = cache.executeCq(query, {poolName: "myPool"});
+      const callback = jasmine.createSpy("callback");
+
+      closedQuery.on("create", callback);
+
+      closedQuery.on("ready", function() {
+        closedQuery.close();
+
+        region.put("matching", "match", function() {
+          setTimeout(function() {
+            expect(callback).not.toHaveBeenCalled();
+            done();
+          }, 100);
+        });
+      });
+    });
+
+    it("emits nothing once it is closed while it is executing", function(done) {
+      const query = "SELECT * FROM /exampleRegion";
+      const closedQuery = cache.executeCq(query, {poolName: "myPool", initialResults: true});
+      const callback = jasmine.createSpy("callback");
+
+      closedQuery.on("initialResults", callback);
+      closedQuery.on("ready", callback);
+      closedQuery.close();
+
+      setTimeout(function() {
+        expect(callback).not.toHaveBeenCalled();
+        done();
+      }, 100);
+    });
+
+    it("reports its events in its statistics", function(done) {
+      continuousQuery = cache.executeCq("SELECT * FROM /exampleRegion", {poolName: "myPool"});
+
+      continuousQuery.on("ready", function() {
+        expect(continuousQuery.statistics.creates).toEqual(0);
+        expect(continuousQuery.statistics.eventQueue.queued).toEqual(0);
+        done();
+      });
+    });
+
+    it("emits an error for an invalid query", function(done) {
+      const invalidQuery = cache.executeCq("INVALID", {poolName: "myPool"});
+
+      invalidQuery.on("error", function(error) {
+        expect(error).toBeError();
+        invalidQuery.close();
+        done();
+      });
+    });
+
+    it("requires a query string", function() {
+      expect(function() { cache.executeCq(); }).toThrow(
+        new Error("You must pass a query string to executeCq().")
+      );
+    });
+
+    it("does not take parameters", function() {
+      expect(function() { cache.executeCq("SELECT * FROM /exampleRegion WHERE foo = $1", ["bar"]); }).toThrow(
+        new Error("executeCq: continuous queries don't take parameters.")
+      );
+    });
+
+    it("requires an options object", function() {
+      expect(function() { cache.executeCq("SELECT * FROM /exampleRegion", "myPool"); }).toThrow(
+        new Error("You must pass an options object to executeCq().")
+      );
+    });
+
+    it("requires a boolean initialResults", function() {
+      expect(function() { cache.executeCq("SELECT * FROM /exampleRegion", {initialResults: "yes"}); }).toThrow(
+        new Error("executeCq: initialResults must be true or false.")
+      );
+    });
+
+    it("throws an error for an invalid poolName", function() {
+      expect(function() { cache.executeCq("SELECT * FROM /exampleRegion", {poolName: "invalidPool"}); }).toThrow(
+        new Error("executeCq: `invalidPool` is not a valid pool name")
+      );
+    });
+  });
+
   describe(".inspect", function() {
     it("returns a user-friendly display string describing the cache", function() {
       expect(factories.getCache().inspect()).toEqual('[Cache]');
@@ -575,6 +880,281 @@ describe("gemfire.Cache", function() {
     });
   });
 
+  describe(".setLimits", function() {
+    afterEach(function() {
+      factories.getCache().setLimits(null);
+    });
+
+    it("reports no limits in its statistics by default", function() {
+      expect(factories.getCache().statistics.limits).toBeNull();
+    });
+
+    it("rejects queries beyond maxInFlight", function(done) {
+      const cache = factories.getCache();
+      cache.setLimits({maxInFlight: 1});
+
+      cache.executeQuery("SELECT * FROM /exampleRegion", function(error) {
+        expect(error).toBeUndefined();
+        done();
+      });
+
+      function queryBeyondMaxInFlight() {
+        cache.executeQuery("SELECT * FROM /exampleRegion", function() {});
+      }
+
+      expect(queryBeyondMaxInFlight).toThrow(new Error("Too many operations are in flight for this cache."));
+      expect(cache.statistics.limits.rejected).toEqual(1);
+    });
+
+    it("applies to region operations", function(done) {
+      const cache = factories.getCache();
+      const region = cache.getRegion("exampleRegion");
+      cache.setLimits({maxInFlight: 1});
+
+      region.put("foo", "bar", function(error) {
+        expect(error).toBeUndefined();
+        done();
+      });
+
+      function putBeyondMaxInFlight() {
+        region.put("baz", "qux");
+      }
+
+      expect(putBeyondMaxInFlight).toThrow(new Error("Too many operations are in flight for this cache."));
+    });
+  });
+
+  describe(".setEventQueueOptions", function() {
+    afterEach(function() {
+      factories.getCache().setEventQueueOptions(null);
+    });
+
+    it("reports an unbounded event queue in its statistics by default", function() {
+      const eventQueue = factories.getCache().statistics.eventQueue;
+
+      expect(eventQueue.maxEvents).toBeNull();
+      expect(eventQueue.policy).toBeNull();
+      expect(eventQueue.lag).not.toBeLessThan(0);
+    });
+
+    it("reports the options in its statistics", function() {
+      const cache = factories.getCache();
+      cache.setEventQueueOptions({maxEvents: 100, policy: "conflate"});
+
+      expect(cache.statistics.eventQueue.maxEvents).toEqual(100);
+      expect(cache.statistics.eventQueue.policy).toEqual("conflate");
+    });
+
+    it("defaults to the drop-oldest policy", function() {
+      const cache = factories.getCache();
+      cache.setEventQueueOptions({maxEvents: 100});
+
+      expect(cache.statistics.eventQueue.policy).toEqual("drop-oldest");
+    });
+
+    it("drops events beyond maxEvents until they are delivered", function(done) {
+      const cache = factories.getCache();
+      const region = cache.getRegion("exampleRegion");
+      const droppedBefore = cache.statistics.eventQueue.dropped;
+
+      cache.setEventQueueOptions({maxEvents: 2, policy: "drop-newest"});
+
+      for (var i = 0; i < 5; i++) {
+        region.putSync("eventQueue" + i, i);
+      }
+
+      expect(cache.statistics.eventQueue.dropped).toBeGreaterThan(droppedBefore + 2);
+
+      setTimeout(function() {
+        expect(cache.statistics.eventQueue.queued).toEqual(0);
+        expect(cache.statistics.eventQueue.lag).toEqual(0);
+        done();
+      }, 100);
+    });
+
+    it("requires an options object", function() {
+      function callWithString() {
+        factories.getCache().setEventQueueOptions("foo");
+      }
+
+      expect(callWithString).toThrow(
+        new Error("You must pass an options object or null to setEventQueueOptions().")
+      );
+    });
+
+    it("requires a positive maxEvents", function() {
+      function callWithZero() {
+        factories.getCache().setEventQueueOptions({maxEvents: 0});
+      }
+
+      expect(callWithZero).toThrow(new Error("setEventQueueOptions: maxEvents must be a positive integer."));
+    });
+
+    it("requires a known policy", function() {
+      function callWithUnknownPolicy() {
+        factories.getCache().setEventQueueOptions({maxEvents: 10, policy: "foo"});
+      }
+
+      expect(callWithUnknownPolicy).toThrow(new Error(
+        'setEventQueueOptions: policy must be "drop-oldest", "drop-newest", "block" or "conflate".'
+      ));
+    });
+  });
+
+  describe(".setQueryResultCache", function() {
+    const queryString = "SELECT DISTINCT * FROM /exampleRegion r WHERE r != 'setQueryResultCache'";
+    var cache, region;
+
+    beforeEach(function(done) {
+      cache = factories.getCache();
+      region = cache.getRegion("exampleRegion");
+      region.clear(done);
+    });
+
+    afterEach(function() {
+      cache.setQueryResultCache(null);
+    });
+
+    // Results are only cached by queries that run after the events of earlier writes are delivered.
+    function delivered(next) {
+      setTimeout(next, 100);
+    }
+
+    function query(callback) {
+      cache.executeQuery(queryString, {poolName: "myPool"}, function(error, response) {
+        expect(error).not.toBeError();
+        callback(response.toArray());
+      });
+    }
+
+    it("reports no query result cache in its statistics by default", function() {
+      expect(cache.statistics.queryResultCache).toBeNull();
+    });
+
+    it("answers repeated queries from the cache", function(done) {
+      cache.setQueryResultCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) { region.put("foo", "bar", next); },
+        delivered,
+        function(next) { query(function() { next(); }); },
+        function(next) {
+          query(function(results) {
+            expect(results).toEqual(["bar"]);
+            expect(cache.statistics.queryResultCache.hits).toEqual(1);
+            expect(cache.statistics.queryResultCache.misses).toEqual(1);
+            expect(cache.statistics.queryResultCache.entries).toEqual(1);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("invalidates results when a region the query refers to changes", function(done) {
+      cache.setQueryResultCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) { region.put("foo", "bar", next); },
+        function(next) { query(function() { next(); }); },
+        function(next) { region.put("baz", "qux", next); },
+        function(next) {
+          query(function(results) {
+            expect(results.sort()).toEqual(["bar", "qux"]);
+            expect(cache.statistics.queryResultCache.invalidations).toBeGreaterThan(0);
+            expect(cache.statistics.queryResultCache.hits).toEqual(0);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("keeps results apart by parameters", function(done) {
+      const parameterized = "SELECT DISTINCT * FROM /exampleRegion r WHERE r = $1";
+      cache.setQueryResultCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) { region.putAll({foo: "bar", baz: "qux"}, next); },
+        delivered,
+        function(next) { cache.executeQuery(parameterized, ["bar"], {poolName: "myPool"}, next); },
+        function(next) {
+          cache.executeQuery(parameterized, ["qux"], {poolName: "myPool"}, function(error, response) {
+            expect(error).not.toBeError();
+            expect(response.toArray()).toEqual(["qux"]);
+            expect(cache.statistics.queryResultCache.entries).toEqual(2);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("doesn't cache queries with parameters other than strings, numbers and booleans", function(done) {
+      const parameterized = "SELECT DISTINCT * FROM /exampleRegion r WHERE r = $1";
+      const date = new Date(0);
+      cache.setQueryResultCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) { cache.executeQuery(parameterized, [date], {poolName: "myPool"}, next); },
+        function(next) {
+          cache.executeQuery(parameterized, [date.toJSON()], {poolName: "myPool"}, function(error) {
+            expect(error).not.toBeError();
+            expect(cache.statistics.queryResultCache.entries).toEqual(1);
+            expect(cache.statistics.queryResultCache.hits).toEqual(0);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("expires results after the ttl", function(done) {
+      cache.setQueryResultCache({ttl: 10, maxEntries: 10});
+
+      delivered(function() {
+        query(function() {
+          setTimeout(function() {
+            query(function() {
+              expect(cache.statistics.queryResultCache.hits).toEqual(0);
+              expect(cache.statistics.queryResultCache.expirations).toEqual(1);
+              done();
+            });
+          }, 50);
+        });
+      });
+    });
+
+    it("caches the results of region.query()", function(done) {
+      cache.setQueryResultCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) { region.put("foo", "bar", next); },
+        delivered,
+        function(next) { region.query("this = 'bar'", next); },
+        function(next) {
+          region.query("this = 'bar'", function(error, response) {
+            expect(error).not.toBeError();
+            expect(response.toArray()).toEqual(["bar"]);
+            expect(cache.statistics.queryResultCache.hits).toEqual(1);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("requires an options object", function() {
+      expect(function() { cache.setQueryResultCache("foo"); }).toThrow(
+        new Error("You must pass an options object or null to setQueryResultCache().")
+      );
+    });
+
+    it("requires a positive ttl and maxEntries", function() {
+      expect(function() { cache.setQueryResultCache({ttl: 0, maxEntries: 10}); }).toThrow(
+        new Error("setQueryResultCache: ttl must be a positive number of milliseconds.")
+      );
+      expect(function() { cache.setQueryResultCache({ttl: 1000}); }).toThrow(
+        new Error("setQueryResultCache: maxEntries must be a positive integer.")
+      );
+    });
+  });
+
   describe(".executeFunction", function() {
     const expectFunctionsToThrowExceptionsCorrectly = false;
     itExecutesFunctions(
@@ -1,8 +1,18 @@
 #include <v8.h>
 #include <nan.h>
+#include <uv.h>
+#include <stdio.h>
 #include <string>
+#include <vector>
 #include "../../src/conversions.hpp"
 #include "../../src/region_shortcuts.hpp"
+#include "../../src/decoded_value_cache.hpp"
+#include "../../src/negative_cache.hpp"
+#include "../../src/query_result_cache.hpp"
+#include "../../src/keyed_work_queue.hpp"
+#include "../../src/event_stream.hpp"
+#include "../../src/result_stream.hpp"
+#include "../../src/streaming_result_collector.hpp"
 #include "gtest/gtest.h"
 
 using namespace v8;
@@ -130,6 +140,579 @@ TEST(getRegionShortcut, incorrectShortcut) {
   EXPECT_NE(gemfire::LOCAL_ENTRY_LRU, getRegionShortcut("NULL"));
 }
 
+TEST(DecodedValueCache, returnsCachedValueForSameGemfireValue) {
+  NanScope();
+
+  DecodedValueCache decodedValueCache(10, 0);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+  gemfire::CacheablePtr valuePtr(gemfire::CacheableString::create("bar"));
+  Local<Object> value(NanNew<Object>());
+
+  decodedValueCache.set(keyPtr, valuePtr, value);
+
+  EXPECT_TRUE(decodedValueCache.get(keyPtr, valuePtr)->StrictEquals(value));
+}
+
+TEST(DecodedValueCache, dropsEntryForDifferentGemfireValue) {
+  NanScope();
+
+  DecodedValueCache decodedValueCache(10, 0);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+
+  decodedValueCache.set(keyPtr, gemfire::CacheableString::create("bar"), NanNew<Object>());
+
+  EXPECT_TRUE(decodedValueCache.get(keyPtr, gemfire::CacheableString::create("bar")).IsEmpty());
+  EXPECT_EQ(0u, decodedValueCache.size());
+}
+
+TEST(DecodedValueCache, evictsLeastRecentlyUsedEntries) {
+  NanScope();
+
+  DecodedValueCache decodedValueCache(2, 0);
+  gemfire::CacheableKeyPtr firstKeyPtr(gemfire::CacheableString::create("first"));
+  gemfire::CacheableKeyPtr secondKeyPtr(gemfire::CacheableString::create("second"));
+  gemfire::CacheableKeyPtr thirdKeyPtr(gemfire::CacheableString::create("third"));
+  gemfire::CacheablePtr valuePtr(gemfire::CacheableString::create("value"));
+
+  decodedValueCache.set(firstKeyPtr, valuePtr, NanNew<Object>());
+  decodedValueCache.set(secondKeyPtr, valuePtr, NanNew<Object>());
+  decodedValueCache.get(firstKeyPtr, valuePtr);
+  decodedValueCache.set(thirdKeyPtr, valuePtr, NanNew<Object>());
+
+  EXPECT_EQ(2u, decodedValueCache.size());
+  EXPECT_FALSE(decodedValueCache.get(firstKeyPtr, valuePtr).IsEmpty());
+  EXPECT_TRUE(decodedValueCache.get(secondKeyPtr, valuePtr).IsEmpty());
+}
+
+TEST(NegativeCache, remembersMissingKeys) {
+  NegativeCache negativeCache(60000, 10, false);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+
+  EXPECT_FALSE(negativeCache.contains(keyPtr));
+  negativeCache.add(keyPtr, negativeCache.epoch(keyPtr));
+  EXPECT_TRUE(negativeCache.contains(keyPtr));
+
+  negativeCache.invalidate(keyPtr);
+  EXPECT_FALSE(negativeCache.contains(keyPtr));
+}
+
+TEST(NegativeCache, ignoresMissesObservedBeforeAnInvalidation) {
+  NegativeCache negativeCache(60000, 10, false);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+
+  uint64_t epoch = negativeCache.epoch(keyPtr);
+  negativeCache.invalidate(keyPtr);
+  negativeCache.add(keyPtr, epoch);
+
+  EXPECT_FALSE(negativeCache.contains(keyPtr));
+}
+
+TEST(NegativeCache, keepsMissesWhenOtherKeysAreInvalidated) {
+  NegativeCache negativeCache(60000, 10, false);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+  gemfire::CacheableKeyPtr otherKeyPtr(gemfire::CacheableString::create("bar"));
+
+  uint64_t epoch = negativeCache.epoch(keyPtr);
+  negativeCache.invalidate(otherKeyPtr);
+  negativeCache.add(keyPtr, epoch);
+
+  EXPECT_TRUE(negativeCache.contains(keyPtr));
+}
+
+TEST(NegativeCache, ignoresMissesObservedBeforeAClear) {
+  NegativeCache negativeCache(60000, 10, false);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+
+  uint64_t epoch = negativeCache.epoch(keyPtr);
+  negativeCache.clear();
+  negativeCache.add(keyPtr, epoch);
+
+  EXPECT_FALSE(negativeCache.contains(keyPtr));
+}
+
+TEST(NegativeCache, forgetsOldestKeysBeyondMaxEntries) {
+  NegativeCache negativeCache(60000, 1, false);
+  gemfire::CacheableKeyPtr firstKeyPtr(gemfire::CacheableString::create("first"));
+  gemfire::CacheableKeyPtr secondKeyPtr(gemfire::CacheableString::create("second"));
+
+  negativeCache.add(firstKeyPtr, negativeCache.epoch(firstKeyPtr));
+  negativeCache.add(secondKeyPtr, negativeCache.epoch(secondKeyPtr));
+
+  EXPECT_FALSE(negativeCache.contains(firstKeyPtr));
+  EXPECT_TRUE(negativeCache.contains(secondKeyPtr));
+}
+
+TEST(QueryResultCache, ignoresResultsObservedBeforeAnInvalidationOfTheirRegion) {
+  QueryResultCache queryResultCache(60000, 10);
+  std::vector<std::string> regionPaths(1, "/orders");
+  gemfire::SelectResultsPtr selectResultsPtr;
+
+  QueryResultCache::Epochs epochs(queryResultCache.epochs(regionPaths));
+  queryResultCache.invalidate("/orders");
+  queryResultCache.add("orders", regionPaths, gemfire::SelectResultsPtr(), epochs);
+
+  EXPECT_FALSE(queryResultCache.get("orders", selectResultsPtr));
+}
+
+TEST(QueryResultCache, keepsResultsWhenOtherRegionsAreInvalidated) {
+  QueryResultCache queryResultCache(60000, 10);
+  std::vector<std::string> regionPaths(1, "/orders");
+  gemfire::SelectResultsPtr selectResultsPtr;
+
+  QueryResultCache::Epochs epochs(queryResultCache.epochs(regionPaths));
+  queryResultCache.invalidate("/customers");
+  queryResultCache.add("orders", regionPaths, gemfire::SelectResultsPtr(), epochs);
+
+  EXPECT_TRUE(queryResultCache.get("orders", selectResultsPtr));
+}
+
+TEST(QueryResultCache, ignoresResultsObservedBeforeAClear) {
+  QueryResultCache queryResultCache(60000, 10);
+  std::vector<std::string> regionPaths(1, "/orders");
+  gemfire::SelectResultsPtr selectResultsPtr;
+
+  QueryResultCache::Epochs epochs(queryResultCache.epochs(regionPaths));
+  queryResultCache.clear();
+  queryResultCache.add("orders", regionPaths, gemfire::SelectResultsPtr(), epochs);
+
+  EXPECT_FALSE(queryResultCache.get("orders", selectResultsPtr));
+}
+
+class NoopWorker : public NanAsyncWorker {
+ public:
+  NoopWorker() : NanAsyncWorker(NULL) {}
+  void Execute() {}
+};
+
+// Only the identity of the region pointer matters to the queue.
+static char firstRegion, secondRegion;
+
+TEST(KeyedWorkQueue, runsWorkersForTheSameKeyInOrder) {
+  NanScope();
+
+  KeyedWorkQueue keyedWorkQueue;
+  gemfire::Region * regionPtr = reinterpret_cast<gemfire::Region *>(&firstRegion);
+  gemfire::CacheableKeyPtr keyPtr(gemfire::CacheableString::create("foo"));
+  NoopWorker first, second, third;
+
+  EXPECT_TRUE(keyedWorkQueue.add(regionPtr, keyPtr, &first));
+  EXPECT_FALSE(keyedWorkQueue.add(regionPtr, gemfire::CacheableString::create("foo"), &second));
+  EXPECT_FALSE(keyedWorkQueue.add(regionPtr, keyPtr, &third));
+
+  EXPECT_EQ(&second, keyedWorkQueue.next(regionPtr, keyPtr));
+  EXPECT_EQ(&third, keyedWorkQueue.next(regionPtr, keyPtr));
+  EXPECT_TRUE(keyedWorkQueue.next(regionPtr, keyPtr) == NULL);
+  EXPECT_EQ(0u, keyedWorkQueue.size());
+}
+
+TEST(KeyedWorkQueue, runsWorkersForDifferentKeysAndRegionsInParallel) {
+  NanScope();
+
+  KeyedWorkQueue keyedWorkQueue;
+  gemfire::Region * firstRegionPtr = reinterpret_cast<gemfire::Region *>(&firstRegion);
+  gemfire::Region * secondRegionPtr = reinterpret_cast<gemfire::Region *>(&secondRegion);
+  NoopWorker first, second, third;
+
+  EXPECT_TRUE(keyedWorkQueue.add(firstRegionPtr, gemfire::CacheableString::create("foo"), &first));
+  EXPECT_TRUE(keyedWorkQueue.add(firstRegionPtr, gemfire::CacheableString::create("bar"), &second));
+  EXPECT_TRUE(keyedWorkQueue.add(secondRegionPtr, gemfire::CacheableString::create("foo"), &third));
+  EXPECT_EQ(3u, keyedWorkQueue.size());
+}
+
+TEST(KeyedWorkQueue, runsAWorkerForSeveralKeysOnceEveryKeyIsFree) {
+  NanScope();
+
+  KeyedWorkQueue keyedWorkQueue;
+  gemfire::Region * regionPtr = reinterpret_cast<gemfire::Region *>(&firstRegion);
+  gemfire::CacheableKeyPtr fooKeyPtr(gemfire::CacheableString::create("foo"));
+  gemfire::CacheableKeyPtr barKeyPtr(gemfire::CacheableString::create("bar"));
+  NoopWorker first, second, third, fourth;
+
+  KeyedWorkQueue::Keys keys;
+  keys.push_back(fooKeyPtr);
+  keys.push_back(barKeyPtr);
+
+  EXPECT_TRUE(keyedWorkQueue.add(regionPtr, fooKeyPtr, &first));
+  EXPECT_TRUE(keyedWorkQueue.add(regionPtr, barKeyPtr, &second));
+  EXPECT_FALSE(keyedWorkQueue.add(regionPtr, keys, &third));
+  EXPECT_FALSE(keyedWorkQueue.add(regionPtr, fooKeyPtr, &fourth));
+
+  EXPECT_TRUE(keyedWorkQueue.next(regionPtr, fooKeyPtr) == NULL);
+  EXPECT_EQ(&third, keyedWorkQueue.next(regionPtr, barKeyPtr));
+
+  EXPECT_EQ(&fourth, keyedWorkQueue.next(regionPtr, fooKeyPtr));
+  EXPECT_TRUE(keyedWorkQueue.next(regionPtr, barKeyPtr) == NULL);
+  EXPECT_TRUE(keyedWorkQueue.next(regionPtr, fooKeyPtr) == NULL);
+  EXPECT_EQ(0u, keyedWorkQueue.size());
+}
+
+static void noopAsyncCallback(uv_async_t * async, int status) {}
+
+// Adds `eventsPerProducer` events to a stream from its own thread. Each key carries the producer and sequence
+// number so that the consumer can check ordering.
+class EventProducer {
+ public:
+  static const int eventsPerProducer = 100000;
+
+  EventProducer(EventStream * eventStream, int id) :
+    eventStream(eventStream),
+    id(id) {}
+
+  void start() {
+    uv_thread_create(&thread, run, this);
+  }
+
+  void join() {
+    uv_thread_join(&thread);
+  }
+
+ private:
+  static void run(void * data) {
+    EventProducer * producer = reinterpret_cast<EventProducer *>(data);
+
+    for (int i = 0; i < eventsPerProducer; i++) {
+      gemfire::EntryEvent event(NULLPTR,
+                                gemfire::CacheableInt32::create(producer->id * eventsPerProducer + i),
+                                NULLPTR, NULLPTR, NULLPTR, false);
+      producer->eventStream->add("create", event, true);
+    }
+  }
+
+  EventStream * eventStream;
+  int id;
+  uv_thread_t thread;
+};
+
+// Pops events while producers are still adding them, as the main thread does during an event storm.
+static int consumeEvents(EventStream * eventStream, int producerCount, std::vector<int> * lastSequences) {
+  int received = 0;
+  std::vector<EventStream::Event *> events;
+  while (received < producerCount * EventProducer::eventsPerProducer) {
+    events.clear();
+    eventStream->nextEvents(events, 1024);
+
+    for (std::vector<EventStream::Event *>::iterator iterator(events.begin());
+         iterator != events.end();
+         ++iterator) {
+      EventStream::Event * event(*iterator);
+
+      if (lastSequences != NULL) {
+        int keyValue = static_cast<gemfire::CacheableInt32 *>(event->getKey().ptr())->value();
+        int producerId = keyValue / EventProducer::eventsPerProducer;
+        int sequence = keyValue % EventProducer::eventsPerProducer;
+
+        EXPECT_EQ((*lastSequences)[producerId] + 1, sequence);
+        (*lastSequences)[producerId] = sequence;
+      }
+
+      eventStream->release(event);
+      received++;
+    }
+  }
+  return received;
+}
+
+static uint64_t runEventStream(int producerCount, std::vector<int> * lastSequences) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+
+  std::vector<EventProducer *> producers;
+  for (int i = 0; i < producerCount; i++) {
+    producers.push_back(new EventProducer(eventStream, i));
+  }
+
+  uint64_t startedAt = uv_hrtime();
+  for (int i = 0; i < producerCount; i++) {
+    producers[i]->start();
+  }
+
+  EXPECT_EQ(producerCount * EventProducer::eventsPerProducer,
+            consumeEvents(eventStream, producerCount, lastSequences));
+  uint64_t elapsed = uv_hrtime() - startedAt;
+
+  for (int i = 0; i < producerCount; i++) {
+    producers[i]->join();
+    delete producers[i];
+  }
+
+  std::vector<EventStream::Event *> remainingEvents;
+  eventStream->nextEvents(remainingEvents, 1024);
+  EXPECT_EQ(0u, remainingEvents.size());
+
+  delete eventStream;
+  uv_run(loop, UV_RUN_DEFAULT);
+  uv_loop_delete(loop);
+
+  return elapsed;
+}
+
+TEST(EventStream, deliversEveryEventInOrderPerProducer) {
+  static const int producerCount = 4;
+  std::vector<int> lastSequences(producerCount, -1);
+
+  runEventStream(producerCount, &lastSequences);
+
+  for (int i = 0; i < producerCount; i++) {
+    EXPECT_EQ(EventProducer::eventsPerProducer - 1, lastSequences[i]);
+  }
+}
+
+TEST(EventStream, contentionBenchmark) {
+  static const int producerCounts[] = { 1, 2, 4, 8 };
+
+  for (unsigned int i = 0; i < sizeof(producerCounts) / sizeof(producerCounts[0]); i++) {
+    int producerCount = producerCounts[i];
+    uint64_t elapsed = runEventStream(producerCount, NULL);
+
+    printf("[ BENCHMARK] EventStream: %d producers, %d events in %.1f ms (%.0f events/ms)\n",
+           producerCount,
+           producerCount * EventProducer::eventsPerProducer,
+           elapsed / 1e6,
+           producerCount * EventProducer::eventsPerProducer / (elapsed / 1e6));
+  }
+}
+
+static void addEvent(EventStream * eventStream, const char * eventName, int key, int value) {
+  gemfire::EntryEvent event(NULLPTR,
+                            gemfire::CacheableInt32::create(key),
+                            NULLPTR,
+                            gemfire::CacheableInt32::create(value),
+                            NULLPTR,
+                            false);
+  eventStream->add(eventName, event, true);
+}
+
+// Drains the stream and returns the keys of the events that were waiting, oldest first.
+static std::vector<int> takeEventKeys(EventStream * eventStream) {
+  std::vector<EventStream::Event *> events;
+  eventStream->nextEvents(events, 1024);
+
+  std::vector<int> keys;
+  for (std::vector<EventStream::Event *>::iterator iterator(events.begin());
+       iterator != events.end();
+       ++iterator) {
+    keys.push_back(static_cast<gemfire::CacheableInt32 *>((*iterator)->getKey().ptr())->value());
+    eventStream->release(*iterator);
+  }
+  return keys;
+}
+
+static void deleteEventStream(EventStream * eventStream, uv_loop_t * loop) {
+  delete eventStream;
+  uv_run(loop, UV_RUN_DEFAULT);
+  uv_loop_delete(loop);
+}
+
+TEST(EventStream, dropsTheOldestEventsWhenFull) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+  eventStream->setLimit(3, EventStream::DROP_OLDEST);
+
+  for (int i = 0; i < 5; i++) {
+    addEvent(eventStream, "create", i, i);
+  }
+
+  std::vector<int> keys(takeEventKeys(eventStream));
+  ASSERT_EQ(3u, keys.size());
+  EXPECT_EQ(2, keys[0]);
+  EXPECT_EQ(3, keys[1]);
+  EXPECT_EQ(4, keys[2]);
+
+  deleteEventStream(eventStream, loop);
+}
+
+TEST(EventStream, dropsTheNewestEventsWhenFull) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+  eventStream->setLimit(3, EventStream::DROP_NEWEST);
+
+  for (int i = 0; i < 5; i++) {
+    addEvent(eventStream, "create", i, i);
+  }
+
+  std::vector<int> keys(takeEventKeys(eventStream));
+  ASSERT_EQ(3u, keys.size());
+  EXPECT_EQ(0, keys[0]);
+  EXPECT_EQ(1, keys[1]);
+  EXPECT_EQ(2, keys[2]);
+
+  addEvent(eventStream, "create", 5, 5);
+  EXPECT_EQ(1u, takeEventKeys(eventStream).size());
+
+  deleteEventStream(eventStream, loop);
+}
+
+TEST(EventStream, conflatesEventsPerKeyWhenFull) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+  eventStream->setLimit(2, EventStream::CONFLATE);
+
+  addEvent(eventStream, "create", 0, 0);
+  addEvent(eventStream, "create", 1, 1);
+  addEvent(eventStream, "create", 2, 2);
+  addEvent(eventStream, "update", 2, 3);
+  addEvent(eventStream, "update", 0, 4);
+  addEvent(eventStream, "create", 3, 5);
+  addEvent(eventStream, "destroy", 3, 6);
+
+  std::vector<EventStream::Event *> events;
+  eventStream->nextEvents(events, 1024);
+
+  ASSERT_EQ(4u, events.size());
+  EXPECT_STREQ("create", events[0]->getName());
+  EXPECT_STREQ("create", events[1]->getName());
+  EXPECT_STREQ("create", events[2]->getName());
+  EXPECT_EQ(2, static_cast<gemfire::CacheableInt32 *>(events[2]->getKey().ptr())->value());
+  EXPECT_STREQ("update", events[3]->getName());
+  EXPECT_EQ(0, static_cast<gemfire::CacheableInt32 *>(events[3]->getKey().ptr())->value());
+
+  for (unsigned int i = 0; i < events.size(); i++) {
+    eventStream->release(events[i]);
+  }
+
+  deleteEventStream(eventStream, loop);
+}
+
+TEST(EventStream, neverBlocksTheMainThread) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+  eventStream->setLimit(1, EventStream::BLOCK);
+
+  addEvent(eventStream, "create", 0, 0);
+  addEvent(eventStream, "create", 1, 1);
+
+  EXPECT_EQ(2u, takeEventKeys(eventStream).size());
+
+  deleteEventStream(eventStream, loop);
+}
+
+TEST(EventStream, keepsEveryEventOnceTheLimitIsRemoved) {
+  uv_loop_t * loop = uv_loop_new();
+  EventStream * eventStream = new EventStream(NULL, noopAsyncCallback, loop);
+  eventStream->setLimit(1, EventStream::DROP_NEWEST);
+  eventStream->setLimit(0, EventStream::DROP_NEWEST);
+
+  for (int i = 0; i < 5; i++) {
+    addEvent(eventStream, "create", i, i);
+  }
+
+  EXPECT_EQ(5u, takeEventKeys(eventStream).size());
+
+  deleteEventStream(eventStream, loop);
+}
+
+// Adds results through a StreamingResultCollector from its own thread, as GemFire does while a function
+// executes, then ends them.
+class ResultProducer {
+ public:
+  ResultProducer(ResultStream * resultStream, int resultCount) :
+    collector(resultStream),
+    resultCount(resultCount) {}
+
+  void start() {
+    uv_thread_create(&thread, run, this);
+  }
+
+  void join() {
+    uv_thread_join(&thread);
+  }
+
+ private:
+  static void run(void * data) {
+    ResultProducer * producer = reinterpret_cast<ResultProducer *>(data);
+
+    for (int i = 0; i < producer->resultCount; i++) {
+      gemfire::CacheablePtr resultPtr(gemfire::CacheableInt32::create(i));
+      producer->collector.addResult(resultPtr);
+    }
+    producer->collector.endResults();
+  }
+
+  StreamingResultCollector collector;
+  int resultCount;
+  uv_thread_t thread;
+};
+
+// Takes results while the producer is still adding them, as the main thread does, until the stream ends.
+// Returns the time taken.
+static uint64_t runResultStream(int resultCount, size_t highWaterMark = 0) {
+  uv_loop_t * loop = uv_loop_new();
+  ResultStream * resultStream = new ResultStream(NULL, noopAsyncCallback, loop, highWaterMark);
+  ResultProducer producer(resultStream, resultCount);
+
+  uint64_t startedAt = uv_hrtime();
+  producer.start();
+
+  int received = 0;
+  bool ended = false;
+  std::vector<gemfire::CacheablePtr> results;
+  while (!ended) {
+    results.clear();
+    ended = resultStream->nextResults(results);
+
+    if (highWaterMark > 0) {
+      EXPECT_LE(results.size(), highWaterMark);
+    }
+
+    for (std::vector<gemfire::CacheablePtr>::iterator iterator(results.begin());
+         iterator != results.end();
+         ++iterator) {
+      EXPECT_EQ(received, static_cast<gemfire::CacheableInt32 *>(iterator->ptr())->value());
+      received++;
+    }
+  }
+  uint64_t elapsed = uv_hrtime() - startedAt;
+
+  producer.join();
+  EXPECT_EQ(resultCount, received);
+
+  delete resultStream;
+  uv_run(loop, UV_RUN_DEFAULT);
+  uv_loop_delete(loop);
+
+  return elapsed;
+}
+
+TEST(ResultStream, deliversEveryResultInOrderBeforeTheEnd) {
+  runResultStream(10000);
+}
+
+TEST(ResultStream, endsWithoutResults) {
+  runResultStream(0);
+}
+
+TEST(ResultStream, holdsAtMostTheHighWaterMark) {
+  runResultStream(10000, 16);
+}
+
+TEST(ResultStream, closeReleasesAWaitingProducer) {
+  uv_loop_t * loop = uv_loop_new();
+  ResultStream * resultStream = new ResultStream(NULL, noopAsyncCallback, loop, 1);
+  ResultProducer producer(resultStream, 100);
+
+  producer.start();
+  resultStream->close();
+  producer.join();
+
+  std::vector<gemfire::CacheablePtr> results;
+  EXPECT_TRUE(resultStream->nextResults(results));
+  EXPECT_TRUE(results.empty());
+
+  delete resultStream;
+  uv_run(loop, UV_RUN_DEFAULT);
+  uv_loop_delete(loop);
+}
+
+TEST(ResultStream, throughputBenchmark) {
+  static const int resultCount = 1000000;
+  uint64_t elapsed = runResultStream(resultCount);
+
+  printf("[ BENCHMARK] ResultStream: %d results collected in %.1f ms (%.0f results/s)\n",
+         resultCount,
+         elapsed / 1e6,
+         resultCount / (elapsed / 1e9));
+}
+
 NAN_METHOD(run) {
   NanScope();
 
@@ -16,6 +16,16 @@ describe("gemfire", function() {
     });
   });
 
+  describe(".CancelToken", function() {
+    it("is not cancelled until cancel() is called", function() {
+      const cancelToken = new gemfire.CancelToken();
+      expect(cancelToken.cancelled).toBeFalsy();
+
+      cancelToken.cancel();
+      expect(cancelToken.cancelled).toBeTruthy();
+    });
+  });
+
   describe(".connected", function() {
     it("returns true if the client is connected to the GemFire system", function() {
       expect(gemfire.connected()).toBeTruthy();
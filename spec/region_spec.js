@@ -5,6 +5,7 @@ const randomString = require("random-string");
 
 const factories = require('./support/factories.js');
 const errorMatchers = require("./support/error_matchers.js");
+const gemfire = require("./support/gemfire.js");
 const until = require("./support/until.js");
 const waitUntil = require("./support/wait_until.js");
 const itExecutesFunctions = require("./support/it_executes_functions.js");
@@ -23,6 +24,13 @@ describe("gemfire.Region", function() {
     region.clear(done);
   });
 
+  afterEach(function() {
+    // getRegion() returns the same object every time, so listeners must not leak between specs.
+    _.each(cache.rootRegions(), function(rootRegion) {
+      rootRegion.removeAllListeners();
+    });
+  });
+
   describe(".get", function() {
     it("throws an error if a key is not passed to .get", function() {
       function getWithoutKey() {
@@ -39,6 +47,36 @@ describe("gemfire.Region", function() {
       expect(getWithNonFunctionCallback).toThrow(new Error("You must pass a function as the callback to get()."));
     });
 
+    it("throws an error if the cancelToken option is not a CancelToken", function() {
+      function getWithInvalidCancelToken() {
+        region.get("foo", { cancelToken: {} }, function() {});
+      }
+
+      expect(getWithInvalidCancelToken).toThrow(new Error("get(): cancelToken must be a gemfire.CancelToken."));
+    });
+
+    it("passes a CancelledError to the callback when cancelled before it starts", function(done) {
+      const cancelToken = new gemfire.CancelToken();
+      region.putSync("foo", "bar");
+      cancelToken.cancel();
+
+      region.get("foo", { cancelToken: cancelToken }, function(error, value) {
+        expect(error).toBeError("CancelledError", "The operation was cancelled.");
+        expect(value).toBeUndefined();
+        done();
+      });
+    });
+
+    it("gets the value when given a timeout that isn't reached", function(done) {
+      region.putSync("foo", "bar");
+
+      region.get("foo", { timeout: 10000 }, function(error, value) {
+        expect(error).toBeUndefined();
+        expect(value).toEqual("bar");
+        done();
+      });
+    });
+
     it("returns the region object to support chaining", function(done) {
       var returnValue = region.get("foo", function(error, value) {
         done();
@@ -220,6 +258,54 @@ describe("gemfire.Region", function() {
       }, 1000);
     });
 
+    it("applies concurrent puts of the same key in the order they were made", function(done) {
+      const keys = _.times(10, function(i) { return "key" + i; });
+      const putsPerKey = 200;
+      const completedPuts = {};
+
+      async.each(keys, function(key, nextKey) {
+        completedPuts[key] = [];
+
+        async.each(_.range(putsPerKey), function(i, nextPut) {
+          region.put(key, i, function(error) {
+            completedPuts[key].push(i);
+            nextPut(error);
+          });
+        }, nextKey);
+      }, function(error) {
+        expect(error).toBeFalsy();
+
+        _.each(keys, function(key) {
+          expect(completedPuts[key]).toEqual(_.range(putsPerKey));
+          expect(region.getSync(key)).toEqual(putsPerKey - 1);
+        });
+
+        done();
+      });
+    });
+
+    it("applies a remove after a put of the same key", function(done) {
+      region.put("foo", "bar");
+      region.remove("foo", function(error) {
+        expect(error).toBeFalsy();
+        expect(function() { region.getSync("foo"); }).toThrow(new Error("Key not found in region."));
+        done();
+      });
+    });
+
+    it("applies puts and putAll calls of the same key in the order they were called", function(done) {
+      const completed = [];
+
+      region.put("foo", 1, function() { completed.push("put"); });
+      region.putAll({foo: 2, bar: 2}, function() { completed.push("putAll"); });
+      region.put("bar", 3, function(error) {
+        expect(error).toBeFalsy();
+        expect(completed).toEqual(["put", "putAll"]);
+        expect(region.getSync("foo")).toEqual(2);
+        expect(region.getSync("bar")).toEqual(3);
+        done();
+      });
+    });
   });
 
   describe(".putSync", function() {
@@ -1670,224 +1756,977 @@ describe("gemfire.Region", function() {
     });
   });
 
-  describe("events", function() {
-    describe("create", function() {
-      beforeEach(function() {
-        region = cache.getRegion("createEventTest");
-      });
+  describe(".setLimits", function() {
+    afterEach(function() {
+      region.setLimits(null);
+    });
 
-      it("is emitted when an entry is created on a region from getRegion", function(done) {
-        region.on("create", function(event) {
-          expect(event).toEqual(jasmine.objectContaining({
-            key: "foo",
-            oldValue: null,
-            newValue: "bar"
-          }));
-          done();
-        });
+    it("throws an error when maxInFlight is missing", function() {
+      function callWithoutMaxInFlight() {
+        region.setLimits({});
+      }
 
-        region.put("foo", "bar");
-      });
+      expect(callWithoutMaxInFlight).toThrow(new Error("setLimits: maxInFlight must be a positive integer."));
+    });
 
-      it("is emitted when an entry is created on a region from createRegion", function(done) {
-        const region = cache.createRegion("createRegionCreateEventTest",
-                                          {type: "CACHING_PROXY", poolName: "myPool"});
+    it("throws an error when the policy is unknown", function() {
+      function callWithUnknownPolicy() {
+        region.setLimits({maxInFlight: 1, policy: "drop"});
+      }
 
-        async.series([
-          function(next) { region.clear(next); },
-          function(next) {
-            region.on("create", function(event) {
-              expect(event).toEqual(jasmine.objectContaining({
-                key: "foo",
-                oldValue: null,
-                newValue: "bar"
-              }));
-              done();
-            });
+      expect(callWithUnknownPolicy).toThrow(new Error("setLimits: policy must be \"fail\" or \"queue\"."));
+    });
 
-            next();
-          },
-          function(next) { region.put("foo", "bar", next); }
-        ]);
-      });
+    it("throws an error when the queue policy has no maxQueued", function() {
+      function callWithoutMaxQueued() {
+        region.setLimits({maxInFlight: 1, policy: "queue"});
+      }
 
-      it("emits events on each JS object for the GemFire region", function(done) {
-        const anotherRegion = cache.getRegion("anotherRegion");
-        const region1 = cache.getRegion("exampleRegion");
-        const region2 = cache.getRegion("exampleRegion");
+      expect(callWithoutMaxQueued).toThrow(
+        new Error("setLimits: maxQueued must be a positive integer when the policy is \"queue\".")
+      );
+    });
 
-        var callback1Called = false;
-        region1.on('create', function() {
-          callback1Called = true;
-        });
+    it("rejects operations beyond maxInFlight and emits full and drain", function(done) {
+      const events = [];
+      region.on("full", function() { events.push("full"); });
+      region.on("drain", function() {
+        events.push("drain");
+        expect(events).toEqual(["full", "drain"]);
+        expect(region.statistics.limits.rejected).toEqual(1);
+        done();
+      });
 
-        var callback2Called = false;
-        region2.on('create', function() {
-          callback2Called = true;
-        });
+      region.setLimits({maxInFlight: 1});
+      region.put("foo", "bar", function(error) {
+        expect(error).toBeUndefined();
+      });
 
-        var anotherCallbackCalled = false;
-        anotherRegion.on('create', function() {
-          anotherCallbackCalled = true;
-        });
+      function putBeyondMaxInFlight() {
+        region.put("baz", "qux");
+      }
 
-        async.series([
-          function(next) { region1.put("foo", "bar", next); },
-          function(next) {
-            waitUntil(function(){
-              return callback1Called && callback2Called;
-            }, next);
-          },
-          function(next) {
-            expect(anotherCallbackCalled).toBeFalsy();
-            next();
-          },
-        ], done);
-      });
+      expect(putBeyondMaxInFlight).toThrow(new Error("Too many operations are in flight for this region."));
+
+      expect(region.statistics.limits.inFlight).toEqual(1);
+      expect(region.statistics.limits.full).toEqual(true);
     });
 
-    describe("update", function() {
-      beforeEach(function() {
-        region = cache.getRegion("updateEventTest");
-      });
+    it("queues operations up to maxQueued and runs them as earlier ones complete", function(done) {
+      region.setLimits({maxInFlight: 1, policy: "queue", maxQueued: 1});
 
-      it("is emitted when an entry is updated on a region from getRegion", function(done) {
-        region.on("update", function(event) {
-          expect(event).toEqual(jasmine.objectContaining({
-            key: "foo",
-            oldValue: "bar",
-            newValue: "baz"
-          }));
+      region.put("foo", 1);
+      region.put("foo", 2, function(error) {
+        expect(error).toBeUndefined();
+        expect(region.getSync("foo")).toEqual(2);
+
+        waitUntil(function() { return region.statistics.limits.inFlight === 0; }, function() {
+          expect(region.statistics.limits.full).toEqual(false);
           done();
         });
-
-        async.series([
-          function(next) { region.put("foo", "bar", next); },
-          function(next) { region.put("foo", "baz", next); }
-        ]);
       });
 
-      it("is emitted when an entry is updated on a region from createRegion", function(done) {
-        const region = cache.createRegion("createRegionUpdateEventTest",
-                                          {type: "CACHING_PROXY", poolName: "myPool"});
+      expect(region.statistics.limits.queued).toEqual(1);
 
-        async.series([
-          function(next) { region.clear(next); },
-          function(next) {
-            region.on("update", function(event) {
-              expect(event).toEqual(jasmine.objectContaining({
-                key: "foo",
-                oldValue: "bar",
-                newValue: "baz"
-              }));
-              done();
-            });
+      function putBeyondMaxQueued() {
+        region.put("foo", 3);
+      }
 
-            next();
-          },
-          function(next) { region.put("foo", "bar", next); },
-          function(next) { region.put("foo", "baz", next); }
-        ]);
-      });
+      expect(putBeyondMaxQueued).toThrow(new Error("Too many operations are queued for this region."));
+    });
 
-      it("emits events on each JS object for the GemFire region", function(done) {
-        const anotherRegion = cache.getRegion("anotherRegion");
-        const region1 = cache.getRegion("exampleRegion");
-        const region2 = cache.getRegion("exampleRegion");
+    it("removes the limits when passed null", function() {
+      region.setLimits({maxInFlight: 1});
+      region.setLimits(null);
 
-        var callback1Called = false;
-        region1.on('update', function() {
-          callback1Called = true;
-        });
+      expect(region.statistics.limits).toBeNull();
+    });
+  });
 
-        var callback2Called = false;
-        region2.on('update', function() {
-          callback2Called = true;
-        });
+  describe(".setLoader", function() {
+    afterEach(function() {
+      region.setLoader(null);
+    });
 
-        var anotherCallbackCalled = false;
-        anotherRegion.on('update', function() {
-          anotherCallbackCalled = true;
-        });
+    it("throws an error when not passed a function or null", function() {
+      function callWithNonFunction() {
+        region.setLoader("foo");
+      }
 
-        async.series([
-          function(next) { region1.put("foo", "bar", next); },
-          function(next) { region1.put("foo", "baz", next); },
-          function(next) {
-            waitUntil(function(){
-              return callback1Called && callback2Called;
-            }, next);
-          },
-          function(next) {
-            expect(anotherCallbackCalled).toBeFalsy();
-            next();
-          },
-        ], done);
-      });
+      expect(callWithNonFunction).toThrow(new Error("You must pass a function or null to setLoader()."));
     });
 
-    describe("destroy", function() {
-      beforeEach(function() {
-        region = cache.getRegion("destroyEventTest");
+    it("loads a missing key once for concurrent gets and writes it back to the region", function(done) {
+      var loads = 0;
+      region.setLoader(function(key, loaded) {
+        loads++;
+        setTimeout(function() { loaded(null, key + "-loaded"); }, 10);
       });
 
-      it("is emitted when an entry is destroyed on a region from getRegion", function(done) {
-        region.on("destroy", function(event) {
-          expect(event).toEqual(jasmine.objectContaining({
-            key: "foo",
-            oldValue: "bar",
-            newValue: null
-          }));
-          done();
-        });
+      async.parallel([
+        function(next) { region.get("foo", next); },
+        function(next) { region.get("foo", next); },
+        function(next) { region.get("foo", next); }
+      ], function(error, values) {
+        expect(error).toBeFalsy();
+        expect(values).toEqual(["foo-loaded", "foo-loaded", "foo-loaded"]);
+        expect(loads).toEqual(1);
+        expect(region.getSync("foo")).toEqual("foo-loaded");
 
-        async.series([
-          function(next) { region.put("foo", "bar", next); },
-          function(next) { region.remove("foo"); }
-        ]);
+        const statistics = region.statistics.loader;
+        expect(statistics.misses).toEqual(3);
+        expect(statistics.loads).toEqual(1);
+        expect(statistics.coalesced).toEqual(2);
+        expect(statistics.pending).toEqual(0);
+        done();
       });
+    });
 
-      it("is emitted when an entry is destroyed on a region from createRegion", function(done) {
-        const region = cache.createRegion("createRegionDestroyEventTest",
-                                          {type: "CACHING_PROXY", poolName: "myPool"});
+    it("doesn't call the loader for keys that are present", function(done) {
+      region.putSync("foo", "bar");
+      region.setLoader(function(key, loaded) {
+        throw new Error("loader should not be called");
+      });
 
-        async.series([
-          function(next) { region.clear(next); },
-          function(next) {
-            region.on("destroy", function(event) {
-              expect(event).toEqual(jasmine.objectContaining({
-                key: "foo",
-                oldValue: "bar",
-                newValue: null
-              }));
-              done();
-            });
+      region.get("foo", function(error, value) {
+        expect(error).toBeUndefined();
+        expect(value).toEqual("bar");
+        expect(region.statistics.loader.hits).toEqual(1);
+        done();
+      });
+    });
 
-            next();
-          },
-          function(next) { region.put("foo", "bar", next); },
-          function(next) { region.remove("foo"); }
-        ]);
+    it("passes loader errors to every waiting callback", function(done) {
+      region.setLoader(function(key, loaded) {
+        setTimeout(function() { loaded(new Error("load failed")); }, 10);
       });
 
-      it("emits events on each JS object for the GemFire region", function(done) {
-        const anotherRegion = cache.getRegion("anotherRegion");
-        const region1 = cache.getRegion("exampleRegion");
-        const region2 = cache.getRegion("exampleRegion");
+      async.parallel([
+        function(next) {
+          region.get("foo", function(error) { next(null, error); });
+        },
+        function(next) {
+          region.get("foo", function(error) { next(null, error); });
+        }
+      ], function(error, errors) {
+        expect(errors[0].message).toEqual("load failed");
+        expect(errors[1].message).toEqual("load failed");
+        expect(region.statistics.loader.loadErrors).toEqual(1);
+        done();
+      });
+    });
 
-        var callback1Called = false;
-        region1.on('destroy', function() {
-          callback1Called = true;
-        });
+    it("treats an exception thrown by the loader as a load error", function(done) {
+      region.setLoader(function(key, loaded) {
+        throw new Error("load failed");
+      });
 
-        var callback2Called = false;
-        region2.on('destroy', function() {
-          callback2Called = true;
-        });
+      region.get("foo", function(error, value) {
+        expect(error.message).toEqual("load failed");
+        done();
+      });
+    });
 
-        var anotherCallbackCalled = false;
-        anotherRegion.on('destroy', function() {
-          anotherCallbackCalled = true;
+    it("reports the key as missing when the loader doesn't find it", function(done) {
+      region.setLoader(function(key, loaded) {
+        loaded(null, undefined);
+      });
+
+      region.get("foo", function(error, value) {
+        expect(error).toBeError("KeyNotFoundError", "Key not found in region.");
+        done();
+      });
+    });
+
+    it("loads the missing keys of getAll", function(done) {
+      var loadedKeys = [];
+      region.putSync("foo", "bar");
+      region.setLoader(function(key, loaded) {
+        loadedKeys.push(key);
+        loaded(null, key === "baz" ? "loaded" : null);
+      });
+
+      region.getAll(["foo", "baz", "qux"], function(error, values) {
+        expect(error).toBeUndefined();
+        expect(values).toEqual({ foo: "bar", baz: "loaded", qux: null });
+        expect(loadedKeys.sort()).toEqual(["baz", "qux"]);
+        done();
+      });
+    });
+
+    it("has null statistics when no loader is set", function() {
+      expect(region.statistics.loader).toBeNull();
+    });
+  });
+
+  describe(".setNegativeCache", function() {
+    afterEach(function() {
+      region.setNegativeCache(null);
+    });
+
+    it("throws an error when ttl is missing", function() {
+      function callWithoutTtl() {
+        region.setNegativeCache({maxEntries: 10});
+      }
+
+      expect(callWithoutTtl).toThrow(
+        new Error("setNegativeCache: ttl must be a positive number of milliseconds.")
+      );
+    });
+
+    it("throws an error when maxEntries is missing", function() {
+      function callWithoutMaxEntries() {
+        region.setNegativeCache({ttl: 1000});
+      }
+
+      expect(callWithoutMaxEntries).toThrow(new Error("setNegativeCache: maxEntries must be a positive integer."));
+    });
+
+    it("still passes KeyNotFoundError to the callback by default", function(done) {
+      region.setNegativeCache({ttl: 60000, maxEntries: 10});
+
+      async.series([
+        function(next) {
+          region.get("baz", function(error, value) {
+            expect(error).toBeError("KeyNotFoundError", "Key not found in region.");
+            next();
+          });
+        },
+        function(next) {
+          region.get("baz", function(error, value) {
+            expect(error).toBeError("KeyNotFoundError", "Key not found in region.");
+            expect(region.statistics.negativeCache.hits).toEqual(1);
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("reports misses as undefined when undefinedOnMiss is set", function(done) {
+      region.setNegativeCache({ttl: 60000, maxEntries: 10, undefinedOnMiss: true});
+
+      region.get("baz", function(error, value) {
+        expect(error).toBeUndefined();
+        expect(value).toBeUndefined();
+        expect(region.getSync("baz")).toBeUndefined();
+        done();
+      });
+    });
+
+    it("forgets a missing key when it is put locally", function(done) {
+      region.setNegativeCache({ttl: 60000, maxEntries: 10, undefinedOnMiss: true});
+
+      async.series([
+        function(next) {
+          expect(region.getSync("foo")).toBeUndefined();
+          region.put("foo", "bar", next);
+        },
+        function(next) {
+          expect(region.getSync("foo")).toEqual("bar");
+          next();
+        }
+      ], done);
+    });
+
+    it("forgets a missing key when it is created by another client", function(done) {
+      const region = cache.getRegion("registerInterestTest");
+      region.setNegativeCache({ttl: 60000, maxEntries: 10, undefinedOnMiss: true});
+      region.registerAllKeys();
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) {
+          expect(region.getSync("foo")).toBeUndefined();
+
+          region.executeFunction("io.pivotal.node_gemfire.Put", ["foo", "bar"])
+            .on("error", function(error) { throw(error); })
+            .on("end", next);
+        },
+        function(next) {
+          waitUntil(function() {
+            return region.getSync("foo") === "bar";
+          }, next);
+        },
+        function(next) {
+          region.unregisterAllKeys();
+          region.setNegativeCache(null);
+          next();
+        }
+      ], done);
+    });
+  });
+
+  describe(".setValueCache", function() {
+    afterEach(function() {
+      region.setValueCache(null);
+    });
+
+    it("throws an error when neither maxEntries nor maxBytes is passed", function() {
+      function callWithoutBounds() {
+        region.setValueCache({});
+      }
+
+      expect(callWithoutBounds).toThrow(
+        new Error("setValueCache: You must pass maxEntries, maxBytes or both.")
+      );
+    });
+
+    it("throws an error when a bound is not a positive integer", function() {
+      function callWithNegativeBound() {
+        region.setValueCache({maxEntries: -1});
+      }
+
+      expect(callWithNegativeBound).toThrow(new Error("setValueCache: maxEntries must be a positive integer."));
+    });
+
+    it("throws an error on a region that does not cache values locally", function() {
+      const proxyRegion = cache.getRegion("exampleProxyRegion");
+
+      function callOnProxyRegion() {
+        proxyRegion.setValueCache({maxEntries: 10});
+      }
+
+      expect(callOnProxyRegion).toThrow(new Error("setValueCache: The region must cache values locally."));
+      expect(proxyRegion.statistics.valueCache).toBeNull();
+    });
+
+    it("returns the same frozen object for repeated reads of an unchanged entry", function(done) {
+      region.setValueCache({maxEntries: 10});
+
+      region.put("foo", {bar: {baz: "qux"}}, function(error) {
+        expect(error).not.toBeError();
+
+        const first = region.getSync("foo");
+        const second = region.getSync("foo");
+
+        expect(first).toEqual({bar: {baz: "qux"}});
+        expect(first === second).toBeTruthy();
+        expect(Object.isFrozen(first)).toBeTruthy();
+        expect(Object.isFrozen(first.bar)).toBeTruthy();
+        done();
+      });
+    });
+
+    it("shares cached values between get and getSync", function(done) {
+      region.setValueCache({maxEntries: 10});
+
+      async.series([
+        function(next) { region.put("foo", {bar: "baz"}, next); },
+        function(next) { region.get("foo", next); },
+        function(next) {
+          const syncValue = region.getSync("foo");
+          region.get("foo", function(error, value) {
+            expect(error).not.toBeError();
+            expect(value === syncValue).toBeTruthy();
+            next();
+          });
+        }
+      ], done);
+    });
+
+    it("returns the new value after a local put", function(done) {
+      region.setValueCache({maxEntries: 10});
+
+      async.series([
+        function(next) { region.put("foo", {version: 1}, next); },
+        function(next) {
+          expect(region.getSync("foo")).toEqual({version: 1});
+          region.put("foo", {version: 2}, next);
+        },
+        function(next) {
+          expect(region.getSync("foo")).toEqual({version: 2});
+          next();
+        }
+      ], done);
+    });
+
+    it("evicts the least recently read entries beyond maxEntries", function(done) {
+      region.setValueCache({maxEntries: 2});
+
+      region.putAll({a: "a", b: "b", c: "c"}, function(error) {
+        expect(error).not.toBeError();
+
+        region.getSync("a");
+        region.getSync("b");
+        region.getSync("c");
+
+        const statistics = region.statistics.valueCache;
+        expect(statistics.entries).toEqual(2);
+        expect(statistics.evictions).toEqual(1);
+        done();
+      });
+    });
+
+    it("reports hits and misses in region.statistics", function(done) {
+      expect(region.statistics.valueCache).toBeNull();
+
+      region.setValueCache({maxEntries: 10});
+
+      region.put("foo", "bar", function(error) {
+        expect(error).not.toBeError();
+
+        region.getSync("foo");
+        region.getSync("foo");
+        region.getSync("foo");
+
+        expect(region.statistics.valueCache).toEqual(jasmine.objectContaining({
+          entries: 1,
+          hits: 2,
+          misses: 1
+        }));
+        done();
+      });
+    });
+  });
+
+  describe(".setWriteBehind", function() {
+    afterEach(function(done) {
+      if (!region.statistics.writeBehind) {
+        done();
+        return;
+      }
+
+      region.flush(function() {
+        region.setWriteBehind(null);
+        done();
+      });
+    });
+
+    it("throws an error when interval is missing", function() {
+      function callWithoutInterval() {
+        region.setWriteBehind({maxEntries: 10});
+      }
+
+      expect(callWithoutInterval).toThrow(
+        new Error("setWriteBehind: interval must be a positive number of milliseconds.")
+      );
+    });
+
+    it("throws an error when maxEntries is missing", function() {
+      function callWithoutMaxEntries() {
+        region.setWriteBehind({interval: 100});
+      }
+
+      expect(callWithoutMaxEntries).toThrow(new Error("setWriteBehind: maxEntries must be a positive integer."));
+    });
+
+    it("conflates repeated puts of a key and writes them on flush", function(done) {
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+
+      region.put("foo", 1);
+      region.put("foo", 2);
+      region.put("foo", 3);
+
+      expect(region.getSync("foo")).toEqual(3);
+      expect(region.statistics.writeBehind.buffered).toEqual(1);
+      expect(region.statistics.writeBehind.conflated).toEqual(2);
+
+      region.flush(function(error) {
+        expect(error).toBeUndefined();
+        expect(cache.getRegion("exampleRegion").getSync("foo")).toEqual(3);
+        expect(region.statistics.writeBehind.flushedEntries).toEqual(1);
+        done();
+      });
+    });
+
+    it("calls put callbacks once their batch has been written", function(done) {
+      region.setWriteBehind({interval: 10, maxEntries: 100});
+
+      region.put("foo", "bar", function(error) {
+        expect(error).toBeUndefined();
+        expect(cache.getRegion("exampleRegion").getSync("foo")).toEqual("bar");
+        done();
+      });
+    });
+
+    it("flushes when maxEntries keys are buffered", function(done) {
+      region.setWriteBehind({interval: 60000, maxEntries: 2});
+
+      region.put("foo", 1);
+      region.put("bar", 2, function(error) {
+        expect(error).toBeUndefined();
+        expect(region.statistics.writeBehind.flushes).toEqual(1);
+        done();
+      });
+    });
+
+    it("returns buffered values from get and getAll", function(done) {
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+      region.put("foo", "bar");
+
+      async.series([
+        function(next) {
+          region.get("foo", function(error, value) {
+            expect(value).toEqual("bar");
+            next(error);
+          });
+        },
+        function(next) {
+          region.getAll(["foo"], function(error, values) {
+            expect(values).toEqual({ foo: "bar" });
+            next(error);
+          });
+        }
+      ], done);
+    });
+
+    it("discards a buffered value when the key is removed", function(done) {
+      region.putSync("foo", "original");
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+      region.put("foo", "buffered");
+
+      region.remove("foo", function(error) {
+        expect(error).toBeFalsy();
+        expect(region.statistics.writeBehind.buffered).toEqual(0);
+        done();
+      });
+    });
+
+    it("calls the callbacks of discarded puts with an error", function(done) {
+      const message = "The buffered put was discarded before it was written.";
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+
+      async.parallel([
+        function(next) {
+          region.put("foo", "buffered", function(error) {
+            expect(error).toBeError("SupersededError", message);
+            next();
+          });
+        },
+        function(next) {
+          region.put("bar", "buffered", function(error) {
+            expect(error).toBeError("SupersededError", message);
+            next();
+          });
+        },
+        function(next) {
+          region.remove("foo", function(error) {
+            expect(error).toBeFalsy();
+            region.clear(next);
+          });
+        }
+      ], done);
+    });
+
+    it("applies a remove and a clear made during a flush after the flush", function(done) {
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+
+      region.put("foo", "buffered");
+      region.put("bar", "buffered");
+      region.flush();
+
+      expect(region.statistics.writeBehind.flushing).toEqual(2);
+
+      region.remove("foo", function(error) {
+        expect(error).toBeFalsy();
+        expect(function() { region.getSync("foo"); }).toThrow(new Error("Key not found in region."));
+        expect(region.getSync("bar")).toEqual("buffered");
+
+        region.put("bar", "buffered again");
+        region.flush();
+
+        region.clear(function(error) {
+          expect(error).toBeFalsy();
+          expect(function() { region.getSync("bar"); }).toThrow(new Error("Key not found in region."));
+          done();
+        });
+      });
+    });
+
+    it("throws an error when a put is given a timeout while write-behind is enabled", function() {
+      region.setWriteBehind({interval: 60000, maxEntries: 100});
+
+      expect(function() { region.put("foo", "bar", {timeout: 1000}); }).toThrow(
+        new Error("put: timeout and cancelToken can't be used while write-behind is enabled.")
+      );
+    });
+
+    it("throws an error from flush when write-behind is not enabled", function() {
+      function flushWithoutWriteBehind() {
+        region.flush();
+      }
+
+      expect(flushWithoutWriteBehind).toThrow(
+        new Error("You must enable write-behind with setWriteBehind() before calling flush().")
+      );
+    });
+  });
+
+  describe("events", function() {
+    describe("create", function() {
+      beforeEach(function() {
+        region = cache.getRegion("createEventTest");
+      });
+
+      it("is emitted when an entry is created on a region from getRegion", function(done) {
+        region.on("create", function(event) {
+          expect(event).toEqual(jasmine.objectContaining({
+            key: "foo",
+            oldValue: null,
+            newValue: "bar"
+          }));
+          done();
+        });
+
+        region.put("foo", "bar");
+      });
+
+      it("is emitted when an entry is created on a region from createRegion", function(done) {
+        const region = cache.createRegion("createRegionCreateEventTest",
+                                          {type: "CACHING_PROXY", poolName: "myPool"});
+
+        async.series([
+          function(next) { region.clear(next); },
+          function(next) {
+            region.on("create", function(event) {
+              expect(event).toEqual(jasmine.objectContaining({
+                key: "foo",
+                oldValue: null,
+                newValue: "bar"
+              }));
+              done();
+            });
+
+            next();
+          },
+          function(next) { region.put("foo", "bar", next); }
+        ]);
+      });
+
+      it("emits events on each JS object for the GemFire region", function(done) {
+        const anotherRegion = cache.getRegion("anotherRegion");
+        const region1 = cache.getRegion("exampleRegion");
+        const region2 = cache.getRegion("exampleRegion");
+
+        var callback1Called = false;
+        region1.on('create', function() {
+          callback1Called = true;
+        });
+
+        var callback2Called = false;
+        region2.on('create', function() {
+          callback2Called = true;
+        });
+
+        var anotherCallbackCalled = false;
+        anotherRegion.on('create', function() {
+          anotherCallbackCalled = true;
+        });
+
+        async.series([
+          function(next) { region1.put("foo", "bar", next); },
+          function(next) {
+            waitUntil(function(){
+              return callback1Called && callback2Called;
+            }, next);
+          },
+          function(next) {
+            expect(anotherCallbackCalled).toBeFalsy();
+            next();
+          },
+        ], done);
+      });
+    });
+
+    describe("events", function() {
+      afterEach(function() {
+        region.setEventOptions(null);
+      });
+
+      it("throws an error when maxBatchSize is not a positive integer", function() {
+        function callWithInvalidMaxBatchSize() {
+          region.setEventOptions({batch: true, maxBatchSize: 0});
+        }
+
+        expect(callWithInvalidMaxBatchSize).toThrow(
+          new Error("setEventOptions: maxBatchSize must be a positive integer.")
+        );
+      });
+
+      it("is emitted with arrays of entry events instead of individual events when batching", function(done) {
+        const batches = [];
+        var createCalled = false;
+
+        region.setEventOptions({batch: true, maxBatchSize: 2});
+        region.on("create", function() { createCalled = true; });
+        region.on("events", function(events) { batches.push(events); });
+
+        async.series([
+          function(next) { region.put("foo", "bar", next); },
+          function(next) { region.put("foo", "baz", next); },
+          function(next) { region.remove("foo", next); },
+          function(next) {
+            waitUntil(function() {
+              return _.flatten(batches).length === 3;
+            }, next);
+          },
+          function(next) {
+            _.each(batches, function(batch) {
+              expect(batch.length).not.toBeGreaterThan(2);
+            });
+
+            expect(_.flatten(batches)).toEqual([
+              {type: "create", key: "foo", oldValue: null, newValue: "bar"},
+              {type: "update", key: "foo", oldValue: "bar", newValue: "baz"},
+              {type: "destroy", key: "foo", oldValue: "baz", newValue: null}
+            ]);
+            expect(createCalled).toBeFalsy();
+            next();
+          }
+        ], done);
+      });
+
+      it("delivers only the net effect of events for a key that arrive together when conflating", function(done) {
+        region.setEventOptions({batch: true, conflate: true});
+        region.on("events", function(events) {
+          expect(events).toEqual([
+            {type: "create", key: "foo", oldValue: null, newValue: 3},
+            {type: "create", key: "bar", oldValue: null, newValue: 1}
+          ]);
+          expect(region.statistics.events.conflated).toEqual(2);
+          done();
+        });
+
+        region.putSync("foo", 1);
+        region.putSync("bar", 1);
+        region.putSync("foo", 2);
+        region.putSync("foo", 3);
+      });
+
+      it("delivers events without their old values when oldValues is false", function(done) {
+        region.putSync("foo", "bar");
+        region.setEventOptions({oldValues: false});
+        expect(region.statistics.events.oldValues).toBeFalsy();
+
+        region.on("update", function(event) {
+          expect(event).toEqual({key: "foo", oldValue: null, newValue: "baz"});
+          done();
+        });
+
+        region.putSync("foo", "baz");
+      });
+
+      it("throws an error when oldValues is not a boolean", function() {
+        function callWithInvalidOldValues() {
+          region.setEventOptions({oldValues: "no"});
+        }
+
+        expect(callWithInvalidOldValues).toThrow(
+          new Error("setEventOptions: oldValues must be true or false.")
+        );
+      });
+    });
+
+    describe("subscriptions", function() {
+      afterEach(function() {
+        region.setEventOptions(null);
+        region.setValueCache(null);
+      });
+
+      it("only asks GemFire for the events that have listeners", function() {
+        function onUpdate() {}
+
+        expect(region.statistics.subscriptions).toEqual([]);
+
+        region.on("update", onUpdate);
+        expect(region.statistics.subscriptions).toEqual(["update"]);
+
+        region.once("destroy", function() {});
+        expect(region.statistics.subscriptions).toEqual(["update", "destroy"]);
+
+        region.removeListener("update", onUpdate);
+        expect(region.statistics.subscriptions).toEqual(["destroy"]);
+
+        region.removeAllListeners();
+        expect(region.statistics.subscriptions).toEqual([]);
+      });
+
+      it("asks for every event while batching and something listens for batches", function() {
+        region.setEventOptions({batch: true});
+        region.on("create", function() {});
+        expect(region.statistics.subscriptions).toEqual([]);
+
+        region.on("events", function() {});
+        expect(region.statistics.subscriptions).toEqual(["create", "update", "destroy"]);
+
+        region.setEventOptions(null);
+        expect(region.statistics.subscriptions).toEqual(["create"]);
+      });
+
+      it("asks for every event while the value cache needs them", function() {
+        region.setValueCache({maxEntries: 10});
+        expect(region.statistics.subscriptions).toEqual(["create", "update", "destroy"]);
+
+        region.setValueCache(null);
+        expect(region.statistics.subscriptions).toEqual([]);
+      });
+    });
+
+    describe("payloads", function() {
+      it("convert each value once and keep it", function(done) {
+        region.on("create", function(event) {
+          expect(Object.keys(event)).toEqual(["key", "oldValue", "newValue"]);
+          expect(event.newValue).toBe(event.newValue);
+          expect(event.newValue).toEqual({foo: "bar"});
+          done();
+        });
+
+        region.putSync("payload", {foo: "bar"});
+      });
+
+      it("can be assigned to by listeners", function(done) {
+        region.on("create", function(event) {
+          event.newValue = "replaced";
+          expect(event.newValue).toEqual("replaced");
+          done();
+        });
+
+        region.putSync("payload", "original");
+      });
+    });
+
+    describe("update", function() {
+      beforeEach(function() {
+        region = cache.getRegion("updateEventTest");
+      });
+
+      it("is emitted when an entry is updated on a region from getRegion", function(done) {
+        region.on("update", function(event) {
+          expect(event).toEqual(jasmine.objectContaining({
+            key: "foo",
+            oldValue: "bar",
+            newValue: "baz"
+          }));
+          done();
+        });
+
+        async.series([
+          function(next) { region.put("foo", "bar", next); },
+          function(next) { region.put("foo", "baz", next); }
+        ]);
+      });
+
+      it("is emitted when an entry is updated on a region from createRegion", function(done) {
+        const region = cache.createRegion("createRegionUpdateEventTest",
+                                          {type: "CACHING_PROXY", poolName: "myPool"});
+
+        async.series([
+          function(next) { region.clear(next); },
+          function(next) {
+            region.on("update", function(event) {
+              expect(event).toEqual(jasmine.objectContaining({
+                key: "foo",
+                oldValue: "bar",
+                newValue: "baz"
+              }));
+              done();
+            });
+
+            next();
+          },
+          function(next) { region.put("foo", "bar", next); },
+          function(next) { region.put("foo", "baz", next); }
+        ]);
+      });
+
+      it("emits events on each JS object for the GemFire region", function(done) {
+        const anotherRegion = cache.getRegion("anotherRegion");
+        const region1 = cache.getRegion("exampleRegion");
+        const region2 = cache.getRegion("exampleRegion");
+
+        var callback1Called = false;
+        region1.on('update', function() {
+          callback1Called = true;
+        });
+
+        var callback2Called = false;
+        region2.on('update', function() {
+          callback2Called = true;
+        });
+
+        var anotherCallbackCalled = false;
+        anotherRegion.on('update', function() {
+          anotherCallbackCalled = true;
+        });
+
+        async.series([
+          function(next) { region1.put("foo", "bar", next); },
+          function(next) { region1.put("foo", "baz", next); },
+          function(next) {
+            waitUntil(function(){
+              return callback1Called && callback2Called;
+            }, next);
+          },
+          function(next) {
+            expect(anotherCallbackCalled).toBeFalsy();
+            next();
+          },
+        ], done);
+      });
+    });
+
+    describe("destroy", function() {
+      beforeEach(function() {
+        region = cache.getRegion("destroyEventTest");
+      });
+
+      it("is emitted when an entry is destroyed on a region from getRegion", function(done) {
+        region.on("destroy", function(event) {
+          expect(event).toEqual(jasmine.objectContaining({
+            key: "foo",
+            oldValue: "bar",
+            newValue: null
+          }));
+          done();
+        });
+
+        async.series([
+          function(next) { region.put("foo", "bar", next); },
+          function(next) { region.remove("foo"); }
+        ]);
+      });
+
+      it("is emitted when an entry is destroyed on a region from createRegion", function(done) {
+        const region = cache.createRegion("createRegionDestroyEventTest",
+                                          {type: "CACHING_PROXY", poolName: "myPool"});
+
+        async.series([
+          function(next) { region.clear(next); },
+          function(next) {
+            region.on("destroy", function(event) {
+              expect(event).toEqual(jasmine.objectContaining({
+                key: "foo",
+                oldValue: "bar",
+                newValue: null
+              }));
+              done();
+            });
+
+            next();
+          },
+          function(next) { region.put("foo", "bar", next); },
+          function(next) { region.remove("foo"); }
+        ]);
+      });
+
+      it("emits events on each JS object for the GemFire region", function(done) {
+        const anotherRegion = cache.getRegion("anotherRegion");
+        const region1 = cache.getRegion("exampleRegion");
+        const region2 = cache.getRegion("exampleRegion");
+
+        var callback1Called = false;
+        region1.on('destroy', function() {
+          callback1Called = true;
+        });
+
+        var callback2Called = false;
+        region2.on('destroy', function() {
+          callback2Called = true;
+        });
+
+        var anotherCallbackCalled = false;
+        anotherRegion.on('destroy', function() {
+          anotherCallbackCalled = true;
         });
 
         async.series([
@@ -1960,6 +2799,213 @@ describe("gemfire.Region", function() {
     });
   });
 
+  describe(".watch", function() {
+    var fooListener, otherListener;
+
+    beforeEach(function() {
+      fooListener = jasmine.createSpy("fooListener");
+      otherListener = jasmine.createSpy("otherListener");
+    });
+
+    afterEach(function() {
+      region.unwatch(["foo", "bar"], fooListener);
+      region.unwatch(["foo", "bar"], otherListener);
+    });
+
+    it("calls the listener with the events of the watched keys only", function(done) {
+      region.watch(["foo"], fooListener);
+      region.watch(["bar"], otherListener);
+
+      region.putSync("foo", 1);
+      region.putSync("foo", 2);
+      region.remove("foo");
+
+      waitUntil(function() { return fooListener.calls.count() == 3; }, function() {
+        expect(_.map(fooListener.calls.allArgs(), _.first)).toEqual([
+          {key: "foo", oldValue: null, newValue: 1, type: "create"},
+          {key: "foo", oldValue: 1, newValue: 2, type: "update"},
+          {key: "foo", oldValue: 2, newValue: null, type: "destroy"}
+        ]);
+        expect(otherListener).not.toHaveBeenCalled();
+        done();
+      });
+    });
+
+    it("calls each listener once per event, however often it watches the key", function(done) {
+      region.watch(["foo"], fooListener);
+      region.watch(["foo", "bar"], fooListener);
+      expect(region.statistics.watchers).toEqual({keys: 2, listeners: 1});
+
+      region.putSync("foo", 1);
+      region.putSync("bar", 1);
+
+      waitUntil(function() { return fooListener.calls.count() == 2; }, done);
+    });
+
+    it("stops calling the listener once it unwatches the key", function(done) {
+      region.watch(["foo", "bar"], fooListener);
+      region.unwatch(["foo"], fooListener);
+      expect(region.statistics.watchers).toEqual({keys: 1, listeners: 1});
+
+      region.putSync("foo", 1);
+      region.putSync("bar", 1);
+
+      waitUntil(function() { return fooListener.calls.count() == 1; }, function() {
+        expect(fooListener.calls.argsFor(0)[0].key).toEqual("bar");
+        done();
+      });
+    });
+
+    it("asks GemFire for every event while some key is watched", function() {
+      expect(region.statistics.subscriptions).toEqual([]);
+      expect(region.statistics.watchers).toBeNull();
+
+      region.watch(["foo"], fooListener);
+      expect(region.statistics.subscriptions).toEqual(["create", "update", "destroy"]);
+
+      region.unwatch(["foo"], fooListener);
+      expect(region.statistics.subscriptions).toEqual([]);
+      expect(region.statistics.watchers).toBeNull();
+    });
+
+    it("returns the region", function() {
+      expect(region.watch(["foo"], fooListener)).toBe(region);
+      expect(region.unwatch(["foo"], fooListener)).toBe(region);
+    });
+
+    it("requires an array of keys", function() {
+      expect(function() { region.watch("foo", fooListener); }).toThrow(
+        new Error("You must pass an array of keys to watch().")
+      );
+    });
+
+    it("requires a listener", function() {
+      expect(function() { region.watch(["foo"]); }).toThrow(
+        new Error("You must pass a function as the listener to watch().")
+      );
+      expect(function() { region.unwatch(["foo"], "listener"); }).toThrow(
+        new Error("You must pass a function as the listener to unwatch().")
+      );
+    });
+  });
+
+  describe(".registerKeys", function() {
+    function externalPut(region, key, value, next) {
+      region.executeFunction("io.pivotal.node_gemfire.Put", [key, value])
+        .on("error", function(error) { throw(error); })
+        .on("end", next);
+    }
+
+    it("registers interest in the given keys only", function(done) {
+      const region = cache.getRegion("registerInterestTest");
+      const createdKeys = [];
+
+      region.on("create", function(event) {
+        createdKeys.push(event.key);
+      });
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) {
+          region.registerKeys(["foo"]);
+          next();
+        },
+        function(next) { externalPut(region, "bar", "baz", next); },
+        function(next) { externalPut(region, "foo", "bar", next); },
+        function(next) {
+          waitUntil(function() {
+            return createdKeys.length > 0;
+          }, next);
+        },
+        function(next) {
+          expect(createdKeys).toEqual(["foo"]);
+          region.unregisterKeys(["foo"]);
+          next();
+        }
+      ], done);
+    });
+
+    it("fetches the current values when initialValues is true", function(done) {
+      const region = cache.getRegion("registerInterestTest");
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) { externalPut(region, "foo", "bar", next); },
+        function(next) {
+          region.registerKeys(["foo"], {initialValues: true});
+          expect(region.getSync("foo")).toEqual("bar");
+          region.unregisterKeys(["foo"]);
+          next();
+        }
+      ], done);
+    });
+
+    it("requires an array of keys", function() {
+      function callWithoutKeys() {
+        cache.getRegion("registerInterestTest").registerKeys("foo");
+      }
+
+      expect(callWithoutKeys).toThrow(new Error("You must pass an array of keys to registerKeys()."));
+    });
+
+    it("requires a boolean initialValues", function() {
+      function callWithInvalidInitialValues() {
+        cache.getRegion("registerInterestTest").registerKeys(["foo"], {initialValues: "yes"});
+      }
+
+      expect(callWithInvalidInitialValues).toThrow(
+        new Error("registerKeys: initialValues must be true or false.")
+      );
+    });
+  });
+
+  describe(".registerRegex", function() {
+    it("registers interest in the keys matching the pattern", function(done) {
+      const region = cache.getRegion("registerInterestTest");
+      const createdKeys = [];
+
+      function externalPut(key, value, next) {
+        region.executeFunction("io.pivotal.node_gemfire.Put", [key, value])
+          .on("error", function(error) { throw(error); })
+          .on("end", next);
+      }
+
+      region.on("create", function(event) {
+        createdKeys.push(event.key);
+      });
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) {
+          region.registerRegex(/^match-/);
+          next();
+        },
+        function(next) { externalPut("other", "bar", next); },
+        function(next) { externalPut("match-1", "bar", next); },
+        function(next) {
+          waitUntil(function() {
+            return createdKeys.length > 0;
+          }, next);
+        },
+        function(next) {
+          expect(createdKeys).toEqual(["match-1"]);
+          region.unregisterRegex("^match-");
+          next();
+        }
+      ], done);
+    });
+
+    it("requires a pattern", function() {
+      function callWithoutPattern() {
+        cache.getRegion("registerInterestTest").registerRegex();
+      }
+
+      expect(callWithoutPattern).toThrow(
+        new Error("You must pass a regular expression to registerRegex().")
+      );
+    });
+  });
+
   describe(".destroyRegion", function() {
     itDestroysTheRegion('destroyRegion');
 
@@ -63,6 +63,260 @@ describe("SelectResults", function() {
     });
   });
 
+  describe("length", function() {
+    it("is the number of results", function() {
+      expect(selectResults.length).toEqual(3);
+    });
+  });
+
+  describe("slice", function() {
+    it("returns the results between start and end", function() {
+      const all = selectResults.toArray();
+
+      expect(selectResults.slice(1, 2)).toEqual(all.slice(1, 2));
+      expect(selectResults.slice(1)).toEqual(all.slice(1));
+      expect(selectResults.slice()).toEqual(all);
+    });
+
+    it("counts negative indexes from the end", function() {
+      const all = selectResults.toArray();
+
+      expect(selectResults.slice(-2)).toEqual(all.slice(-2));
+      expect(selectResults.slice(0, -1)).toEqual(all.slice(0, -1));
+    });
+
+    it("returns an empty array for an empty range", function() {
+      expect(selectResults.slice(2, 1)).toEqual([]);
+      expect(selectResults.slice(5)).toEqual([]);
+    });
+
+    it("throws an error for non-numeric bounds", function() {
+      expect(function() { selectResults.slice("1"); }).toThrow(
+        new Error("slice: start and end must be numbers.")
+      );
+    });
+  });
+
+  describe("cursor", function() {
+    it("passes the results in chunks, then null", function(done) {
+      const cursor = selectResults.cursor({chunkSize: 2});
+      const chunks = [];
+
+      function next() {
+        cursor.next(function(error, rows) {
+          expect(error).not.toBeError();
+          if (rows === null) {
+            expect(chunks.map(function(chunk) { return chunk.length; })).toEqual([2, 1]);
+            done();
+            return;
+          }
+
+          chunks.push(rows);
+          next();
+        });
+      }
+
+      next();
+    });
+
+    it("calls back asynchronously", function(done) {
+      var calledBack = false;
+
+      selectResults.cursor().next(function(error, rows) {
+        calledBack = true;
+        expect(rows.length).toEqual(3);
+        done();
+      });
+
+      expect(calledBack).toBeFalsy();
+    });
+
+    it("throws an error for an invalid chunkSize", function() {
+      expect(function() { selectResults.cursor({chunkSize: 0}); }).toThrow(
+        new Error("cursor: chunkSize must be a positive integer.")
+      );
+    });
+  });
+
+  describe("toColumns", function() {
+    function queryColumns(query, callback) {
+      cache.executeQuery(query, {poolName: "myPool"}, function(error, response) {
+        expect(error).not.toBeError();
+        callback(response.toColumns());
+      });
+    }
+
+    beforeEach(function(done) {
+      const region = cache.getRegion('exampleRegion');
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) {
+          region.putAll({
+            "1": {name: "one", amount: 1.5, at: new Date(1000)},
+            "2": {name: "two", amount: 2, at: new Date(2000)},
+            "3": {name: "three", amount: null, at: new Date(3000)}
+          }, next);
+        }
+      ], done);
+    });
+
+    it("returns numeric columns as Float64Arrays, with NaN for nulls", function(done) {
+      queryColumns("SELECT name, amount FROM /exampleRegion ORDER BY name", function(results) {
+        expect(results.columns).toEqual(["name", "amount"]);
+        expect(results.types).toEqual({name: "value", amount: "number"});
+        expect(results.data.name).toEqual(["one", "three", "two"]);
+        expect(results.data.amount instanceof Float64Array).toBeTruthy();
+        expect(results.data.amount[0]).toEqual(1.5);
+        expect(isNaN(results.data.amount[1])).toBeTruthy();
+        expect(results.data.amount[2]).toEqual(2);
+        done();
+      });
+    });
+
+    it("returns date columns as epoch milliseconds", function(done) {
+      queryColumns("SELECT name, at FROM /exampleRegion ORDER BY name", function(results) {
+        expect(results.types.at).toEqual("date");
+        expect(Array.prototype.slice.call(results.data.at)).toEqual([1000, 3000, 2000]);
+        done();
+      });
+    });
+
+    it("returns no columns for empty results", function(done) {
+      queryColumns("SELECT name, at FROM /exampleRegion WHERE name = 'none'", function(results) {
+        expect(results).toEqual({columns: [], types: {}, data: {}});
+        done();
+      });
+    });
+
+    it("throws an error unless the query selects fields", function() {
+      expect(function() { selectResults.toColumns(); }).toThrow(
+        new Error("toColumns: the query must select fields, as in SELECT r.a, r.b FROM /region r.")
+      );
+    });
+  });
+
+  describe("aggregate", function() {
+    function aggregate(query, aggregation, callback) {
+      cache.executeQuery(query, {poolName: "myPool"}, function(error, response) {
+        expect(error).not.toBeError();
+        response.aggregate(aggregation, callback);
+      });
+    }
+
+    beforeEach(function(done) {
+      const region = cache.getRegion('exampleRegion');
+
+      async.series([
+        function(next) { region.clear(next); },
+        function(next) {
+          region.putAll({
+            "1": {kind: "a", amount: 1.5},
+            "2": {kind: "b", amount: 2},
+            "3": {kind: "a", amount: 4},
+            "4": {kind: null, amount: 8}
+          }, next);
+        }
+      ], done);
+    });
+
+    it("counts, sums and finds the minimum and maximum of fields", function(done) {
+      aggregate("SELECT * FROM /exampleRegion", {count: true, sum: "amount", min: "amount", max: ["amount"]},
+        function(error, result) {
+          expect(error).not.toBeError();
+          expect(result).toEqual({count: 4, sum: {amount: 15.5}, min: {amount: 1.5}, max: {amount: 8}});
+          done();
+        });
+    });
+
+    it("aggregates selected fields", function(done) {
+      aggregate("SELECT r.kind, r.amount FROM /exampleRegion r", {sum: "amount"}, function(error, result) {
+        expect(error).not.toBeError();
+        expect(result).toEqual({sum: {amount: 15.5}});
+        done();
+      });
+    });
+
+    it("aggregates numeric results with the field name this", function(done) {
+      aggregate("SELECT r.amount FROM /exampleRegion r", {max: "this"}, function(error, result) {
+        expect(error).not.toBeError();
+        expect(result).toEqual({max: {"this": 8}});
+        done();
+      });
+    });
+
+    it("returns null for the minimum and maximum of empty results", function(done) {
+      aggregate("SELECT * FROM /exampleRegion WHERE kind = 'none'", {count: true, min: "amount"},
+        function(error, result) {
+          expect(error).not.toBeError();
+          expect(result).toEqual({count: 0, min: {amount: null}});
+          done();
+        });
+    });
+
+    it("aggregates by group, with the null group last", function(done) {
+      aggregate("SELECT * FROM /exampleRegion", {count: true, sum: "amount", groupBy: "kind"},
+        function(error, result) {
+          expect(error).not.toBeError();
+          expect(result.length).toEqual(3);
+          expect(result).toContain({group: "a", count: 2, sum: {amount: 5.5}});
+          expect(result).toContain({group: "b", count: 1, sum: {amount: 2}});
+          expect(result[2]).toEqual({group: null, count: 1, sum: {amount: 8}});
+          done();
+        });
+    });
+
+    it("throws an error without a callback", function() {
+      expect(function() { selectResults.aggregate({count: true}); }).toThrow(
+        new Error("You must pass an aggregation object and a callback to aggregate().")
+      );
+    });
+
+    it("throws an error for an empty aggregation", function() {
+      expect(function() { selectResults.aggregate({}, function() {}); }).toThrow(
+        new Error("aggregate: You must ask for count, sum, min or max.")
+      );
+    });
+
+    it("throws an error for invalid field names", function() {
+      expect(function() { selectResults.aggregate({sum: 1}, function() {}); }).toThrow(
+        new Error("aggregate: sum must be a field name or an array of field names.")
+      );
+      expect(function() { selectResults.aggregate({count: true, groupBy: []}, function() {}); }).toThrow(
+        new Error("aggregate: groupBy must be a field name.")
+      );
+    });
+  });
+
+  describe("release", function() {
+    it("drops the results", function() {
+      selectResults.release();
+
+      expect(selectResults.inspect()).toEqual("[SelectResults released]");
+      expect(function() { selectResults.toArray(); }).toThrow(
+        new Error("You cannot use SelectResults after release().")
+      );
+    });
+
+    it("throws when the length is read afterwards", function() {
+      selectResults.release();
+
+      expect(function() { return selectResults.length; }).toThrow(
+        new Error("You cannot use SelectResults after release().")
+      );
+    });
+
+    it("passes an error to a cursor that is still reading", function(done) {
+      const cursor = selectResults.cursor();
+      selectResults.release();
+
+      cursor.next(function(error) {
+        expect(error).toBeError("Error", "You cannot use SelectResults after release().");
+        done();
+      });
+    });
+  });
+
   describe(".inspect", function() {
     it("returns a user-friendly display string describing the select results", function() {
       expect(selectResults.inspect()).toEqual('[SelectResults size=3]');
@@ -1,3 +1,5 @@
+const gemfire = require("./gemfire.js");
+
 module.exports = function itExecutesFunctions(subjectSource, expectFunctionsToThrowExceptionsCorrectly) {
   const testFunctionName = "io.pivotal.node_gemfire.TestFunction";
   var subject;
@@ -108,6 +110,119 @@ module.exports = function itExecutesFunctions(subjectSource, expectFunctionsToTh
         });
     });
 
+    it("emits the results as arrays with the batch option", function(done) {
+      const dataCallback = jasmine.createSpy("dataCallback");
+      subject.executeFunction("io.pivotal.node_gemfire.TestFunctionExceptionResult", { batch: true })
+        .on('data', dataCallback)
+        .on('error', function(error) {
+          expect(error).toBeError('UserFunctionExecutionException',
+                                  /java.lang.Exception: Test exception message sent by server./);
+          expect(dataCallback).toHaveBeenCalledWith(["First result"]);
+        })
+        .on('end', function() {
+          expect(dataCallback.calls.count()).toEqual(1);
+          expect(dataCallback).toHaveBeenCalledWith(["First result"]);
+          done();
+        });
+    });
+
+    it("throws an error when the batch option is not a boolean", function() {
+      function passInvalidBatch() {
+        subject.executeFunction(testFunctionName, { batch: "yes" });
+      }
+
+      expect(passInvalidBatch).toThrow(
+        new Error("You must pass true or false for the batch option for executeFunction().")
+      );
+    });
+
+    describe("executeFunctionStream", function() {
+      it("returns a readable stream of the results", function(done) {
+        const results = [];
+        subject.executeFunctionStream("io.pivotal.node_gemfire.Sum", {arguments: [1, 2, 3]})
+          .on("data", function(result) { results.push(result); })
+          .on("end", function() {
+            expect(results).toEqual([6]);
+            done();
+          });
+      });
+
+      it("holds the results until they are read", function(done) {
+        const stream = subject.executeFunctionStream(testFunctionName, {highWaterMark: 1});
+
+        setTimeout(function() {
+          stream.on("readable", function() {
+            const result = stream.read();
+            if (result !== null) {
+              expect(result).toEqual("TestFunction succeeded.");
+            }
+          });
+          stream.on("end", done);
+        }, 100);
+      });
+
+      it("passes on the errors the function sends", function(done) {
+        subject.executeFunctionStream("io.pivotal.node_gemfire.Passthrough")
+          .on("error", function(error) {
+            expect(error).toBeError('UserFunctionExecutionException',
+                                    /Expected arguments; no arguments received/);
+            done();
+          })
+          .resume();
+      });
+
+      it("emits a CancelledError when cancelled while nothing reads it", function(done) {
+        const cancelToken = new gemfire.CancelToken();
+        const stream = subject.executeFunctionStream(testFunctionName, {
+          highWaterMark: 1,
+          cancelToken: cancelToken
+        });
+
+        stream.on("error", function(error) {
+          expect(error).toBeError('CancelledError', 'The operation was cancelled.');
+          done();
+        });
+
+        setTimeout(function() { cancelToken.cancel(); }, 100);
+      });
+
+      it("emits close without end when destroyed", function(done) {
+        const endCallback = jasmine.createSpy("endCallback");
+        const stream = subject.executeFunctionStream(testFunctionName);
+
+        stream.on("end", endCallback);
+        stream.on("close", function() {
+          setTimeout(function() {
+            expect(endCallback).not.toHaveBeenCalled();
+            done();
+          }, 100);
+        });
+
+        stream.destroy();
+      });
+
+      it("throws an error when the highWaterMark is not a positive integer", function() {
+        expect(function() { subject.executeFunctionStream(testFunctionName, {highWaterMark: 0}); }).toThrow(
+          new Error("executeFunctionStream: highWaterMark must be a positive integer.")
+        );
+        expect(function() { subject.executeFunction(testFunctionName, {highWaterMark: 1.5}); }).toThrow(
+          new Error("executeFunction: highWaterMark must be a positive integer.")
+        );
+      });
+
+      it("throws an error when the synchronous option is passed", function() {
+        expect(function() { subject.executeFunctionStream(testFunctionName, {synchronous: true}); }).toThrow(
+          new Error("executeFunctionStream: the synchronous option is not supported.")
+        );
+      });
+
+      it("throws an error when the batch option is passed", function() {
+        expect(function() { subject.executeFunctionStream(testFunctionName, {batch: true}); }).toThrow(
+          new Error("executeFunctionStream: the batch option is not supported.")
+        );
+      });
+    });
+
     it("throws an error when the options are not an Object or an Array", function() {
       function passNonObjectAsOptions() {
         subject.executeFunction(
@@ -140,5 +255,36 @@ module.exports = function itExecutesFunctions(subjectSource, expectFunctionsToTh
           done();
         });
     });
+
+    it("emits a CancelledError instead of results when cancelled before it starts", function(done) {
+      const cancelToken = new gemfire.CancelToken();
+      const dataCallback = jasmine.createSpy("dataCallback");
+      const endCallback = jasmine.createSpy("endCallback");
+
+      cancelToken.cancel();
+
+      subject.executeFunction(testFunctionName, { cancelToken: cancelToken })
+        .on('data', dataCallback)
+        .on('end', endCallback)
+        .on('error', function(error) {
+          expect(error).toBeError('CancelledError', 'The operation was cancelled.');
+
+          setTimeout(function() {
+            expect(dataCallback).not.toHaveBeenCalled();
+            expect(endCallback).not.toHaveBeenCalled();
+            done();
+          }, 100);
+        });
+    });
+
+    it("throws an error when the timeout is not a positive number", function() {
+      function passInvalidTimeout() {
+        subject.executeFunction(testFunctionName, { timeout: -1 });
+      }
+
+      expect(passInvalidTimeout).toThrow(
+        new Error("executeFunction(): timeout must be a positive number of milliseconds.")
+      );
+    });
   });
 };
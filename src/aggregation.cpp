@@ -0,0 +1,271 @@
+#include "aggregation.hpp"
+#include <nan.h>
+#include <gfcpp/Struct.hpp>
+#include <gfcpp/PdxInstance.hpp>
+#include <cmath>
+#include <cstring>
+#include "conversions.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+bool Aggregation::parse(const Local<Value> & aggregationValue) {
+  NanScope();
+
+  if (!aggregationValue->IsObject() || aggregationValue->IsFunction() || aggregationValue->IsArray()) {
+    NanThrowError("You must pass an aggregation object and a callback to aggregate().");
+    return false;
+  }
+
+  Local<Object> aggregationObject(aggregationValue->ToObject());
+
+  Local<Value> countValue(aggregationObject->Get(NanNew("count")));
+  if (!countValue->IsUndefined()) {
+    if (!countValue->IsBoolean()) {
+      NanThrowError("aggregate: count must be true or false.");
+      return false;
+    }
+    count = countValue->BooleanValue();
+  }
+
+  if (!parseFields(aggregationObject, "sum", sumFields) ||
+      !parseFields(aggregationObject, "min", minFields) ||
+      !parseFields(aggregationObject, "max", maxFields)) {
+    return false;
+  }
+
+  Local<Value> groupByValue(aggregationObject->Get(NanNew("groupBy")));
+  if (!groupByValue->IsUndefined()) {
+    if (!groupByValue->IsString()) {
+      NanThrowError("aggregate: groupBy must be a field name.");
+      return false;
+    }
+    groupByField = *NanUtf8String(groupByValue);
+  }
+
+  if (!count && sumFields.empty() && minFields.empty() && maxFields.empty()) {
+    NanThrowError("aggregate: You must ask for count, sum, min or max.");
+    return false;
+  }
+
+  totals.resize(sumFields.size(), minFields.size(), maxFields.size());
+  nullGroupTotals.resize(sumFields.size(), minFields.size(), maxFields.size());
+
+  return true;
+}
+
+bool Aggregation::parseFields(const Local<Object> & aggregationObject,
+                              const char * name,
+                              std::vector<std::string> & fields) {
+  NanScope();
+
+  Local<Value> fieldsValue(aggregationObject->Get(NanNew(name)));
+  if (fieldsValue->IsUndefined()) {
+    return true;
+  }
+
+  if (fieldsValue->IsString()) {
+    fields.push_back(*NanUtf8String(fieldsValue));
+    return true;
+  }
+
+  if (fieldsValue->IsArray()) {
+    Local<Array> fieldsArray(Local<Array>::Cast(fieldsValue));
+    unsigned int length = fieldsArray->Length();
+
+    for (unsigned int i = 0; i < length; i++) {
+      Local<Value> fieldValue(fieldsArray->Get(i));
+      if (!fieldValue->IsString()) {
+        break;
+      }
+      fields.push_back(*NanUtf8String(fieldValue));
+    }
+
+    if (fields.size() == length && length > 0) {
+      return true;
+    }
+  }
+
+  std::string message(std::string("aggregate: ") + name +
+                      " must be a field name or an array of field names.");
+  NanThrowError(message.c_str());
+  return false;
+}
+
+bool Aggregation::run(const SelectResultsPtr & selectResultsPtr, std::string & error) {
+  int32_t length = selectResultsPtr->size();
+
+  for (int32_t row = 0; row < length; row++) {
+    SerializablePtr rowPtr((*selectResultsPtr)[row]);
+
+    if (groupByField.empty()) {
+      add(totals, rowPtr);
+      continue;
+    }
+
+    Totals * rowTotals = totalsFor(fieldValue(rowPtr, groupByField));
+    if (rowTotals == NULL) {
+      error = "aggregate: the values of the groupBy field must be strings, numbers, booleans or dates.";
+      return false;
+    }
+
+    add(*rowTotals, rowPtr);
+  }
+
+  return true;
+}
+
+Aggregation::Totals * Aggregation::totalsFor(const CacheablePtr & groupPtr) {
+  if (groupPtr == NULLPTR || groupPtr->typeId() == GemfireTypeIds::CacheableUndefined) {
+    return &nullGroupTotals;
+  }
+
+  CacheableKeyPtr groupKeyPtr(dynamic_cast<CacheableKey *>(groupPtr.ptr()));
+  if (groupKeyPtr == NULLPTR) {
+    return NULL;
+  }
+
+  GroupIndex::iterator iterator(groupIndex.find(groupKeyPtr));
+  if (iterator != groupIndex.end()) {
+    return &groupTotals[iterator->second];
+  }
+
+  groupIndex[groupKeyPtr] = groupTotals.size();
+  groupKeys.push_back(groupKeyPtr);
+  groupTotals.push_back(Totals());
+  groupTotals.back().resize(sumFields.size(), minFields.size(), maxFields.size());
+
+  return &groupTotals.back();
+}
+
+// Values that aren't numbers, including nulls, are left out of sums, minimums and maximums.
+void Aggregation::add(Totals & totals, const SerializablePtr & rowPtr) {
+  totals.count++;
+
+  double value;
+
+  for (unsigned int i = 0; i < sumFields.size(); i++) {
+    if (numberValue(fieldValue(rowPtr, sumFields[i]), value)) {
+      totals.sums[i] += value;
+    }
+  }
+
+  for (unsigned int i = 0; i < minFields.size(); i++) {
+    if (numberValue(fieldValue(rowPtr, minFields[i]), value) &&
+        (std::isnan(totals.mins[i]) || value < totals.mins[i])) {
+      totals.mins[i] = value;
+    }
+  }
+
+  for (unsigned int i = 0; i < maxFields.size(); i++) {
+    if (numberValue(fieldValue(rowPtr, maxFields[i]), value) &&
+        (std::isnan(totals.maxes[i]) || value > totals.maxes[i])) {
+      totals.maxes[i] = value;
+    }
+  }
+}
+
+CacheablePtr Aggregation::fieldValue(const SerializablePtr & rowPtr, const std::string & field) {
+  if (rowPtr == NULLPTR) {
+    return NULLPTR;
+  }
+
+  if (field == "this") {
+    return CacheablePtr(dynamic_cast<Cacheable *>(rowPtr.ptr()));
+  }
+
+  if (rowPtr->typeId() == GemfireTypeIds::Struct) {
+    StructPtr structPtr(static_cast<StructPtr>(rowPtr));
+
+    int32_t length = structPtr->length();
+    for (int32_t i = 0; i < length; i++) {
+      if (strcmp(structPtr->getFieldName(i), field.c_str()) == 0) {
+        return (*structPtr)[i];
+      }
+    }
+
+    return NULLPTR;
+  }
+
+  PdxInstance * pdxInstance = dynamic_cast<PdxInstance *>(rowPtr.ptr());
+  if (pdxInstance == NULL || !pdxInstance->hasField(field.c_str())) {
+    return NULLPTR;
+  }
+
+  CacheablePtr valuePtr;
+  pdxInstance->getField(field.c_str(), valuePtr);
+  return valuePtr;
+}
+
+void Aggregation::Totals::resize(unsigned int sums, unsigned int mins, unsigned int maxes) {
+  this->sums.resize(sums, 0);
+  this->mins.resize(mins, NAN);
+  this->maxes.resize(maxes, NAN);
+}
+
+Local<Value> Aggregation::v8Result() {
+  NanEscapableScope();
+
+  if (groupByField.empty()) {
+    return NanEscapeScope(v8Totals(totals));
+  }
+
+  Local<Array> groups(NanNew<Array>());
+
+  for (unsigned int i = 0; i < groupKeys.size(); i++) {
+    Local<Object> group(v8Totals(groupTotals[i]));
+    group->Set(NanNew("group"), v8Value(groupKeys[i]));
+    groups->Set(i, group);
+  }
+
+  if (nullGroupTotals.count > 0) {
+    Local<Object> group(v8Totals(nullGroupTotals));
+    group->Set(NanNew("group"), NanNull());
+    groups->Set(groups->Length(), group);
+  }
+
+  return NanEscapeScope(groups);
+}
+
+Local<Object> Aggregation::v8Totals(const Totals & totals) {
+  NanEscapableScope();
+
+  Local<Object> v8Totals(NanNew<Object>());
+
+  if (count) {
+    v8Totals->Set(NanNew("count"), NanNew(totals.count));
+  }
+  if (!sumFields.empty()) {
+    v8Totals->Set(NanNew("sum"), v8Numbers(sumFields, totals.sums));
+  }
+  if (!minFields.empty()) {
+    v8Totals->Set(NanNew("min"), v8Numbers(minFields, totals.mins));
+  }
+  if (!maxFields.empty()) {
+    v8Totals->Set(NanNew("max"), v8Numbers(maxFields, totals.maxes));
+  }
+
+  return NanEscapeScope(v8Totals);
+}
+
+// Minimums and maximums of fields without any numbers are null.
+Local<Value> Aggregation::v8Numbers(const std::vector<std::string> & fields,
+                                    const std::vector<double> & values) {
+  NanEscapableScope();
+
+  Local<Object> v8Numbers(NanNew<Object>());
+
+  for (unsigned int i = 0; i < fields.size(); i++) {
+    if (std::isnan(values[i])) {
+      v8Numbers->Set(NanNew(fields[i].c_str()), NanNull());
+    } else {
+      v8Numbers->Set(NanNew(fields[i].c_str()), NanNew<Number>(values[i]));
+    }
+  }
+
+  return NanEscapeScope(v8Numbers);
+}
+
+}  // namespace node_gemfire
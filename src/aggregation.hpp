@@ -0,0 +1,81 @@
+#ifndef __AGGREGATION_HPP__
+#define __AGGREGATION_HPP__
+
+#include <v8.h>
+#include <gfcpp/SelectResults.hpp>
+#include <gfcpp/CacheableKey.hpp>
+#include <tr1/unordered_map>
+#include <string>
+#include <vector>
+#include "cacheable_key_functors.hpp"
+
+namespace node_gemfire {
+
+// Counts, sums, and finds the minimum and maximum of fields over query results, optionally by
+// group, reading the fields straight from the GemFire rows. Rows may be structs, PDX instances or,
+// through the field name "this", numbers themselves.
+//
+// parse() and v8Result() run on the main thread; run() only touches GemFire objects, so that it
+// can run on a worker thread.
+class Aggregation {
+ public:
+  Aggregation() :
+    count(false) {}
+
+  // Returns false after throwing if the aggregation object is invalid.
+  bool parse(const v8::Local<v8::Value> & aggregationValue);
+
+  // Returns false if a groupBy value can't be used as a group, with a message in `error`.
+  bool run(const gemfire::SelectResultsPtr & selectResultsPtr, std::string & error);
+
+  v8::Local<v8::Value> v8Result();
+
+ private:
+  class Totals {
+   public:
+    Totals() :
+      count(0) {}
+
+    void resize(unsigned int sums, unsigned int mins, unsigned int maxes);
+
+    unsigned int count;
+    std::vector<double> sums;
+    std::vector<double> mins;
+    std::vector<double> maxes;
+  };
+
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  unsigned int,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> GroupIndex;
+
+  // Returns NULL if the value can't be used as a group.
+  Totals * totalsFor(const gemfire::CacheablePtr & groupPtr);
+  void add(Totals & totals, const gemfire::SerializablePtr & rowPtr);
+  v8::Local<v8::Object> v8Totals(const Totals & totals);
+  v8::Local<v8::Value> v8Numbers(const std::vector<std::string> & fields,
+                                 const std::vector<double> & values);
+
+  static bool parseFields(const v8::Local<v8::Object> & aggregationObject,
+                          const char * name,
+                          std::vector<std::string> & fields);
+  static gemfire::CacheablePtr fieldValue(const gemfire::SerializablePtr & rowPtr,
+                                          const std::string & field);
+
+  bool count;
+  std::vector<std::string> sumFields;
+  std::vector<std::string> minFields;
+  std::vector<std::string> maxFields;
+  std::string groupByField;
+
+  // Groups keep the order in which their first row was seen; rows without a group come last.
+  std::vector<gemfire::CacheableKeyPtr> groupKeys;
+  std::vector<Totals> groupTotals;
+  GroupIndex groupIndex;
+  Totals nullGroupTotals;
+  Totals totals;
+};
+
+}  // namespace node_gemfire
+
+#endif
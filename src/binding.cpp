@@ -7,6 +7,10 @@
 #include "cache.hpp"
 #include "region.hpp"
 #include "select_results.hpp"
+#include "cancel_token.hpp"
+#include "event_payload.hpp"
+#include "continuous_query.hpp"
+#include "prepared_query.hpp"
 
 using namespace v8;
 using namespace gemfire;
@@ -39,6 +43,10 @@ NAN_METHOD(Initialize) {
   node_gemfire::Cache::Init(gemfire);
   node_gemfire::Region::Init(gemfire);
   node_gemfire::SelectResults::Init(gemfire);
+  node_gemfire::PreparedQuery::Init(gemfire);
+  node_gemfire::CancelToken::Init(gemfire);
+  node_gemfire::EventPayload::Init();
+  node_gemfire::ContinuousQuery::Init(gemfire);
 
   NanAssignPersistent(dependencies, args[0]->ToObject());
 
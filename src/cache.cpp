@@ -6,6 +6,7 @@
 #include <gfcpp/Region.hpp>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "exceptions.hpp"
 #include "conversions.hpp"
 #include "region.hpp"
@@ -13,6 +14,11 @@
 #include "dependencies.hpp"
 #include "functions.hpp"
 #include "region_shortcuts.hpp"
+#include "operation_options.hpp"
+#include "work_limiter.hpp"
+#include "region_event_registry.hpp"
+#include "continuous_query.hpp"
+#include "prepared_query.hpp"
 
 using namespace v8;
 using namespace gemfire;
@@ -34,6 +40,10 @@ void Cache::Init(Local<Object> exports) {
       NanNew<FunctionTemplate>(Cache::ExecuteFunction)->GetFunction());
   NanSetPrototypeTemplate(cacheConstructorTemplate, "executeQuery",
       NanNew<FunctionTemplate>(Cache::ExecuteQuery)->GetFunction());
+  NanSetPrototypeTemplate(cacheConstructorTemplate, "executeCq",
+      NanNew<FunctionTemplate>(Cache::ExecuteCq)->GetFunction());
+  NanSetPrototypeTemplate(cacheConstructorTemplate, "prepareQuery",
+      NanNew<FunctionTemplate>(Cache::PrepareQuery)->GetFunction());
   NanSetPrototypeTemplate(cacheConstructorTemplate, "createRegion",
       NanNew<FunctionTemplate>(Cache::CreateRegion)->GetFunction());
   NanSetPrototypeTemplate(cacheConstructorTemplate, "getRegion",
@@ -42,6 +52,14 @@ void Cache::Init(Local<Object> exports) {
       NanNew<FunctionTemplate>(Cache::RootRegions)->GetFunction());
   NanSetPrototypeTemplate(cacheConstructorTemplate, "inspect",
       NanNew<FunctionTemplate>(Cache::Inspect)->GetFunction());
+  NanSetPrototypeTemplate(cacheConstructorTemplate, "setLimits",
+      NanNew<FunctionTemplate>(Cache::SetLimits)->GetFunction());
+  NanSetPrototypeTemplate(cacheConstructorTemplate, "setEventQueueOptions",
+      NanNew<FunctionTemplate>(Cache::SetEventQueueOptions)->GetFunction());
+  NanSetPrototypeTemplate(cacheConstructorTemplate, "setQueryResultCache",
+      NanNew<FunctionTemplate>(Cache::SetQueryResultCache)->GetFunction());
+
+  cacheConstructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("statistics"), Cache::Statistics);
 
   exports->Set(NanNew("Cache"), cacheConstructorTemplate->GetFunction());
 }
@@ -106,6 +124,12 @@ NAN_METHOD(Cache::Close) {
 }
 
 void Cache::close() {
+  queryCache.clear();
+
+  if (queryResultCachePtr != NULLPTR) {
+    queryResultCachePtr->clear();
+  }
+
   if (!cachePtr->isClosed()) {
     cachePtr->close();
   }
@@ -118,10 +142,27 @@ class ExecuteQueryWorker : public GemfireWorker {
                      NanCallback * callback) :
       GemfireWorker(callback),
       queryPtr(queryPtr),
-      queryParamsPtr(queryParamsPtr) {}
+      queryParamsPtr(queryParamsPtr),
+      queryResultCachePtr(NULLPTR) {}
+
+  void setQueryResultCache(const QueryResultCachePtr & queryResultCachePtr,
+                           const std::string & resultKey,
+                           const std::vector<std::string> & regionPaths) {
+    this->queryResultCachePtr = queryResultCachePtr;
+    this->resultKey = resultKey;
+    this->regionPaths = regionPaths;
+  }
 
   void ExecuteGemfireWork() {
-    selectResultsPtr = queryPtr->execute(queryParamsPtr);
+    if (queryResultCachePtr == NULLPTR) {
+      selectResultsPtr = queryPtr->execute(queryParamsPtr,
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
+    } else if (!queryResultCachePtr->get(resultKey, selectResultsPtr)) {
+      QueryResultCache::Epochs epochs(queryResultCachePtr->epochs(regionPaths));
+      selectResultsPtr = queryPtr->execute(queryParamsPtr,
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
+      queryResultCachePtr->add(resultKey, regionPaths, selectResultsPtr, epochs);
+    }
   }
 
   void HandleOKCallback() {
@@ -135,6 +176,9 @@ class ExecuteQueryWorker : public GemfireWorker {
   QueryPtr queryPtr;
   CacheableVectorPtr queryParamsPtr;
   SelectResultsPtr selectResultsPtr;
+  QueryResultCachePtr queryResultCachePtr;
+  std::string resultKey;
+  std::vector<std::string> regionPaths;
 };
 
 NAN_METHOD(Cache::ExecuteQuery) {
@@ -155,6 +199,7 @@ NAN_METHOD(Cache::ExecuteQuery) {
   Local<Function> callbackFunction;
   Local<Value> poolNameValue(NanUndefined());
   Local<Value> queryParams;
+  OperationOptions operationOptions;
 
   // .executeQuery(query, function)
   if (args[1]->IsFunction()) {
@@ -166,6 +211,10 @@ NAN_METHOD(Cache::ExecuteQuery) {
     if (args[1]->IsObject() && !args[1]->IsFunction()) {
       Local<Object> optionsObject = args[1]->ToObject();
       poolNameValue = optionsObject->Get(NanNew("poolName"));
+
+      if (!operationOptions.parse(optionsObject, "executeQuery()")) {
+        NanReturnUndefined();
+      }
     }
     // .executeQuery(query, paramsArray, optionsHash, function)
   } else if (argsLength > 3 && args[3]->IsFunction()) {
@@ -178,6 +227,10 @@ NAN_METHOD(Cache::ExecuteQuery) {
     if (args[2]->IsObject() && !args[2]->IsFunction()) {
       Local<Object> optionsObject = args[2]->ToObject();
       poolNameValue = optionsObject->Get(NanNew("poolName"));
+
+      if (!operationOptions.parse(optionsObject, "executeQuery()")) {
+        NanReturnUndefined();
+      }
     }
   } else {
     NanThrowError("You must pass a function as the callback to executeQuery().");
@@ -192,46 +245,355 @@ NAN_METHOD(Cache::ExecuteQuery) {
     NanReturnUndefined();
   }
 
-  QueryServicePtr queryServicePtr;
   CacheableVectorPtr queryParamsPtr = NULLPTR;
 
   std::string queryString(*NanUtf8String(args[0]));
 
+  QueryServicePtr queryServicePtr(getQueryService(cachePtr, poolNameValue, "executeQuery"));
+  if (queryServicePtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+  if (!(queryParams.IsEmpty() || queryParams->IsUndefined())) {
+    queryParamsPtr = gemfireVector(queryParams.As<Array>(), cachePtr);
+  }
+
+  QueryPtr queryPtr;
   try {
-    if (poolNameValue->IsUndefined()) {
-      queryServicePtr = cachePtr->getQueryService();
-    } else {
-      std::string poolName(*NanUtf8String(poolNameValue));
-      PoolPtr poolPtr(getPool(poolNameValue));
+    queryPtr = cache->queryCache.get(queryServicePtr, poolName(poolNameValue), queryString);
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+
+  NanCallback * callback = new NanCallback(callbackFunction);
+
+  if (!cache->queueQuery(args.This(), queryPtr, poolName(poolNameValue), queryParams, queryParamsPtr,
+                         operationOptions, callback)) {
+    NanReturnUndefined();
+  }
+
+  NanReturnValue(args.This());
+}
+
+bool Cache::queueQuery(const Local<Object> & cacheObject,
+                       const QueryPtr & queryPtr,
+                       const std::string & poolName,
+                       const Local<Value> & queryParams,
+                       const CacheableVectorPtr & queryParamsPtr,
+                       const OperationOptions & operationOptions,
+                       NanCallback * callback) {
+  ExecuteQueryWorker * worker = new ExecuteQueryWorker(queryPtr, queryParamsPtr, callback);
+  worker->setOperationOptions(operationOptions);
+
+  if (queryResultCachePtr != NULLPTR) {
+    std::string queryString(queryPtr->getQueryString());
+    std::string resultKey(QueryResultCache::key("pool " + poolName, queryString, queryParams));
+
+    if (!resultKey.empty()) {
+      std::vector<std::string> regionPaths(QueryResultCache::regionPaths(queryString));
+      attachQueryResultCache(cacheObject, regionPaths);
+      worker->setQueryResultCache(queryResultCachePtr, resultKey, regionPaths);
+    }
+  }
+
+  LimitedWork * work = new LimitedWork(worker, NULLPTR, NULLPTR);
+  if (limiterPtr != NULLPTR) {
+    work->addLimiter(limiterPtr, cacheObject);
+  }
+
+  return work->start();
+}
+
+NAN_METHOD(Cache::PrepareQuery) {
+  NanScope();
+
+  if (args.Length() == 0 || !args[0]->IsString()) {
+    NanThrowError("You must pass a query string to prepareQuery().");
+    NanReturnUndefined();
+  }
+
+  Local<Value> poolNameValue(NanUndefined());
+  if (!args[1]->IsUndefined()) {
+    if (!args[1]->IsObject() || args[1]->IsFunction()) {
+      NanThrowError("You must pass an options object to prepareQuery().");
+      NanReturnUndefined();
+    }
+
+    poolNameValue = args[1]->ToObject()->Get(NanNew("poolName"));
+  }
 
-      if (poolPtr == NULLPTR) {
-        std::string poolName(*NanUtf8String(poolNameValue));
-        std::stringstream errorMessageStream;
-        errorMessageStream << "executeQuery: `" << poolName << "` is not a valid pool name";
-        NanThrowError(errorMessageStream.str().c_str());
+  Cache * cache = ObjectWrap::Unwrap<Cache>(args.This());
+  CachePtr cachePtr(cache->cachePtr);
+
+  if (cachePtr->isClosed()) {
+    NanThrowError("Cannot prepare query; cache is closed.");
+    NanReturnUndefined();
+  }
+
+  QueryServicePtr queryServicePtr(getQueryService(cachePtr, poolNameValue, "prepareQuery"));
+  if (queryServicePtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  std::string queryString(*NanUtf8String(args[0]));
+
+  QueryPtr queryPtr;
+  try {
+    queryPtr = cache->queryCache.get(queryServicePtr, poolName(poolNameValue), queryString);
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+
+  NanReturnValue(PreparedQuery::NewInstance(args.This(), queryPtr, poolName(poolNameValue), queryString));
+}
+
+NAN_METHOD(Cache::ExecuteCq) {
+  NanScope();
+
+  if (args.Length() == 0 || !args[0]->IsString()) {
+    NanThrowError("You must pass a query string to executeCq().");
+    NanReturnUndefined();
+  }
+
+  // GemFire evaluates continuous queries on the server for every change, and they can't be bound
+  // to parameters there.
+  if (args[1]->IsArray()) {
+    NanThrowError("executeCq: continuous queries don't take parameters.");
+    NanReturnUndefined();
+  }
+
+  Local<Value> poolNameValue(NanUndefined());
+  bool withInitialResults = false;
+  OperationOptions operationOptions;
+
+  if (!args[1]->IsUndefined()) {
+    if (!args[1]->IsObject() || args[1]->IsFunction()) {
+      NanThrowError("You must pass an options object to executeCq().");
+      NanReturnUndefined();
+    }
+
+    Local<Object> optionsObject(args[1]->ToObject());
+    poolNameValue = optionsObject->Get(NanNew("poolName"));
+
+    Local<Value> initialResultsValue(optionsObject->Get(NanNew("initialResults")));
+    if (!initialResultsValue->IsUndefined()) {
+      if (!initialResultsValue->IsBoolean()) {
+        NanThrowError("executeCq: initialResults must be true or false.");
         NanReturnUndefined();
       }
+      withInitialResults = initialResultsValue->BooleanValue();
+    }
 
-      queryServicePtr = cachePtr->getQueryService(poolName.c_str());
+    if (!operationOptions.parse(optionsObject, "executeCq()")) {
+      NanReturnUndefined();
     }
+  }
+
+  Cache * cache = ObjectWrap::Unwrap<Cache>(args.This());
+  CachePtr cachePtr(cache->cachePtr);
+
+  if (cachePtr->isClosed()) {
+    NanThrowError("Cannot execute continuous query; cache is closed.");
+    NanReturnUndefined();
+  }
+
+  QueryServicePtr queryServicePtr(getQueryService(cachePtr, poolNameValue, "executeCq"));
+  if (queryServicePtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  std::string queryString(*NanUtf8String(args[0]));
+
+  try {
+    NanReturnValue(ContinuousQuery::New(queryServicePtr, queryString.c_str(), withInitialResults,
+                                        operationOptions));
   } catch (const gemfire::Exception & exception) {
     ThrowGemfireException(exception);
     NanReturnUndefined();
   }
-  if (!(queryParams.IsEmpty() || queryParams->IsUndefined())) {
-    queryParamsPtr = gemfireVector(queryParams.As<Array>(), cachePtr);
+}
+
+NAN_METHOD(Cache::SetLimits) {
+  NanScope();
+
+  Cache * cache = ObjectWrap::Unwrap<Cache>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    cache->limiterPtr = NULLPTR;
+    NanReturnValue(args.This());
   }
 
-  QueryPtr queryPtr(queryServicePtr->newQuery(queryString.c_str()));
+  WorkLimiterPtr limiterPtr;
+  if (!WorkLimiter::parse(args[0], "cache", limiterPtr)) {
+    NanReturnUndefined();
+  }
 
-  NanCallback * callback = new NanCallback(callbackFunction);
+  cache->limiterPtr = limiterPtr;
 
-  ExecuteQueryWorker * worker = new ExecuteQueryWorker(queryPtr, queryParamsPtr, callback);
-  NanAsyncQueueWorker(worker);
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Cache::SetEventQueueOptions) {
+  NanScope();
+
+  EventStream * eventStream = RegionEventRegistry::getInstance()->getEventStream();
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    eventStream->setLimit(0, EventStream::DROP_OLDEST);
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setEventQueueOptions().");
+    NanReturnUndefined();
+  }
+
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> maxEvents(optionsObject->Get(NanNew("maxEvents")));
+  Local<Value> policy(optionsObject->Get(NanNew("policy")));
+
+  if (!(maxEvents->IsUint32() && maxEvents->Uint32Value() > 0)) {
+    NanThrowError("setEventQueueOptions: maxEvents must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  static const EventStream::OverflowPolicy policies[] = {
+    EventStream::DROP_OLDEST, EventStream::DROP_NEWEST, EventStream::BLOCK, EventStream::CONFLATE
+  };
+
+  EventStream::OverflowPolicy overflowPolicy = EventStream::DROP_OLDEST;
+  if (!policy->IsUndefined()) {
+    std::string policyName(*NanUtf8String(policy));
+
+    unsigned int i = 0;
+    while (i < sizeof(policies) / sizeof(policies[0]) && policyName != EventStream::policyName(policies[i])) {
+      i++;
+    }
+
+    if (!policy->IsString() || i == sizeof(policies) / sizeof(policies[0])) {
+      NanThrowError("setEventQueueOptions: policy must be \"drop-oldest\", \"drop-newest\", \"block\" or "
+                    "\"conflate\".");
+      NanReturnUndefined();
+    }
+
+    overflowPolicy = policies[i];
+  }
+
+  eventStream->setLimit(maxEvents->Uint32Value(), overflowPolicy);
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Cache::SetQueryResultCache) {
+  NanScope();
+
+  Cache * cache = ObjectWrap::Unwrap<Cache>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    cache->detachQueryResultCache();
+    cache->queryResultCachePtr = NULLPTR;
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setQueryResultCache().");
+    NanReturnUndefined();
+  }
+
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> ttl(optionsObject->Get(NanNew("ttl")));
+  Local<Value> maxEntries(optionsObject->Get(NanNew("maxEntries")));
+
+  if (!(ttl->IsUint32() && ttl->Uint32Value() > 0)) {
+    NanThrowError("setQueryResultCache: ttl must be a positive number of milliseconds.");
+    NanReturnUndefined();
+  }
+
+  if (!(maxEntries->IsUint32() && maxEntries->Uint32Value() > 0)) {
+    NanThrowError("setQueryResultCache: maxEntries must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  cache->detachQueryResultCache();
+  cache->queryResultCachePtr = new QueryResultCache(ttl->Uint32Value(), maxEntries->Uint32Value());
 
   NanReturnValue(args.This());
 }
 
+void Cache::attachQueryResultCache(const Local<Object> & cacheObject,
+                                   const std::vector<std::string> & regionPaths) {
+  NanScope();
+
+  for (std::vector<std::string>::const_iterator iterator(regionPaths.begin());
+       iterator != regionPaths.end();
+       ++iterator) {
+    RegionPtr regionPtr;
+    try {
+      regionPtr = cachePtr->getRegion(iterator->c_str());
+    } catch (const gemfire::Exception &) {
+      continue;
+    }
+
+    if (regionPtr == NULLPTR) {
+      continue;
+    }
+
+    Region * region = ObjectWrap::Unwrap<Region>(Region::New(cacheObject, regionPtr)->ToObject());
+    if (region->queryResultCachePtr != queryResultCachePtr) {
+      region->queryResultCachePtr = queryResultCachePtr;
+      region->updateEventSubscriptions();
+      queryResultRegionPaths.insert(*iterator);
+    }
+  }
+}
+
+void Cache::detachQueryResultCache() {
+  if (queryResultCachePtr == NULLPTR) {
+    return;
+  }
+
+  queryResultCachePtr->clear();
+
+  for (std::tr1::unordered_set<std::string>::iterator iterator(queryResultRegionPaths.begin());
+       iterator != queryResultRegionPaths.end() && !cachePtr->isClosed();
+       ++iterator) {
+    RegionPtr regionPtr(cachePtr->getRegion(iterator->c_str()));
+    Region * region = RegionEventRegistry::getInstance()->find(regionPtr);
+    if (region != NULL && region->queryResultCachePtr == queryResultCachePtr) {
+      region->queryResultCachePtr = NULLPTR;
+      region->updateEventSubscriptions();
+    }
+  }
+
+  queryResultRegionPaths.clear();
+}
+
+NAN_GETTER(Cache::Statistics) {
+  NanScope();
+
+  Cache * cache = ObjectWrap::Unwrap<Cache>(args.This());
+
+  Local<Object> returnValue(NanNew<Object>());
+
+  if (cache->limiterPtr == NULLPTR) {
+    returnValue->Set(NanNew("limits"), NanNull());
+  } else {
+    returnValue->Set(NanNew("limits"), cache->limiterPtr->statistics());
+  }
+
+  returnValue->Set(NanNew("eventQueue"), RegionEventRegistry::getInstance()->getEventStream()->statistics());
+  returnValue->Set(NanNew("queryCache"), cache->queryCache.statistics());
+
+  if (cache->queryResultCachePtr == NULLPTR) {
+    returnValue->Set(NanNew("queryResultCache"), NanNull());
+  } else {
+    returnValue->Set(NanNew("queryResultCache"), cache->queryResultCachePtr->statistics());
+  }
+
+  NanReturnValue(returnValue);
+}
+
 NAN_METHOD(Cache::CreateRegion) {
   NanScope();
 
@@ -373,6 +735,41 @@ NAN_METHOD(Cache::ExecuteFunction) {
   }
 }
 
+// The name the query cache knows the pool by; the default query service has none.
+std::string Cache::poolName(const Handle<Value> & poolNameValue) {
+  if (poolNameValue->IsUndefined()) {
+    return std::string();
+  }
+
+  return std::string(*NanUtf8String(poolNameValue));
+}
+
+// Throws a JavaScript exception and returns NULLPTR if there is no such pool.
+QueryServicePtr Cache::getQueryService(const CachePtr & cachePtr,
+                                       const Handle<Value> & poolNameValue,
+                                       const char * methodName) {
+  try {
+    if (poolNameValue->IsUndefined()) {
+      return cachePtr->getQueryService();
+    }
+
+    std::string poolName(*NanUtf8String(poolNameValue));
+    PoolPtr poolPtr(getPool(poolNameValue));
+
+    if (poolPtr == NULLPTR) {
+      std::stringstream errorMessageStream;
+      errorMessageStream << methodName << ": `" << poolName << "` is not a valid pool name";
+      NanThrowError(errorMessageStream.str().c_str());
+      return NULLPTR;
+    }
+
+    return cachePtr->getQueryService(poolName.c_str());
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    return NULLPTR;
+  }
+}
+
 PoolPtr Cache::getPool(const Handle<Value> & poolNameValue) {
   if (!poolNameValue->IsUndefined()) {
     std::string poolName(*NanUtf8String(poolNameValue));
@@ -4,7 +4,16 @@
 #include <v8.h>
 #include <nan.h>
 #include <node.h>
+#include <string>
+#include <vector>
+#include <tr1/unordered_set>
 #include <gfcpp/Cache.hpp>
+#include <gfcpp/Query.hpp>
+#include <gfcpp/CacheableBuiltins.hpp>
+#include "work_limiter.hpp"
+#include "operation_options.hpp"
+#include "query_cache.hpp"
+#include "query_result_cache.hpp"
 
 namespace node_gemfire {
 
@@ -12,12 +21,33 @@ class Cache : public node::ObjectWrap {
  public:
   static void Init(v8::Local<v8::Object> exports);
 
+  // Starts executing the query under the limits of the cache, answering it from the query result
+  // cache if possible. Returns false after throwing if the limits reject it.
+  bool queueQuery(const v8::Local<v8::Object> & cacheObject,
+                  const gemfire::QueryPtr & queryPtr,
+                  const std::string & poolName,
+                  const v8::Local<v8::Value> & queryParams,
+                  const gemfire::CacheableVectorPtr & queryParamsPtr,
+                  const OperationOptions & operationOptions,
+                  NanCallback * callback);
+
+  // Has events and local writes of the regions with these paths invalidate the query result cache.
+  // Regions that don't exist in this client can't be watched; their results only expire.
+  void attachQueryResultCache(const v8::Local<v8::Object> & cacheObject,
+                              const std::vector<std::string> & regionPaths);
+
   gemfire::CachePtr cachePtr;
+  WorkLimiterPtr limiterPtr;
+  QueryCache queryCache;
+  QueryResultCachePtr queryResultCachePtr;
 
  protected:
   explicit Cache(
       gemfire::CachePtr cachePtr) :
-    cachePtr(cachePtr) {}
+    cachePtr(cachePtr),
+    limiterPtr(NULLPTR),
+    queryCache(maxCachedQueries),
+    queryResultCachePtr(NULLPTR) {}
 
   virtual ~Cache() {
     close();
@@ -29,14 +59,30 @@ class Cache : public node::ObjectWrap {
   static NAN_METHOD(Close);
   static NAN_METHOD(ExecuteFunction);
   static NAN_METHOD(ExecuteQuery);
+  static NAN_METHOD(ExecuteCq);
+  static NAN_METHOD(PrepareQuery);
   static NAN_METHOD(CreateRegion);
   static NAN_METHOD(GetRegion);
   static NAN_METHOD(RootRegions);
   static NAN_METHOD(Inspect);
+  static NAN_METHOD(SetLimits);
+  static NAN_METHOD(SetEventQueueOptions);
+  static NAN_METHOD(SetQueryResultCache);
+  static NAN_GETTER(Statistics);
 
  private:
+  static const unsigned int maxCachedQueries = 256;
+
   static gemfire::PoolPtr getPool(const v8::Handle<v8::Value> & poolNameValue);
+  static std::string poolName(const v8::Handle<v8::Value> & poolNameValue);
+  static gemfire::QueryServicePtr getQueryService(const gemfire::CachePtr & cachePtr,
+                                                  const v8::Handle<v8::Value> & poolNameValue,
+                                                  const char * methodName);
   v8::Local<v8::Function> exitCallback();
+  void detachQueryResultCache();
+
+  // The paths of the regions whose wrappers were given the query result cache.
+  std::tr1::unordered_set<std::string> queryResultRegionPaths;
 };
 
 }  // namespace node_gemfire
@@ -0,0 +1,26 @@
+#ifndef __CACHEABLE_KEY_FUNCTORS_HPP__
+#define __CACHEABLE_KEY_FUNCTORS_HPP__
+
+#include <gfcpp/CacheableKey.hpp>
+#include <cstddef>
+
+namespace node_gemfire {
+
+// Hash and equality functors that compare GemFire keys by value rather than by pointer, so that
+// CacheableKeyPtr can be used as the key of a std::tr1::unordered_map.
+struct CacheableKeyHash {
+  size_t operator()(const gemfire::CacheableKeyPtr & keyPtr) const {
+    return static_cast<size_t>(keyPtr->hashcode());
+  }
+};
+
+struct CacheableKeyEqual {
+  bool operator()(const gemfire::CacheableKeyPtr & leftPtr,
+                  const gemfire::CacheableKeyPtr & rightPtr) const {
+    return *leftPtr == *rightPtr;
+  }
+};
+
+}  // namespace node_gemfire
+
+#endif
@@ -0,0 +1,76 @@
+#include "cancel_token.hpp"
+
+using namespace v8;
+
+namespace node_gemfire {
+
+Persistent<FunctionTemplate> CancelToken::constructorTemplate;
+
+void CancelState::cancel() {
+  uv_mutex_lock(&mutex);
+  cancelled = true;
+  uv_mutex_unlock(&mutex);
+}
+
+bool CancelState::isCancelled() {
+  uv_mutex_lock(&mutex);
+  bool returnValue = cancelled;
+  uv_mutex_unlock(&mutex);
+
+  return returnValue;
+}
+
+void CancelToken::Init(Local<Object> exports) {
+  NanScope();
+
+  Local<FunctionTemplate> cancelTokenConstructorTemplate =
+    NanNew<FunctionTemplate>(CancelToken::New);
+
+  cancelTokenConstructorTemplate->SetClassName(NanNew("CancelToken"));
+  cancelTokenConstructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NanSetPrototypeTemplate(cancelTokenConstructorTemplate, "cancel",
+      NanNew<FunctionTemplate>(CancelToken::Cancel)->GetFunction());
+
+  cancelTokenConstructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("cancelled"),
+      CancelToken::Cancelled);
+
+  NanAssignPersistent(constructorTemplate, cancelTokenConstructorTemplate);
+  exports->Set(NanNew("CancelToken"), cancelTokenConstructorTemplate->GetFunction());
+}
+
+NAN_METHOD(CancelToken::New) {
+  NanScope();
+
+  if (!args.IsConstructCall()) {
+    NanThrowError("Use the new operator to create a CancelToken.");
+    NanReturnUndefined();
+  }
+
+  CancelToken * cancelToken = new CancelToken();
+  cancelToken->Wrap(args.This());
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(CancelToken::Cancel) {
+  NanScope();
+
+  CancelToken * cancelToken = ObjectWrap::Unwrap<CancelToken>(args.This());
+  cancelToken->cancelStatePtr->cancel();
+
+  NanReturnValue(args.This());
+}
+
+NAN_GETTER(CancelToken::Cancelled) {
+  NanScope();
+
+  CancelToken * cancelToken = ObjectWrap::Unwrap<CancelToken>(args.This());
+  NanReturnValue(NanNew(cancelToken->cancelStatePtr->isCancelled()));
+}
+
+bool CancelToken::HasInstance(const Local<Value> & value) {
+  return NanHasInstance(constructorTemplate, value);
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,56 @@
+#ifndef __CANCEL_TOKEN_HPP__
+#define __CANCEL_TOKEN_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <node.h>
+#include <gfcpp/SharedPtr.hpp>
+#include <gfcpp/SharedBase.hpp>
+#include <uv.h>
+
+namespace node_gemfire {
+
+// The flag behind a CancelToken. Workers hold on to it and read it from the thread pool.
+class CancelState : public gemfire::SharedBase {
+ public:
+  CancelState() :
+    SharedBase(),
+    cancelled(false) {
+      uv_mutex_init(&mutex);
+    }
+
+  virtual ~CancelState() {
+    uv_mutex_destroy(&mutex);
+  }
+
+  void cancel();
+  bool isCancelled();
+
+ private:
+  uv_mutex_t mutex;
+  bool cancelled;
+};
+
+typedef gemfire::SharedPtr<CancelState> CancelStatePtr;
+
+class CancelToken : public node::ObjectWrap {
+ public:
+  CancelToken() :
+    cancelStatePtr(new CancelState()) {}
+
+  static void Init(v8::Local<v8::Object> exports);
+  static NAN_METHOD(New);
+  static NAN_METHOD(Cancel);
+  static NAN_GETTER(Cancelled);
+
+  static bool HasInstance(const v8::Local<v8::Value> & value);
+
+  CancelStatePtr cancelStatePtr;
+
+ private:
+  static v8::Persistent<v8::FunctionTemplate> constructorTemplate;
+};
+
+}  // namespace node_gemfire
+
+#endif
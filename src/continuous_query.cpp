@@ -0,0 +1,276 @@
+#include "continuous_query.hpp"
+#include <gfcpp/CqAttributesFactory.hpp>
+#include <gfcpp/CqOperation.hpp>
+#include <gfcpp/CqResults.hpp>
+#include <gfcpp/CqStatistics.hpp>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include "conversions.hpp"
+#include "events.hpp"
+#include "exceptions.hpp"
+#include "gemfire_worker.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+Persistent<Function> ContinuousQuery::constructor;
+
+void ContinuousQueryListener::onEvent(const CqEvent & event) {
+  const char * eventName;
+
+  switch (event.getQueryOperation()) {
+    case CqOperation::OP_TYPE_CREATE:
+      eventName = "create";
+      break;
+    case CqOperation::OP_TYPE_UPDATE:
+      eventName = "update";
+      break;
+    // An entry that stops matching the query leaves its results like a destroyed one.
+    case CqOperation::OP_TYPE_DESTROY:
+    case CqOperation::OP_TYPE_INVALIDATE:
+      eventName = "destroy";
+      break;
+    default:
+      return;
+  }
+
+  eventStream->add(eventName, event.getKey(), event.getNewValue());
+}
+
+void ContinuousQueryListener::onError(const CqEvent & event) {
+  eventStream->add("error", event.getKey(), NULLPTR);
+}
+
+class ExecuteCqWorker : public GemfireWorker {
+ public:
+  ExecuteCqWorker(const Local<Object> & cqObject,
+                  const CqQueryPtr & cqQueryPtr,
+                  bool withInitialResults) :
+      GemfireWorker(NULL),
+      cqQueryPtr(cqQueryPtr),
+      withInitialResults(withInitialResults),
+      cqResultsPtr(NULLPTR) {
+        SaveToPersistent("cqObject", cqObject);
+      }
+
+  void ExecuteGemfireWork() {
+    if (withInitialResults) {
+      cqResultsPtr = cqQueryPtr->executeWithInitialResults(
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
+    } else {
+      cqQueryPtr->execute();
+    }
+  }
+
+  void HandleOKCallback() {
+    NanScope();
+
+    Local<Object> cqObject(GetFromPersistent("cqObject"));
+    ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(cqObject);
+
+    // A query closed while it was executing emits nothing more.
+    if (!continuousQuery->isClosed()) {
+      if (withInitialResults) {
+        emitEvent(cqObject, "initialResults", v8Value(SelectResultsPtr(cqResultsPtr)));
+      }
+      emitEvent(cqObject, "ready");
+    }
+
+    continuousQuery->executed();
+  }
+
+  void HandleErrorCallback() {
+    NanScope();
+
+    Local<Object> cqObject(GetFromPersistent("cqObject"));
+    ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(cqObject);
+
+    if (!continuousQuery->isClosed()) {
+      emitError(cqObject, errorObject());
+    }
+
+    // The query never ran, so nothing keeps it alive any more.
+    continuousQuery->executionFailed();
+    continuousQuery->executed();
+  }
+
+  CqQueryPtr cqQueryPtr;
+  bool withInitialResults;
+  CqResultsPtr cqResultsPtr;
+};
+
+void ContinuousQuery::Init(Local<Object> exports) {
+  NanScope();
+
+  Local<FunctionTemplate> constructorTemplate(NanNew<FunctionTemplate>());
+
+  constructorTemplate->SetClassName(NanNew("ContinuousQuery"));
+  constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NanSetPrototypeTemplate(constructorTemplate, "close",
+      NanNew<FunctionTemplate>(ContinuousQuery::Close)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "inspect",
+      NanNew<FunctionTemplate>(ContinuousQuery::Inspect)->GetFunction());
+
+  constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("name"), ContinuousQuery::Name);
+  constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("statistics"),
+      ContinuousQuery::Statistics);
+
+  NanAssignPersistent(ContinuousQuery::constructor, constructorTemplate->GetFunction());
+  exports->Set(NanNew("ContinuousQuery"), constructorTemplate->GetFunction());
+}
+
+Local<Object> ContinuousQuery::New(const QueryServicePtr & queryServicePtr,
+                                   const char * queryString,
+                                   bool withInitialResults,
+                                   const OperationOptions & operationOptions) {
+  NanEscapableScope();
+
+  const unsigned int argc = 0;
+  Local<Value> argv[argc] = {};
+  Local<Object> v8Object(NanNew(ContinuousQuery::constructor)->NewInstance(argc, argv));
+
+  ContinuousQuery * continuousQuery = new ContinuousQuery();
+  continuousQuery->Wrap(v8Object);
+
+  CqAttributesFactory cqAttributesFactory;
+  cqAttributesFactory.addCqListener(CqListenerPtr(
+        new ContinuousQueryListener(continuousQuery->eventStream)));
+  CqAttributesPtr cqAttributesPtr(cqAttributesFactory.create());
+
+  continuousQuery->cqQueryPtr = queryServicePtr->newCq(queryString, cqAttributesPtr);
+
+  // GemFire calls the listener until the query is closed, so the wrapper has to stay alive until
+  // then even if JavaScript lets go of it.
+  continuousQuery->Ref();
+
+  ExecuteCqWorker * worker =
+    new ExecuteCqWorker(v8Object, continuousQuery->cqQueryPtr, withInitialResults);
+  worker->setOperationOptions(operationOptions);
+  NanAsyncQueueWorker(worker);
+
+  return NanEscapeScope(v8Object);
+}
+
+void ContinuousQuery::executed() {
+  executing = false;
+  eventStream->wake();
+}
+
+void ContinuousQuery::executionFailed() {
+  if (closed) {
+    return;
+  }
+
+  try {
+    cqQueryPtr->close();
+  } catch (const gemfire::Exception &) {
+    // The query may not have been registered with the server at all.
+  }
+
+  closed = true;
+  Unref();
+}
+
+NAN_METHOD(ContinuousQuery::Close) {
+  NanScope();
+
+  ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(args.This());
+  if (continuousQuery->closed) {
+    NanReturnValue(args.This());
+  }
+
+  try {
+    continuousQuery->cqQueryPtr->close();
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+
+  continuousQuery->closed = true;
+  continuousQuery->Unref();
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(ContinuousQuery::Inspect) {
+  NanScope();
+
+  ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(args.This());
+
+  std::stringstream inspectStream;
+  inspectStream << "[ContinuousQuery name=\"" << continuousQuery->cqQueryPtr->getName() << "\"]";
+
+  NanReturnValue(NanNew(inspectStream.str().c_str()));
+}
+
+NAN_GETTER(ContinuousQuery::Name) {
+  NanScope();
+
+  ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(args.This());
+
+  NanReturnValue(NanNew(continuousQuery->cqQueryPtr->getName()));
+}
+
+NAN_GETTER(ContinuousQuery::Statistics) {
+  NanScope();
+
+  ContinuousQuery * continuousQuery = ObjectWrap::Unwrap<ContinuousQuery>(args.This());
+  CqStatisticsPtr cqStatisticsPtr(continuousQuery->cqQueryPtr->getStatistics());
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("creates"), NanNew(cqStatisticsPtr->numInserts()));
+  statistics->Set(NanNew("updates"), NanNew(cqStatisticsPtr->numUpdates()));
+  statistics->Set(NanNew("destroys"), NanNew(cqStatisticsPtr->numDeletes()));
+  statistics->Set(NanNew("events"), NanNew(cqStatisticsPtr->numEvents()));
+  statistics->Set(NanNew("eventQueue"), continuousQuery->eventStream->statistics());
+
+  NanReturnValue(statistics);
+}
+
+void ContinuousQuery::emitCallback(uv_async_t * async, int status) {
+  ContinuousQuery * continuousQuery = reinterpret_cast<ContinuousQuery *>(async->data);
+  continuousQuery->publishEvents();
+}
+
+void ContinuousQuery::publishEvents() {
+  NanScope();
+
+  if (executing) {
+    return;
+  }
+
+  std::vector<EventStream::Event *> events;
+  events.reserve(maxEventsPerCallback);
+  eventStream->nextEvents(events, maxEventsPerCallback);
+
+  Local<Object> cqObject(NanObjectWrapHandle(this));
+
+  for (std::vector<EventStream::Event *>::iterator iterator(events.begin());
+       iterator != events.end();
+       ++iterator) {
+    EventStream::Event * event(*iterator);
+    const char * eventName(event->getName());
+
+    // Nothing is emitted once the query is closed; the events are only released.
+    if (!closed) {
+      if (strcmp(eventName, "error") == 0) {
+        emitError(cqObject, v8Error("gemfire::CqException",
+              "The server failed to evaluate the continuous query for a change."));
+      } else {
+        emitEvent(cqObject, eventName, event->v8Object());
+      }
+    }
+
+    eventStream->release(event);
+  }
+
+  if (events.size() == maxEventsPerCallback) {
+    eventStream->wake();
+  }
+}
+
+}  // namespace node_gemfire
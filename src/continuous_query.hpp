@@ -0,0 +1,85 @@
+#ifndef __CONTINUOUS_QUERY_HPP__
+#define __CONTINUOUS_QUERY_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <node.h>
+#include <uv.h>
+#include <gfcpp/QueryService.hpp>
+#include <gfcpp/CqQuery.hpp>
+#include <gfcpp/CqListener.hpp>
+#include <gfcpp/CqEvent.hpp>
+#include "event_stream.hpp"
+#include "operation_options.hpp"
+
+namespace node_gemfire {
+
+// Hands the events of a continuous query from GemFire's threads to the stream of its wrapper. The
+// stream outlives the listener, since the wrapper stays alive until the query is closed.
+class ContinuousQueryListener : public gemfire::CqListener {
+ public:
+  explicit ContinuousQueryListener(EventStream * eventStream) :
+    eventStream(eventStream) {}
+
+  virtual void onEvent(const gemfire::CqEvent & event);
+  virtual void onError(const gemfire::CqEvent & event);
+
+ private:
+  EventStream * eventStream;
+};
+
+// The emitter returned by cache.executeCq(). The server only sends the changes that match the
+// query, and they are queued like entry events until the main thread emits them.
+class ContinuousQuery : public node::ObjectWrap {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+
+  // Creates the query and starts executing it on a worker thread. Throws GemFire exceptions.
+  static v8::Local<v8::Object> New(const gemfire::QueryServicePtr & queryServicePtr,
+                                   const char * queryString,
+                                   bool withInitialResults,
+                                   const OperationOptions & operationOptions);
+
+  static NAN_METHOD(Close);
+  static NAN_METHOD(Inspect);
+  static NAN_GETTER(Name);
+  static NAN_GETTER(Statistics);
+
+  static void emitCallback(uv_async_t * async, int status);
+
+  void executed();
+  void executionFailed();
+
+  bool isClosed() const {
+    return closed;
+  }
+
+ private:
+  ContinuousQuery() :
+    eventStream(new EventStream(this, (uv_async_cb) emitCallback, uv_default_loop())),
+    cqQueryPtr(NULLPTR),
+    executing(true),
+    closed(false) {}
+
+  virtual ~ContinuousQuery() {
+    delete eventStream;
+  }
+
+  void publishEvents();
+
+  static const unsigned int maxEventsPerCallback = 1024;
+
+  EventStream * eventStream;
+  gemfire::CqQueryPtr cqQueryPtr;
+
+  // Events wait in the stream until the query has been executed, so that none of them is emitted
+  // before the initial results.
+  bool executing;
+  bool closed;
+
+  static v8::Persistent<v8::Function> constructor;
+};
+
+}  // namespace node_gemfire
+
+#endif
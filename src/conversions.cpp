@@ -458,4 +458,30 @@ Local<Boolean> v8Value(bool value) {
   return NanEscapeScope(NanNew(value));
 }
 
+bool numberValue(const CacheablePtr & valuePtr, double & value) {
+  if (valuePtr == NULLPTR) {
+    return false;
+  }
+
+  switch (valuePtr->typeId()) {
+    case GemfireTypeIds::CacheableDouble:
+      value = static_cast<CacheableDoublePtr>(valuePtr)->value();
+      return true;
+    case GemfireTypeIds::CacheableFloat:
+      value = static_cast<CacheableFloatPtr>(valuePtr)->value();
+      return true;
+    case GemfireTypeIds::CacheableInt16:
+      value = static_cast<CacheableInt16Ptr>(valuePtr)->value();
+      return true;
+    case GemfireTypeIds::CacheableInt32:
+      value = static_cast<CacheableInt32Ptr>(valuePtr)->value();
+      return true;
+    case GemfireTypeIds::CacheableInt64:
+      value = static_cast<CacheableInt64Ptr>(valuePtr)->value();
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace node_gemfire
@@ -81,6 +81,10 @@ v8::Local<v8::Object> v8Object(const gemfire::SharedPtr<T> & hashMapPtr) {
 
 std::string getClassName(const v8::Local<v8::Object> & v8Object);
 
+// Reads a GemFire number as a double without going through JavaScript. Returns false for nulls and
+// anything that isn't a number.
+bool numberValue(const gemfire::CacheablePtr & valuePtr, double & value);
+
 }  // namespace node_gemfire
 
 #endif
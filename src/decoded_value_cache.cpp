@@ -0,0 +1,144 @@
+#include "decoded_value_cache.hpp"
+#include <nan.h>
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+Local<Value> DecodedValueCache::get(const CacheableKeyPtr & keyPtr, const CacheablePtr & valuePtr) {
+  NanEscapableScope();
+
+  EntryIndex::iterator indexIterator(entryIndex.find(keyPtr));
+  if (indexIterator == entryIndex.end()) {
+    misses++;
+    return NanEscapeScope(Local<Value>());
+  }
+
+  EntryList::iterator listIterator(indexIterator->second);
+  Entry * entry(*listIterator);
+
+  // The region handed back a different value than the one we decoded, so the entry has changed
+  // underneath us and the event that would have invalidated it hasn't been delivered yet.
+  if (entry->valuePtr.ptr() != valuePtr.ptr()) {
+    remove(indexIterator);
+    invalidations++;
+    misses++;
+    return NanEscapeScope(Local<Value>());
+  }
+
+  entryList.splice(entryList.begin(), entryList, listIterator);
+  hits++;
+
+  return NanEscapeScope(NanNew(entry->value));
+}
+
+void DecodedValueCache::set(const CacheableKeyPtr & keyPtr,
+                            const CacheablePtr & valuePtr,
+                            const Local<Value> & value) {
+  unsigned int size = keyPtr->objectSize() + valuePtr->objectSize();
+  if (maxBytes > 0 && size > maxBytes) {
+    return;
+  }
+
+  EntryIndex::iterator indexIterator(entryIndex.find(keyPtr));
+  if (indexIterator != entryIndex.end()) {
+    remove(indexIterator);
+  }
+
+  entryList.push_front(new Entry(keyPtr, valuePtr, value, size));
+  entryIndex[keyPtr] = entryList.begin();
+  bytes += size;
+
+  evict();
+}
+
+void DecodedValueCache::invalidate(const CacheableKeyPtr & keyPtr) {
+  EntryIndex::iterator indexIterator(entryIndex.find(keyPtr));
+  if (indexIterator == entryIndex.end()) {
+    return;
+  }
+
+  remove(indexIterator);
+  invalidations++;
+}
+
+void DecodedValueCache::clear() {
+  for (EntryList::iterator iterator(entryList.begin());
+       iterator != entryList.end();
+       ++iterator) {
+    delete *iterator;
+  }
+
+  entryList.clear();
+  entryIndex.clear();
+  bytes = 0;
+}
+
+unsigned int DecodedValueCache::size() {
+  return entryIndex.size();
+}
+
+void DecodedValueCache::remove(const EntryIndex::iterator & indexIterator) {
+  EntryList::iterator listIterator(indexIterator->second);
+  Entry * entry(*listIterator);
+
+  bytes -= entry->size;
+  entryIndex.erase(indexIterator);
+  entryList.erase(listIterator);
+  delete entry;
+}
+
+void DecodedValueCache::evict() {
+  while (!entryList.empty() &&
+         ((maxEntries > 0 && entryIndex.size() > maxEntries) ||
+          (maxBytes > 0 && bytes > maxBytes))) {
+    remove(entryIndex.find(entryList.back()->keyPtr));
+    evictions++;
+  }
+}
+
+Local<Object> DecodedValueCache::statistics() {
+  NanEscapableScope();
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("entries"), NanNew(size()));
+  statistics->Set(NanNew("bytes"), NanNew(bytes));
+  statistics->Set(NanNew("maxEntries"), NanNew(maxEntries));
+  statistics->Set(NanNew("maxBytes"), NanNew(maxBytes));
+  statistics->Set(NanNew("hits"), NanNew(hits));
+  statistics->Set(NanNew("misses"), NanNew(misses));
+  statistics->Set(NanNew("invalidations"), NanNew(invalidations));
+  statistics->Set(NanNew("evictions"), NanNew(evictions));
+
+  return NanEscapeScope(statistics);
+}
+
+Local<Value> DecodedValueCache::freeze(const Local<Value> & value) {
+  NanEscapableScope();
+
+  if (!value->IsObject()) {
+    return NanEscapeScope(value);
+  }
+
+  Local<Object> object(value->ToObject());
+
+  // Cached values are shared by every caller, so nested objects and arrays must be frozen too.
+  Local<Array> propertyNames(object->GetOwnPropertyNames());
+  unsigned int length = propertyNames->Length();
+  for (unsigned int i = 0; i < length; i++) {
+    freeze(object->Get(propertyNames->Get(i)));
+  }
+
+  Local<Object> global(NanGetCurrentContext()->Global());
+  Local<Function> freezeFunction(
+      global->Get(NanNew("Object"))->ToObject()->Get(NanNew("freeze")).As<Function>());
+
+  static const int argc = 1;
+  Local<Value> argv[argc] = { object };
+  freezeFunction->Call(global, argc, argv);
+
+  return NanEscapeScope(value);
+}
+
+}  // namespace node_gemfire
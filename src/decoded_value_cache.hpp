@@ -0,0 +1,96 @@
+#ifndef __DECODED_VALUE_CACHE_HPP__
+#define __DECODED_VALUE_CACHE_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/Cacheable.hpp>
+#include <tr1/unordered_map>
+#include <list>
+#include "cacheable_key_functors.hpp"
+
+namespace node_gemfire {
+
+// An LRU cache of frozen JavaScript values that have already been converted from GemFire values.
+//
+// Each entry remembers the GemFire value it was decoded from. A cached JavaScript value is only
+// returned when the region hands back that very same value, so an entry that changed locally is
+// never served stale even before its invalidation arrives.
+//
+// Only accessed from the main thread.
+class DecodedValueCache {
+ public:
+  DecodedValueCache(unsigned int maxEntries, unsigned int maxBytes) :
+    maxEntries(maxEntries),
+    maxBytes(maxBytes),
+    bytes(0),
+    hits(0),
+    misses(0),
+    invalidations(0),
+    evictions(0) {}
+
+  ~DecodedValueCache() {
+    clear();
+  }
+
+  v8::Local<v8::Value> get(const gemfire::CacheableKeyPtr & keyPtr,
+                           const gemfire::CacheablePtr & valuePtr);
+  void set(const gemfire::CacheableKeyPtr & keyPtr,
+           const gemfire::CacheablePtr & valuePtr,
+           const v8::Local<v8::Value> & value);
+  void invalidate(const gemfire::CacheableKeyPtr & keyPtr);
+  void clear();
+  unsigned int size();
+
+  v8::Local<v8::Object> statistics();
+
+  static v8::Local<v8::Value> freeze(const v8::Local<v8::Value> & value);
+
+ private:
+  class Entry {
+   public:
+    Entry(const gemfire::CacheableKeyPtr & keyPtr,
+          const gemfire::CacheablePtr & valuePtr,
+          const v8::Local<v8::Value> & value,
+          unsigned int size) :
+      keyPtr(keyPtr),
+      valuePtr(valuePtr),
+      size(size) {
+        NanAssignPersistent(this->value, value);
+      }
+
+    ~Entry() {
+      NanDisposePersistent(value);
+    }
+
+    gemfire::CacheableKeyPtr keyPtr;
+    gemfire::CacheablePtr valuePtr;
+    v8::Persistent<v8::Value> value;
+    unsigned int size;
+  };
+
+  typedef std::list<Entry *> EntryList;
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  EntryList::iterator,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> EntryIndex;
+
+  void remove(const EntryIndex::iterator & indexIterator);
+  void evict();
+
+  unsigned int maxEntries;
+  unsigned int maxBytes;
+  unsigned int bytes;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int invalidations;
+  unsigned int evictions;
+
+  EntryList entryList;
+  EntryIndex entryIndex;
+};
+
+}  // namespace node_gemfire
+
+#endif
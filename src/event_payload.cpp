@@ -0,0 +1,87 @@
+#include "event_payload.hpp"
+#include "conversions.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+Persistent<ObjectTemplate> EventPayload::objectTemplate;
+
+void EventPayload::Init() {
+  NanScope();
+
+  // Payloads are plain objects with their accessors as own enumerable properties, so that they
+  // compare, copy and serialize like the objects that were passed to listeners before.
+  Local<ObjectTemplate> payloadTemplate(NanNew<ObjectTemplate>());
+  payloadTemplate->SetInternalFieldCount(1);
+
+  payloadTemplate->SetAccessor(NanNew("key"), EventPayload::Key, EventPayload::Assign);
+  payloadTemplate->SetAccessor(NanNew("oldValue"), EventPayload::OldValue, EventPayload::Assign);
+  payloadTemplate->SetAccessor(NanNew("newValue"), EventPayload::NewValue, EventPayload::Assign);
+
+  NanAssignPersistent(EventPayload::objectTemplate, payloadTemplate);
+}
+
+Local<Object> EventPayload::NewInstance(const CacheableKeyPtr & keyPtr,
+                                        const CacheablePtr & oldValuePtr,
+                                        const CacheablePtr & newValuePtr) {
+  NanEscapableScope();
+
+  Local<Object> v8Object(NanNew(EventPayload::objectTemplate)->NewInstance());
+
+  EventPayload * eventPayload = new EventPayload(keyPtr, oldValuePtr, newValuePtr);
+  eventPayload->Wrap(v8Object);
+
+  return NanEscapeScope(v8Object);
+}
+
+NAN_GETTER(EventPayload::Key) {
+  NanScope();
+
+  EventPayload * eventPayload = ObjectWrap::Unwrap<EventPayload>(args.Holder());
+
+  Local<Value> key(v8Value(eventPayload->keyPtr));
+  eventPayload->keyPtr = NULLPTR;
+  resolve(args.Holder(), property, key);
+
+  NanReturnValue(key);
+}
+
+NAN_GETTER(EventPayload::OldValue) {
+  NanScope();
+
+  EventPayload * eventPayload = ObjectWrap::Unwrap<EventPayload>(args.Holder());
+
+  Local<Value> oldValue(v8Value(eventPayload->oldValuePtr));
+  eventPayload->oldValuePtr = NULLPTR;
+  resolve(args.Holder(), property, oldValue);
+
+  NanReturnValue(oldValue);
+}
+
+NAN_GETTER(EventPayload::NewValue) {
+  NanScope();
+
+  EventPayload * eventPayload = ObjectWrap::Unwrap<EventPayload>(args.Holder());
+
+  Local<Value> newValue(v8Value(eventPayload->newValuePtr));
+  eventPayload->newValuePtr = NULLPTR;
+  resolve(args.Holder(), property, newValue);
+
+  NanReturnValue(newValue);
+}
+
+NAN_SETTER(EventPayload::Assign) {
+  NanScope();
+
+  resolve(args.Holder(), property, value);
+}
+
+void EventPayload::resolve(const Local<Object> & payload,
+                           const Local<String> & property,
+                           const Local<Value> & value) {
+  payload->ForceSet(property, value);
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,47 @@
+#ifndef __EVENT_PAYLOAD_HPP__
+#define __EVENT_PAYLOAD_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <node.h>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/Cacheable.hpp>
+
+namespace node_gemfire {
+
+// The object passed to listeners of entry events. Its key and values are only converted to
+// JavaScript when a listener first reads them, since most listeners never look at the values. A
+// converted value replaces its accessor, so later reads are plain property lookups.
+class EventPayload : public node::ObjectWrap {
+ public:
+  EventPayload(const gemfire::CacheableKeyPtr & keyPtr,
+               const gemfire::CacheablePtr & oldValuePtr,
+               const gemfire::CacheablePtr & newValuePtr) :
+    keyPtr(keyPtr),
+    oldValuePtr(oldValuePtr),
+    newValuePtr(newValuePtr) {}
+
+  static void Init();
+  static v8::Local<v8::Object> NewInstance(const gemfire::CacheableKeyPtr & keyPtr,
+                                           const gemfire::CacheablePtr & oldValuePtr,
+                                           const gemfire::CacheablePtr & newValuePtr);
+  static NAN_GETTER(Key);
+  static NAN_GETTER(OldValue);
+  static NAN_GETTER(NewValue);
+  static NAN_SETTER(Assign);
+
+ private:
+  static void resolve(const v8::Local<v8::Object> & payload,
+                      const v8::Local<v8::String> & property,
+                      const v8::Local<v8::Value> & value);
+
+  gemfire::CacheableKeyPtr keyPtr;
+  gemfire::CacheablePtr oldValuePtr;
+  gemfire::CacheablePtr newValuePtr;
+
+  static v8::Persistent<v8::ObjectTemplate> objectTemplate;
+};
+
+}  // namespace node_gemfire
+
+#endif
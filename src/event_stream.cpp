@@ -1,62 +1,432 @@
 #include "event_stream.hpp"
 #include <nan.h>
-#include <vector>
-#include <string>
-#include "conversions.hpp"
+#include <climits>
+#include <cstring>
+#include <utility>
+#include "event_payload.hpp"
 
 using namespace v8;
 using namespace gemfire;
 
 namespace node_gemfire {
 
-void EventStream::add(Event * event) {
+EventStream::Event * volatile EventStream::freeEvents = NULL;
+volatile unsigned int EventStream::pooledEvents = 0;
+__thread EventStream::Event * EventStream::localFreeEvents = NULL;
+
+EventStream::EventStream(void * target, uv_async_cb callback, uv_loop_t * loop) :
+  SharedBase(),
+  async(new uv_async_t),
+  head(&stub),
+  tail(&stub),
+  queuedEvents(0),
+  mainThread(pthread_self()),
+  maxEvents(0),
+  policy(DROP_OLDEST),
+  overflowing(false),
+  waitingProducers(0),
+  dropped(0),
+  conflated(0),
+  blocked(0) {
+    async->data = target;
+    uv_async_init(loop, async, callback);
+    uv_unref(reinterpret_cast<uv_handle_t *>(async));
+
+    uv_mutex_init(&mutex);
+    uv_cond_init(&notFull);
+  }
+
+EventStream::~EventStream() {
+  uv_close(reinterpret_cast<uv_handle_t *>(async), deleteAsync);
+
+  std::vector<Event *> events;
+  nextEvents(events, UINT_MAX);
+  for (std::vector<Event *>::iterator iterator(events.begin()); iterator != events.end(); ++iterator) {
+    release(*iterator);
+  }
+
+  uv_cond_destroy(&notFull);
+  uv_mutex_destroy(&mutex);
+}
+
+void EventStream::add(const char * eventName, const EntryEvent & entryEvent, bool withOldValue) {
+  Event * event(acquireEvent());
+  event->set(eventName, entryEvent, withOldValue);
+  enqueue(event);
+}
+
+void EventStream::add(const char * eventName,
+                      const CacheableKeyPtr & keyPtr,
+                      const CacheablePtr & newValuePtr) {
+  Event * event(acquireEvent());
+  event->set(eventName, keyPtr, newValuePtr);
+  enqueue(event);
+}
+
+void EventStream::enqueue(Event * event) {
+  if (full()) {
+    overflow(event);
+  } else {
+    push(event);
+  }
+
+  uv_async_send(async);
+}
+
+bool EventStream::full() {
+  return maxEvents > 0 && (queuedEvents >= maxEvents || overflowing);
+}
+
+// Called without the mutex. The queue may have drained since the caller checked, in which case the
+// event is queued as usual.
+void EventStream::overflow(Event * event) {
   uv_mutex_lock(&mutex);
 
-  eventVector.push_back(event);
-  uv_ref(reinterpret_cast<uv_handle_t *>(&async));
+  if (!full()) {
+    push(event);
+    uv_mutex_unlock(&mutex);
+    return;
+  }
+
+  switch (policy) {
+    case DROP_OLDEST: {
+      // The queue only looks empty to pop() while another producer is between swapping in the head
+      // and linking it; drop the new event then instead.
+      Event * oldestEvent = pop();
+      if (oldestEvent == NULL) {
+        releaseEvent(event);
+      } else {
+        releaseEvent(oldestEvent);
+        push(event);
+      }
+      dropped++;
+      break;
+    }
+
+    case DROP_NEWEST:
+      releaseEvent(event);
+      dropped++;
+      break;
+
+    case BLOCK:
+      // Blocking the main thread would keep it from ever draining the queue.
+      if (!pthread_equal(pthread_self(), mainThread)) {
+        blocked++;
+        waitingProducers++;
+        while (full() && policy == BLOCK) {
+          uv_async_send(async);
+          uv_cond_wait(&notFull, &mutex);
+        }
+        waitingProducers--;
+      }
+      push(event);
+      break;
+
+    case CONFLATE:
+      conflate(event);
+      break;
+  }
+
   uv_mutex_unlock(&mutex);
+}
+
+void EventStream::conflate(Event * event) {
+  overflowing = true;
+
+  std::pair<EventsByKey::iterator, bool> inserted(overflowEventsByKey.insert(event));
+  if (inserted.second) {
+    overflowEvents.push_back(event);
+    return;
+  }
 
-  uv_async_send(&async);
+  (*inserted.first)->conflate(event);
+  releaseEvent(event);
+  conflated++;
 }
 
-std::vector<EventStream::Event *> EventStream::nextEvents() {
+// Everything waiting in the overflow arrived after everything in the queue, so it can be appended
+// at any time without reordering events.
+void EventStream::flushOverflow() {
+  for (std::vector<Event *>::iterator iterator(overflowEvents.begin());
+       iterator != overflowEvents.end();
+       ++iterator) {
+    if ((*iterator)->getName() == NULL) {
+      releaseEvent(*iterator);
+    } else {
+      push(*iterator);
+    }
+  }
+
+  overflowEvents.clear();
+  overflowEventsByKey.clear();
+  overflowing = false;
+}
+
+void EventStream::push(Event * event) {
+  event->next = NULL;
+
+  if (event != &stub) {
+    __sync_fetch_and_add(&queuedEvents, 1);
+  }
+
+  Event * previous = __sync_lock_test_and_set(&head, event);
+
+  // Everything written to the event must be visible before the consumer can reach it.
+  __sync_synchronize();
+  previous->next = event;
+}
+
+void EventStream::nextEvents(std::vector<Event *> & events, unsigned int limit) {
   uv_mutex_lock(&mutex);
 
-  std::vector<Event *> returnValue;
+  while (events.size() < limit) {
+    Event * event = pop();
+    if (event != NULL) {
+      events.push_back(event);
+      continue;
+    }
 
-  for (std::vector<Event *>::iterator iterator(eventVector.begin());
-       iterator != eventVector.end();
-       ++iterator) {
-    Event * event(*iterator);
-    returnValue.push_back(event);
+    if (!overflowing) {
+      break;
+    }
+
+    flushOverflow();
   }
 
-  eventVector.clear();
+  if (waitingProducers > 0 && !full()) {
+    uv_cond_broadcast(&notFull);
+  }
 
-  uv_unref(reinterpret_cast<uv_handle_t *>(&async));
   uv_mutex_unlock(&mutex);
+}
 
-  return returnValue;
+// Called with the mutex held.
+EventStream::Event * EventStream::pop() {
+  Event * event = tail;
+  Event * next = event->next;
+
+  if (event == &stub) {
+    if (next == NULL) {
+      return NULL;
+    }
+
+    tail = next;
+    event = next;
+    next = next->next;
+  }
+
+  if (next != NULL) {
+    __sync_synchronize();
+    tail = next;
+    __sync_fetch_and_sub(&queuedEvents, 1);
+    return event;
+  }
+
+  // The event is the last one unless a producer has swapped in a newer head but not linked it yet.
+  // That producer wakes us once it has, so there is nothing to wait for here.
+  if (event != head) {
+    return NULL;
+  }
+
+  push(&stub);
+
+  next = event->next;
+  if (next != NULL) {
+    __sync_synchronize();
+    tail = next;
+    __sync_fetch_and_sub(&queuedEvents, 1);
+    return event;
+  }
+
+  return NULL;
 }
 
-Local<Object> EventStream::Event::v8Object() {
+// Called with the mutex held.
+EventStream::Event * EventStream::oldestEvent() {
+  Event * event = tail;
+  if (event == &stub) {
+    event = stub.next;
+  }
+
+  if (event == NULL && !overflowEvents.empty()) {
+    event = overflowEvents.front();
+  }
+
+  return event;
+}
+
+void EventStream::setLimit(unsigned int maxEvents, OverflowPolicy policy) {
+  uv_mutex_lock(&mutex);
+
+  this->maxEvents = maxEvents;
+  this->policy = policy;
+
+  if (overflowing && (maxEvents == 0 || policy != CONFLATE)) {
+    flushOverflow();
+  }
+
+  if (waitingProducers > 0) {
+    uv_cond_broadcast(&notFull);
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+const char * EventStream::policyName(OverflowPolicy policy) {
+  switch (policy) {
+    case DROP_OLDEST:
+      return "drop-oldest";
+    case DROP_NEWEST:
+      return "drop-newest";
+    case BLOCK:
+      return "block";
+    case CONFLATE:
+      return "conflate";
+  }
+
+  return NULL;
+}
+
+Local<Object> EventStream::statistics() {
   NanEscapableScope();
 
-  Local<Object> eventPayload(NanNew<Object>());
+  uv_mutex_lock(&mutex);
+
+  Event * event = oldestEvent();
+  double lag = (event == NULL) ? 0 : (uv_hrtime() - event->queuedAt) / 1e6;
+  unsigned int queued = queuedEvents + overflowEvents.size();
+  unsigned int maxEvents = this->maxEvents;
+  OverflowPolicy policy = this->policy;
+  unsigned int dropped = this->dropped;
+  unsigned int conflated = this->conflated;
+  unsigned int blocked = this->blocked;
+
+  uv_mutex_unlock(&mutex);
 
-  eventPayload->Set(NanNew("key"), v8Value(entryEventPtr->getKey()));
-  eventPayload->Set(NanNew("oldValue"), v8Value(entryEventPtr->getOldValue()));
-  eventPayload->Set(NanNew("newValue"), v8Value(entryEventPtr->getNewValue()));
+  Local<Object> statistics(NanNew<Object>());
+  if (maxEvents == 0) {
+    statistics->Set(NanNew("maxEvents"), NanNull());
+    statistics->Set(NanNew("policy"), NanNull());
+  } else {
+    statistics->Set(NanNew("maxEvents"), NanNew(maxEvents));
+    statistics->Set(NanNew("policy"), NanNew(policyName(policy)));
+  }
+  statistics->Set(NanNew("queued"), NanNew(queued));
+  statistics->Set(NanNew("dropped"), NanNew(dropped));
+  statistics->Set(NanNew("conflated"), NanNew(conflated));
+  statistics->Set(NanNew("blocked"), NanNew(blocked));
+  statistics->Set(NanNew("lag"), NanNew(lag));
 
-  return NanEscapeScope(eventPayload);
+  return NanEscapeScope(statistics);
 }
 
-std::string EventStream::Event::getName() {
+void EventStream::release(Event * event) {
+  releaseEvent(event);
+}
+
+void EventStream::wake() {
+  uv_async_send(async);
+}
+
+void EventStream::deleteAsync(uv_handle_t * handle) {
+  delete reinterpret_cast<uv_async_t *>(handle);
+}
+
+EventStream::Event * EventStream::acquireEvent() {
+  if (localFreeEvents == NULL && freeEvents != NULL) {
+    localFreeEvents = __sync_lock_test_and_set(&freeEvents, static_cast<Event *>(NULL));
+
+    unsigned int count = 0;
+    for (Event * event = localFreeEvents; event != NULL; event = event->next) {
+      count++;
+    }
+    __sync_fetch_and_sub(&pooledEvents, count);
+  }
+
+  if (localFreeEvents == NULL) {
+    return new Event();
+  }
+
+  Event * event = localFreeEvents;
+  localFreeEvents = event->next;
+  return event;
+}
+
+void EventStream::releaseEvent(Event * event) {
+  event->clear();
+
+  if (pooledEvents >= maxPooledEvents) {
+    delete event;
+    return;
+  }
+
+  __sync_fetch_and_add(&pooledEvents, 1);
+
+  Event * top;
+  do {
+    top = freeEvents;
+    event->next = top;
+  } while (!__sync_bool_compare_and_swap(&freeEvents, top, event));
+}
+
+void EventStream::Event::set(const char * eventName, const EntryEvent & event, bool withOldValue) {
+  this->eventName = eventName;
+  queuedAt = uv_hrtime();
+  existedBefore = (strcmp(eventName, "create") != 0);
+  regionPtr = event.getRegion();
+  keyPtr = event.getKey();
+  if (withOldValue) {
+    oldValuePtr = event.getOldValue();
+  }
+  newValuePtr = event.getNewValue();
+}
+
+void EventStream::Event::set(const char * eventName,
+                             const CacheableKeyPtr & keyPtr,
+                             const CacheablePtr & newValuePtr) {
+  this->eventName = eventName;
+  queuedAt = uv_hrtime();
+  existedBefore = (strcmp(eventName, "create") != 0);
+  this->keyPtr = keyPtr;
+  this->newValuePtr = newValuePtr;
+}
+
+void EventStream::Event::conflate(const Event * laterEvent) {
+  bool existsAfter = (strcmp(laterEvent->eventName, "destroy") != 0);
+
+  if (existedBefore) {
+    eventName = existsAfter ? "update" : "destroy";
+  } else {
+    eventName = existsAfter ? "create" : NULL;
+  }
+
+  newValuePtr = laterEvent->newValuePtr;
+}
+
+void EventStream::Event::clear() {
+  eventName = NULL;
+  existedBefore = false;
+  queuedAt = 0;
+  regionPtr = NULLPTR;
+  keyPtr = NULLPTR;
+  oldValuePtr = NULLPTR;
+  newValuePtr = NULLPTR;
+}
+
+Local<Object> EventStream::Event::v8Object() {
+  return EventPayload::NewInstance(keyPtr, oldValuePtr, newValuePtr);
+}
+
+const char * EventStream::Event::getName() {
   return eventName;
 }
 
-gemfire::RegionPtr EventStream::Event::getRegion() {
-  return entryEventPtr->getRegion();
+RegionPtr EventStream::Event::getRegion() {
+  return regionPtr;
+}
+
+CacheableKeyPtr EventStream::Event::getKey() {
+  return keyPtr;
 }
 
 }  // namespace node_gemfire
@@ -7,64 +7,161 @@
 #include <gfcpp/EntryEvent.hpp>
 #include <uv.h>
 #include <v8.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <cstddef>
+#include <tr1/unordered_set>
 #include <vector>
-#include <cassert>
-#include <string>
 
 namespace node_gemfire {
 
+// Carries entry events from GemFire's listener threads to the main thread.
+//
+// Listener threads push onto an intrusive lock-free multi-producer single-consumer queue, so an
+// event storm costs each of them one atomic exchange instead of a contended mutex. The main thread
+// takes events in batches and hands them back to a shared pool once it has emitted them, which
+// saves an allocation per event in steady state.
+//
+// The queue is unbounded unless setLimit() is called. Once it holds the maximum number of events,
+// listener threads take the mutex to apply the overflow policy. The main thread takes it once per
+// batch, so that a listener thread dropping the oldest event never races it for the tail.
 class EventStream: public gemfire::SharedBase {
  public:
-  explicit EventStream(
-      void * target,
-      uv_async_cb callback) :
-    SharedBase() {
-      uv_mutex_init(&mutex);
-      async.data = target;
-      uv_mutex_lock(&mutex);
-      uv_async_init(uv_default_loop(), &async, callback);
-      uv_unref(reinterpret_cast<uv_handle_t *>(&async));
-      uv_mutex_unlock(&mutex);
-    }
+  enum OverflowPolicy { DROP_OLDEST, DROP_NEWEST, BLOCK, CONFLATE };
 
-  virtual ~EventStream() {
-    uv_close(reinterpret_cast<uv_handle_t *>(&async), NULL);
-    uv_mutex_destroy(&mutex);
-  }
+  EventStream(void * target, uv_async_cb callback, uv_loop_t * loop);
+  virtual ~EventStream();
 
   class Event {
    public:
-    Event(const std::string & eventName,
-               const gemfire::EntryEvent & event) :
-      eventName(eventName),
-      entryEventPtr(new gemfire::EntryEvent(event.getRegion(),
-                                            event.getKey(),
-                                            event.getOldValue(),
-                                            event.getNewValue(),
-                                            event.getCallbackArgument(),
-                                            event.remoteOrigin())) {}
+    Event() :
+      next(NULL),
+      eventName(NULL),
+      existedBefore(false),
+      queuedAt(0) {}
 
     v8::Local<v8::Object> v8Object();
-    std::string getName();
+    const char * getName();
     gemfire::RegionPtr getRegion();
+    gemfire::CacheableKeyPtr getKey();
+
+    // Folds a later event for the same key into this one. The result goes from the state before
+    // this event to the state after the later one: a create followed by an update is a create, an
+    // update followed by a destroy is a destroy, and a create followed by a destroy is nothing at
+    // all, in which case getName() returns NULL.
+    void conflate(const Event * laterEvent);
 
    private:
-    std::string eventName;
-    gemfire::EntryEventPtr entryEventPtr;
+    friend class EventStream;
+
+    void set(const char * eventName, const gemfire::EntryEvent & event, bool withOldValue);
+    void set(const char * eventName,
+             const gemfire::CacheableKeyPtr & keyPtr,
+             const gemfire::CacheablePtr & newValuePtr);
+    void clear();
+
+    Event * volatile next;
+
+    const char * eventName;
+    bool existedBefore;
+    uint64_t queuedAt;
+    gemfire::RegionPtr regionPtr;
+    gemfire::CacheableKeyPtr keyPtr;
+    gemfire::CacheablePtr oldValuePtr;
+    gemfire::CacheablePtr newValuePtr;
   };
 
-  void add(Event * event);
-  std::vector<Event *> nextEvents();
+  // Called from any thread. The event name must be a string literal. Without the old value, the
+  // event doesn't keep it alive while it waits and delivers it as null.
+  void add(const char * eventName, const gemfire::EntryEvent & event, bool withOldValue);
+
+  // For events that don't belong to a region, such as those of continuous queries. They carry no
+  // old value.
+  void add(const char * eventName,
+           const gemfire::CacheableKeyPtr & keyPtr,
+           const gemfire::CacheablePtr & newValuePtr);
+
+  // Called from the main thread. Appends at most `limit` waiting events, oldest first; every one of
+  // them must be passed to release().
+  void nextEvents(std::vector<Event *> & events, unsigned int limit);
+  void release(Event * event);
+
+  // Schedules another callback, for a consumer that stopped before the queue was empty.
+  void wake();
+
+  // Called from the main thread. A limit of zero makes the queue unbounded again.
+  void setLimit(unsigned int maxEvents, OverflowPolicy policy);
+  static const char * policyName(OverflowPolicy policy);
+
+  v8::Local<v8::Object> statistics();
 
  private:
-  static void teardownCallback(uv_work_t * request);
-  static void afterTeardownCallback(uv_work_t * request, int status);
-  void teardown();
+  class EventKeyHash {
+   public:
+    size_t operator()(const Event * event) const {
+      return event->keyPtr->hashcode() ^ reinterpret_cast<size_t>(event->regionPtr.ptr());
+    }
+  };
 
+  class EventKeyEqual {
+   public:
+    bool operator()(const Event * a, const Event * b) const {
+      return a->regionPtr.ptr() == b->regionPtr.ptr() && *a->keyPtr == *b->keyPtr;
+    }
+  };
+
+  typedef std::tr1::unordered_set<Event *, EventKeyHash, EventKeyEqual> EventsByKey;
+
+  bool full();
+  void overflow(Event * event);
+  void conflate(Event * event);
+  void flushOverflow();
+  void push(Event * event);
+  Event * pop();
+  Event * oldestEvent();
+
+  void enqueue(Event * event);
+
+  static Event * acquireEvent();
+  static void releaseEvent(Event * event);
+  static void deleteAsync(uv_handle_t * handle);
+
+  // Allocated separately so that it can outlive the stream until its close callback has run.
+  uv_async_t * async;
+
+  // Producers swap themselves in at the head; the consumer follows the next pointers from the tail.
+  // The stub keeps the queue non-empty so that producers never touch the tail.
+  Event * volatile head;
+  Event * tail;
+  Event stub;
+  volatile unsigned int queuedEvents;
+
+  // Guards the tail and everything below.
   uv_mutex_t mutex;
-  uv_async_t async;
+  uv_cond_t notFull;
+  pthread_t mainThread;
+
+  volatile unsigned int maxEvents;
+  OverflowPolicy policy;
+
+  // With the conflate policy, events that arrive while the queue is full wait here instead, at
+  // most one per key, until the consumer has emptied the queue. Later events keep going here until
+  // then so that they stay in order.
+  std::vector<Event *> overflowEvents;
+  EventsByKey overflowEventsByKey;
+  volatile bool overflowing;
+
+  unsigned int waitingProducers;
+  unsigned int dropped;
+  unsigned int conflated;
+  unsigned int blocked;
 
-  std::vector<Event *> eventVector;
+  // Released events, shared by every stream. Any thread pushes onto the stack; a listener thread
+  // takes the whole stack at once into a thread-local list, which rules out ABA.
+  static Event * volatile freeEvents;
+  static volatile unsigned int pooledEvents;
+  static __thread Event * localFreeEvents;
+  static const unsigned int maxPooledEvents = 4096;
 };
 
 }  // namespace node_gemfire
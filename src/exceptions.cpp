@@ -24,6 +24,15 @@ Local<Value> v8Error(const UserFunctionExecutionExceptionPtr & exceptionPtr) {
   return NanEscapeScope(error);
 }
 
+Local<Value> v8Error(const char * name, const char * message) {
+  NanEscapableScope();
+
+  Local<Object> error(NanError(message)->ToObject());
+  error->Set(NanNew("name"), NanNew(name));
+
+  return NanEscapeScope(error);
+}
+
 void ThrowGemfireException(const gemfire::Exception & e) {
   NanThrowError(v8Error(e));
 }
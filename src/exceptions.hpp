@@ -8,6 +8,7 @@ namespace node_gemfire {
 
 v8::Local<v8::Value> v8Error(const gemfire::Exception & exception);
 v8::Local<v8::Value> v8Error(const gemfire::UserFunctionExecutionExceptionPtr & exceptionPtr);
+v8::Local<v8::Value> v8Error(const char * name, const char * message);
 
 void ThrowGemfireException(const gemfire::Exception & e);
 
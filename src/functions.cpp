@@ -4,11 +4,13 @@
 #include <v8.h>
 #include <string>
 #include <iostream>
+#include <vector>
 #include "conversions.hpp"
 #include "dependencies.hpp"
 #include "exceptions.hpp"
 #include "events.hpp"
 #include "streaming_result_collector.hpp"
+#include "operation_options.hpp"
 
 using namespace v8;
 using namespace gemfire;
@@ -22,24 +24,142 @@ class ExecuteFunctionWorker {
       const std::string & functionName,
       const CacheablePtr & functionArguments,
       const CacheableVectorPtr & functionFilter,
+      const OperationOptions & operationOptions,
+      bool batchResults,
+      size_t highWaterMark,
       const Local<Object> & emitterHandle) :
-    resultStream(
-        new ResultStream(this,
-                        (uv_async_cb) DataAsyncCallback,
-                        (uv_async_cb) EndAsyncCallback)),
+    resultStream(new ResultStream(this, (uv_async_cb) DataAsyncCallback, uv_default_loop(),
+                                  highWaterMark)),
     executionPtr(executionPtr),
     functionName(functionName),
     functionArguments(functionArguments),
     functionFilter(functionFilter),
+    operationOptions(operationOptions),
+    batchResults(batchResults),
+    position(0),
+    resultsEnded(false),
     ended(false),
-    executeCompleted(false) {
+    executeCompleted(false),
+    cancelled(false),
+    paused(false),
+    pauseTimer(new uv_timer_t),
+    pauseTimerActive(false) {
       NanAssignPersistent(emitter, emitterHandle);
       request.data = reinterpret_cast<void *>(this);
+
+      uv_timer_init(uv_default_loop(), pauseTimer);
+      pauseTimer->data = this;
     }
 
   ~ExecuteFunctionWorker() {
+    NanScope();
+
+    // The emitter may outlive the worker, and its flow control methods become no-ops.
+    NanNew(emitter)->DeleteHiddenValue(NanNew(workerKey));
+
     NanDisposePersistent(emitter);
     delete resultStream;
+
+    uv_close(reinterpret_cast<uv_handle_t *>(pauseTimer), deleteTimer);
+  }
+
+  // Exposes pause(), resume() and destroy() on the emitter, for consumers that read at their own
+  // pace.
+  void enableFlowControl(const Local<Object> & eventEmitter) {
+    NanScope();
+
+    eventEmitter->SetHiddenValue(NanNew(workerKey), NanNew<External>(this));
+    eventEmitter->Set(NanNew("pause"), NanNew<FunctionTemplate>(Pause)->GetFunction());
+    eventEmitter->Set(NanNew("resume"), NanNew<FunctionTemplate>(Resume)->GetFunction());
+    eventEmitter->Set(NanNew("destroy"), NanNew<FunctionTemplate>(Destroy)->GetFunction());
+  }
+
+  static NAN_METHOD(Pause) {
+    NanScope();
+
+    ExecuteFunctionWorker * worker = unwrap(args.This());
+    if (worker && !worker->cancelled) {
+      worker->paused = true;
+      worker->watchWhilePaused();
+    }
+
+    NanReturnValue(args.This());
+  }
+
+  static NAN_METHOD(Resume) {
+    NanScope();
+
+    ExecuteFunctionWorker * worker = unwrap(args.This());
+    if (worker && worker->paused) {
+      worker->paused = false;
+      worker->stopWatching();
+      worker->resultStream->wake();
+    }
+
+    NanReturnValue(args.This());
+  }
+
+  // Drops the remaining results without emitting "end". The server can't be told to stop, but the
+  // collector no longer waits for the consumer.
+  static NAN_METHOD(Destroy) {
+    NanScope();
+
+    ExecuteFunctionWorker * worker = unwrap(args.This());
+    if (worker && !worker->cancelled) {
+      worker->cancelled = true;
+      worker->paused = false;
+      worker->stopWatching();
+      worker->resultStream->close();
+      worker->resultStream->wake();
+    }
+
+    NanReturnUndefined();
+  }
+
+  // Nothing runs on the main thread while the emitter is paused, and the collector may be waiting
+  // for room on a pool thread, so the cancel token and deadline are polled instead.
+  void watchWhilePaused() {
+    if (operationOptions.empty() || pauseTimerActive) {
+      return;
+    }
+
+    uv_timer_start(pauseTimer, PauseTimerCallback, pausePollInterval, pausePollInterval);
+    pauseTimerActive = true;
+  }
+
+  void stopWatching() {
+    if (pauseTimerActive) {
+      uv_timer_stop(pauseTimer);
+      pauseTimerActive = false;
+    }
+  }
+
+  static void PauseTimerCallback(uv_timer_t * timer, int status) {
+    ExecuteFunctionWorker * worker = reinterpret_cast<ExecuteFunctionWorker *>(timer->data);
+
+    if (worker->operationOptions.cancelled()) {
+      worker->abandon("CancelledError", "The operation was cancelled.");
+    } else if (worker->operationOptions.expired()) {
+      worker->abandon("DeadlineExceededError", "The operation timed out.");
+    }
+  }
+
+  static void deleteTimer(uv_handle_t * handle) {
+    delete reinterpret_cast<uv_timer_t *>(handle);
+  }
+
+  // Drops the remaining results, releasing a collector that waits for room, and reports why. The
+  // emitter then ends without "end" once the function has returned.
+  void abandon(const char * errorName, const char * errorMessage) {
+    NanScope();
+
+    cancelled = true;
+    paused = false;
+    stopWatching();
+    resultStream->close();
+    resultStream->wake();
+
+    emitError(NanNew(emitter), v8Error(errorName, errorMessage));
   }
 
   static void Execute(uv_work_t * request) {
@@ -57,12 +177,19 @@ class ExecuteFunctionWorker {
     worker->Data();
   }
 
-  static void EndAsyncCallback(uv_async_t * async, int status) {
-    ExecuteFunctionWorker * worker = reinterpret_cast<ExecuteFunctionWorker *>(async->data);
-    worker->End();
-  }
-
   void Execute() {
+    if (operationOptions.cancelled()) {
+      errorName = "CancelledError";
+      errorMessage = "The operation was cancelled.";
+      return;
+    }
+
+    if (operationOptions.expired()) {
+      errorName = "DeadlineExceededError";
+      errorMessage = "The operation timed out before it started.";
+      return;
+    }
+
     try {
       if (functionArguments != NULLPTR) {
         executionPtr = executionPtr->withArgs(functionArguments);
@@ -76,7 +203,8 @@ class ExecuteFunctionWorker {
         (new StreamingResultCollector(resultStream));
       executionPtr = executionPtr->withCollector(resultCollectorPtr);
 
-      executionPtr->execute(functionName.c_str());
+      executionPtr->execute(functionName.c_str(),
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
     } catch (const gemfire::Exception & exception) {
       exceptionPtr = exception.clone();
     }
@@ -87,6 +215,10 @@ class ExecuteFunctionWorker {
       NanScope();
       emitError(NanNew(emitter), v8Error(*exceptionPtr));
       ended = true;
+    } else if (!errorName.empty()) {
+      NanScope();
+      emitError(NanNew(emitter), v8Error(errorName.c_str(), errorMessage.c_str()));
+      ended = true;
     }
 
     executeCompleted = true;
@@ -98,26 +230,80 @@ class ExecuteFunctionWorker {
 
     Local<Object> eventEmitter(NanNew(emitter));
 
-    CacheableVectorPtr resultsPtr(resultStream->nextResults());
-    for (CacheableVector::Iterator iterator(resultsPtr->begin());
-         iterator != resultsPtr->end();
-         ++iterator) {
-      Local<Value> result(v8Value(*iterator));
+    // The server can't be told to stop, so results that arrive after cancellation are dropped.
+    if (!cancelled && operationOptions.cancelled()) {
+      abandon("CancelledError", "The operation was cancelled.");
+    }
+
+    // At most maxResultsPerCallback results are emitted per callback, so that a function with many
+    // results can't starve the rest of the event loop. The waiting results are taken as soon as
+    // these run out: the collector only wakes the main thread when it adds to an empty buffer, and
+    // that wakeup may already have been spent on an earlier callback.
+    Local<Array> batch(NanNew<Array>());
+    size_t count = 0;
+
+    while (!paused && count < maxResultsPerCallback) {
+      // A listener may have destroyed the emitter during the previous result.
+      if (cancelled) {
+        position = results.size();
+      }
+
+      if (position == results.size()) {
+        if (resultsEnded) {
+          break;
+        }
+
+        results.clear();
+        position = 0;
+        resultsEnded = resultStream->nextResults(results);
+
+        if (results.empty()) {
+          break;
+        }
+      }
+
+      Local<Value> result(v8Value(results[position]));
+      position++;
+      count++;
 
       if (result->IsNativeError()) {
+        // Results the function sent before the error are emitted before it.
+        if (batch->Length() > 0) {
+          emitEvent(eventEmitter, "data", batch);
+          batch = NanNew<Array>();
+        }
+
         emitError(eventEmitter, result);
+      } else if (batchResults) {
+        batch->Set(batch->Length(), result);
       } else {
         emitEvent(eventEmitter, "data", result);
       }
     }
 
-    resultStream->resultsProcessed();
+    if (batch->Length() > 0) {
+      emitEvent(eventEmitter, "data", batch);
+    }
+
+    // A paused emitter is woken again by resume(), or by abandon() once it is cancelled or its
+    // deadline passes. Otherwise the collector wakes it when it adds results to an empty buffer.
+    if (paused) {
+      return;
+    }
+
+    if (count == maxResultsPerCallback) {
+      resultStream->wake();
+    } else if (resultsEnded && position == results.size() && !ended) {
+      End();
+    }
   }
 
   void End() {
     NanScope();
 
-    emitEvent(NanNew(emitter), "end");
+    if (!cancelled) {
+      emitEvent(NanNew(emitter), "end");
+    }
 
     ended = true;
     teardownIfReady();
@@ -132,19 +318,49 @@ class ExecuteFunctionWorker {
   uv_work_t request;
 
  private:
+  static const size_t maxResultsPerCallback = 1024;
+  static const uint64_t pausePollInterval = 100;
+  static const char * workerKey;
+
+  static ExecuteFunctionWorker * unwrap(const Local<Object> & eventEmitter) {
+    Local<Value> worker(eventEmitter->GetHiddenValue(NanNew(workerKey)));
+    if (worker.IsEmpty() || !worker->IsExternal()) {
+      return NULL;
+    }
+
+    return static_cast<ExecuteFunctionWorker *>(worker.As<External>()->Value());
+  }
+
   ResultStream * resultStream;
 
   ExecutionPtr executionPtr;
   std::string functionName;
   CacheablePtr functionArguments;
   CacheableVectorPtr functionFilter;
+  OperationOptions operationOptions;
+  bool batchResults;
   Persistent<Object> emitter;
   gemfire::ExceptionPtr exceptionPtr;
+  std::string errorName;
+  std::string errorMessage;
+
+  // Taken from the stream, and emitted up to `position`.
+  std::vector<CacheablePtr> results;
+  size_t position;
+  bool resultsEnded;
 
   bool ended;
   bool executeCompleted;
+  bool cancelled;
+  bool paused;
+
+  // Allocated separately so that it can outlive the worker until its close callback has run.
+  uv_timer_t * pauseTimer;
+  bool pauseTimerActive;
 };
 
+const char * ExecuteFunctionWorker::workerKey = "node_gemfire::ExecuteFunctionWorker";
+
 Local<Value> executeFunction(_NAN_METHOD_ARGS,
                              const CachePtr & cachePtr,
                              const ExecutionPtr & executionPtr) {
@@ -159,6 +375,9 @@ Local<Value> executeFunction(_NAN_METHOD_ARGS,
   Local<Value> v8FunctionFilter;
   Local<Value> v8SynchronousFlag;
   bool synchronousFlag = false;
+  bool batchFlag = false;
+  size_t highWaterMark = 0;
+  OperationOptions operationOptions;
 
   if (args[1]->IsArray()) {
     v8FunctionArguments = args[1];
@@ -179,6 +398,28 @@ Local<Value> executeFunction(_NAN_METHOD_ARGS,
     } else if (!v8SynchronousFlag->IsUndefined()) {
       synchronousFlag = v8SynchronousFlag->ToBoolean()->Value();
     }
+
+    Local<Value> v8BatchFlag(optionsObject->Get(NanNew("batch")));
+    if (!v8BatchFlag->IsBoolean() && !v8BatchFlag->IsUndefined()) {
+      NanThrowError("You must pass true or false for the batch option for executeFunction().");
+      return NanEscapeScope(NanUndefined());
+    } else if (!v8BatchFlag->IsUndefined()) {
+      batchFlag = v8BatchFlag->ToBoolean()->Value();
+    }
+
+    Local<Value> v8HighWaterMark(optionsObject->Get(NanNew("highWaterMark")));
+    if (!v8HighWaterMark->IsUndefined()) {
+      if (!v8HighWaterMark->IsUint32() || v8HighWaterMark->Uint32Value() == 0) {
+        NanThrowError("executeFunction: highWaterMark must be a positive integer.");
+        return NanEscapeScope(NanUndefined());
+      }
+
+      highWaterMark = v8HighWaterMark->Uint32Value();
+    }
+
+    if (!operationOptions.parse(optionsObject, "executeFunction()")) {
+      return NanEscapeScope(NanUndefined());
+    }
   } else if (!args[1]->IsUndefined()) {
     NanThrowError("You must pass either an Array of arguments or an options Object to executeFunction().");
     return NanEscapeScope(NanUndefined());
@@ -215,7 +456,8 @@ Local<Value> executeFunction(_NAN_METHOD_ARGS,
       }
 
       ResultCollectorPtr resultCollectorPtr;
-      resultCollectorPtr = synchronousExecutionPtr->execute(functionName.c_str());
+      resultCollectorPtr = synchronousExecutionPtr->execute(functionName.c_str(),
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
 
       CacheableVectorPtr resultsPtr(resultCollectorPtr->getResult());
       for (CacheableVector::Iterator iterator(resultsPtr->begin());
@@ -236,7 +478,12 @@ Local<Value> executeFunction(_NAN_METHOD_ARGS,
     Local<Object> eventEmitter(eventEmitterConstructor->NewInstance());
 
     ExecuteFunctionWorker * worker =
-      new ExecuteFunctionWorker(executionPtr, functionName, functionArguments, functionFilter, eventEmitter);
+      new ExecuteFunctionWorker(executionPtr, functionName, functionArguments, functionFilter,
+                                operationOptions, batchFlag, highWaterMark, eventEmitter);
+
+    if (highWaterMark > 0) {
+      worker->enableFlowControl(eventEmitter);
+    }
 
     uv_queue_work(
         uv_default_loop(),
@@ -7,6 +7,16 @@ using namespace v8;
 namespace node_gemfire {
 
 void GemfireWorker::Execute() {
+  if (operationOptions.cancelled()) {
+    SetError("CancelledError", "The operation was cancelled.");
+    return;
+  }
+
+  if (operationOptions.expired()) {
+    SetError("DeadlineExceededError", "The operation timed out before it started.");
+    return;
+  }
+
   try {
     ExecuteGemfireWork();
   } catch(gemfire::Exception & exception) {
@@ -14,6 +24,10 @@ void GemfireWorker::Execute() {
   }
 }
 
+void GemfireWorker::setOperationOptions(const OperationOptions & operationOptions) {
+  this->operationOptions = operationOptions;
+}
+
 void GemfireWorker::HandleErrorCallback() {
   NanScope();
 
@@ -33,6 +47,28 @@ void GemfireWorker::WorkComplete() {
 
   delete callback;
   callback = NULL;
+
+  releaseLimits();
+}
+
+void GemfireWorker::admittedBy(const WorkLimiterPtr & limiterPtr) {
+  limiterPtrs.push_back(limiterPtr);
+}
+
+void GemfireWorker::releaseLimits() {
+  std::vector<WorkLimiterPtr> admittedLimiterPtrs;
+  admittedLimiterPtrs.swap(limiterPtrs);
+
+  for (std::vector<WorkLimiterPtr>::iterator iterator(admittedLimiterPtrs.begin());
+       iterator != admittedLimiterPtrs.end();
+       ++iterator) {
+    (*iterator)->release();
+  }
+}
+
+void GemfireWorker::reject(const char * name, const char * message) {
+  SetError(name, message);
+  GemfireWorker::WorkComplete();
 }
 
 void GemfireWorker::SetError(const char * name, const char * message) {
@@ -46,9 +82,7 @@ Local<Value> GemfireWorker::errorObject() {
   if (exceptionPtr != NULLPTR) {
     return NanEscapeScope(v8Error(*exceptionPtr));
   } else {
-    Local<Object> error(NanError(ErrorMessage())->ToObject());
-    error->Set(NanNew("name"), NanNew(errorName));
-    return NanEscapeScope(error);
+    return NanEscapeScope(v8Error(errorName.c_str(), ErrorMessage()));
   }
 }
 
@@ -4,6 +4,9 @@
 #include <nan.h>
 #include <gfcpp/GemfireCppCache.hpp>
 #include <string>
+#include <vector>
+#include "operation_options.hpp"
+#include "work_limiter.hpp"
 
 namespace node_gemfire {
 
@@ -21,11 +24,23 @@ class GemfireWorker : public NanAsyncWorker {
   virtual void WorkComplete();
   virtual void Execute();
 
+  void setOperationOptions(const OperationOptions & operationOptions);
+
+  void admittedBy(const WorkLimiterPtr & limiterPtr);
+  void releaseLimits();
+
+  // Completes the worker with an error without ever running it.
+  void reject(const char * name, const char * message);
+
  protected:
   v8::Local<v8::Value> errorObject();
 
   gemfire::ExceptionPtr exceptionPtr;
   std::string errorName;
+  OperationOptions operationOptions;
+
+ private:
+  std::vector<WorkLimiterPtr> limiterPtrs;
 };
 
 }  // namespace node_gemfire
@@ -0,0 +1,143 @@
+#include "key_watchers.hpp"
+#include <algorithm>
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+void KeyWatchers::watch(const VectorOfCacheableKeyPtr & keysPtr, const Local<Function> & listener) {
+  NanScope();
+
+  int found = find(listener);
+  unsigned int id = (found < 0) ? add(listener) : found;
+
+  for (VectorOfCacheableKey::Iterator iterator(keysPtr->begin());
+       iterator != keysPtr->end();
+       ++iterator) {
+    ListenerIds & ids(listenersByKey[*iterator]);
+    if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+      ids.push_back(id);
+      watchedKeyCounts[id]++;
+    }
+  }
+
+  if (watchedKeyCounts[id] == 0) {
+    release(id);
+  }
+}
+
+void KeyWatchers::unwatch(const VectorOfCacheableKeyPtr & keysPtr, const Local<Function> & listener) {
+  NanScope();
+
+  int found = find(listener);
+  if (found < 0) {
+    return;
+  }
+
+  unsigned int id = found;
+
+  for (VectorOfCacheableKey::Iterator iterator(keysPtr->begin());
+       iterator != keysPtr->end();
+       ++iterator) {
+    ListenersByKey::iterator watchers(listenersByKey.find(*iterator));
+    if (watchers == listenersByKey.end()) {
+      continue;
+    }
+
+    ListenerIds & ids(watchers->second);
+    ListenerIds::iterator position(std::find(ids.begin(), ids.end(), id));
+    if (position == ids.end()) {
+      continue;
+    }
+
+    ids.erase(position);
+    watchedKeyCounts[id]--;
+
+    if (ids.empty()) {
+      listenersByKey.erase(watchers);
+    }
+  }
+
+  if (watchedKeyCounts[id] == 0) {
+    release(id);
+  }
+}
+
+bool KeyWatchers::watching(const CacheableKeyPtr & keyPtr) {
+  return listenersByKey.find(keyPtr) != listenersByKey.end();
+}
+
+bool KeyWatchers::empty() {
+  return listenersByKey.empty();
+}
+
+void KeyWatchers::emit(const Local<Object> & emitter,
+                       const CacheableKeyPtr & keyPtr,
+                       const Local<Object> & eventPayload) {
+  NanScope();
+
+  ListenersByKey::iterator watchers(listenersByKey.find(keyPtr));
+  if (watchers == listenersByKey.end()) {
+    return;
+  }
+
+  // Listeners may unwatch the key, or watch others, while they are called.
+  ListenerIds ids(watchers->second);
+  Local<Array> listenersArray(NanNew(listeners));
+
+  static const int argc = 1;
+  Local<Value> argv[argc] = { eventPayload };
+
+  for (ListenerIds::iterator iterator(ids.begin()); iterator != ids.end(); ++iterator) {
+    Local<Value> listener(listenersArray->Get(*iterator));
+    if (listener->IsFunction()) {
+      NanMakeCallback(emitter, listener.As<Function>(), argc, argv);
+    }
+  }
+}
+
+Local<Object> KeyWatchers::statistics() {
+  NanEscapableScope();
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("keys"), NanNew(static_cast<unsigned int>(listenersByKey.size())));
+  statistics->Set(NanNew("listeners"),
+      NanNew(static_cast<unsigned int>(watchedKeyCounts.size() - freeIds.size())));
+
+  return NanEscapeScope(statistics);
+}
+
+int KeyWatchers::find(const Local<Function> & listener) {
+  Local<Array> listenersArray(NanNew(listeners));
+
+  unsigned int length = listenersArray->Length();
+  for (unsigned int i = 0; i < length; i++) {
+    if (listenersArray->Get(i)->StrictEquals(listener)) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+unsigned int KeyWatchers::add(const Local<Function> & listener) {
+  unsigned int id;
+  if (freeIds.empty()) {
+    id = watchedKeyCounts.size();
+    watchedKeyCounts.push_back(0);
+  } else {
+    id = freeIds.back();
+    freeIds.pop_back();
+  }
+
+  NanNew(listeners)->Set(id, listener);
+  return id;
+}
+
+void KeyWatchers::release(unsigned int id) {
+  NanNew(listeners)->Set(id, NanUndefined());
+  freeIds.push_back(id);
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,65 @@
+#ifndef __KEY_WATCHERS_HPP__
+#define __KEY_WATCHERS_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/CacheableBuiltins.hpp>
+#include <tr1/unordered_map>
+#include <vector>
+#include "cacheable_key_functors.hpp"
+
+namespace node_gemfire {
+
+// The listeners passed to region.watch(), indexed by the keys they watch. Events are looked up by
+// key before anything is converted, so an event for a key that nobody watches costs one hash
+// lookup.
+//
+// Listeners live in a JavaScript array and are referred to by their index in it. A listener keeps
+// its index for as long as it watches some key.
+//
+// Only accessed from the main thread.
+class KeyWatchers {
+ public:
+  KeyWatchers() {
+    NanAssignPersistent(listeners, NanNew<v8::Array>());
+  }
+
+  ~KeyWatchers() {
+    NanDisposePersistent(listeners);
+  }
+
+  void watch(const gemfire::VectorOfCacheableKeyPtr & keysPtr, const v8::Local<v8::Function> & listener);
+  void unwatch(const gemfire::VectorOfCacheableKeyPtr & keysPtr, const v8::Local<v8::Function> & listener);
+
+  bool watching(const gemfire::CacheableKeyPtr & keyPtr);
+  bool empty();
+
+  // Calls every listener of the key with the payload, in the order they started watching it.
+  void emit(const v8::Local<v8::Object> & emitter,
+            const gemfire::CacheableKeyPtr & keyPtr,
+            const v8::Local<v8::Object> & eventPayload);
+
+  v8::Local<v8::Object> statistics();
+
+ private:
+  typedef std::vector<unsigned int> ListenerIds;
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  ListenerIds,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> ListenersByKey;
+
+  // Returns the index of the listener, or -1 if it doesn't watch anything.
+  int find(const v8::Local<v8::Function> & listener);
+  unsigned int add(const v8::Local<v8::Function> & listener);
+  void release(unsigned int id);
+
+  ListenersByKey listenersByKey;
+  v8::Persistent<v8::Array> listeners;
+  std::vector<unsigned int> watchedKeyCounts;
+  std::vector<unsigned int> freeIds;
+};
+
+}  // namespace node_gemfire
+
+#endif
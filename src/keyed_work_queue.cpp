@@ -0,0 +1,100 @@
+#include "keyed_work_queue.hpp"
+
+using namespace gemfire;
+
+namespace node_gemfire {
+
+KeyedWorkQueue KeyedWorkQueue::instance;
+
+KeyedWorkQueue * KeyedWorkQueue::getInstance() {
+  return &instance;
+}
+
+void KeyedWorkQueue::queue(const RegionPtr & regionPtr,
+                           const CacheableKeyPtr & keyPtr,
+                           NanAsyncWorker * worker) {
+  if (keyPtr == NULLPTR || add(regionPtr.ptr(), keyPtr, worker)) {
+    NanAsyncQueueWorker(worker);
+  }
+}
+
+void KeyedWorkQueue::queue(const RegionPtr & regionPtr, const Keys & keys, NanAsyncWorker * worker) {
+  if (add(regionPtr.ptr(), keys, worker)) {
+    NanAsyncQueueWorker(worker);
+  }
+}
+
+void KeyedWorkQueue::completed(const RegionPtr & regionPtr, const CacheableKeyPtr & keyPtr) {
+  if (keyPtr == NULLPTR) {
+    return;
+  }
+
+  NanAsyncWorker * worker = next(regionPtr.ptr(), keyPtr);
+  if (worker != NULL) {
+    NanAsyncQueueWorker(worker);
+  }
+}
+
+void KeyedWorkQueue::completed(const RegionPtr & regionPtr, const Keys & keys) {
+  for (Keys::const_iterator iterator(keys.begin()); iterator != keys.end(); ++iterator) {
+    completed(regionPtr, *iterator);
+  }
+}
+
+bool KeyedWorkQueue::add(gemfire::Region * region, const CacheableKeyPtr & keyPtr, NanAsyncWorker * worker) {
+  return add(region, Keys(1, keyPtr), worker);
+}
+
+bool KeyedWorkQueue::add(gemfire::Region * region, const Keys & keys, NanAsyncWorker * worker) {
+  Waiter * waiter = new Waiter(worker);
+
+  for (Keys::const_iterator iterator(keys.begin()); iterator != keys.end(); ++iterator) {
+    RegionKey regionKey(region, *iterator);
+
+    WaitingWorkers::iterator waitingIterator(waitingWorkers.find(regionKey));
+    if (waitingIterator == waitingWorkers.end()) {
+      waitingWorkers[regionKey];
+    } else {
+      waitingIterator->second.push_back(waiter);
+      waiter->blockingKeys++;
+    }
+  }
+
+  if (waiter->blockingKeys > 0) {
+    return false;
+  }
+
+  delete waiter;
+  return true;
+}
+
+NanAsyncWorker * KeyedWorkQueue::next(gemfire::Region * region, const CacheableKeyPtr & keyPtr) {
+  WaitingWorkers::iterator iterator(waitingWorkers.find(RegionKey(region, keyPtr)));
+  if (iterator == waitingWorkers.end()) {
+    return NULL;
+  }
+
+  if (iterator->second.empty()) {
+    waitingWorkers.erase(iterator);
+    return NULL;
+  }
+
+  // The key now belongs to the waiter, even if it still waits for others.
+  Waiter * waiter = iterator->second.front();
+  iterator->second.pop_front();
+
+  waiter->blockingKeys--;
+  if (waiter->blockingKeys > 0) {
+    return NULL;
+  }
+
+  NanAsyncWorker * worker = waiter->worker;
+  delete waiter;
+  return worker;
+}
+
+unsigned int KeyedWorkQueue::size() {
+  return waitingWorkers.size();
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,103 @@
+#ifndef __KEYED_WORK_QUEUE_HPP__
+#define __KEYED_WORK_QUEUE_HPP__
+
+#include <nan.h>
+#include <gfcpp/Region.hpp>
+#include <gfcpp/CacheableKey.hpp>
+#include <tr1/unordered_map>
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+namespace node_gemfire {
+
+// Keeps asynchronous writes to the same key of the same region in the order they were made.
+//
+// The first worker for a key is started right away. Later workers for that key wait until the one
+// before them has completed, while workers for other keys still run in parallel on the pool.
+//
+// A worker for several keys, such as a putAll, takes its place behind the earlier workers of every
+// one of them and starts once it has reached the front of each. Because it is added to all of them
+// at once, it never waits on a worker that was queued after it.
+//
+// Only accessed from the main thread.
+class KeyedWorkQueue {
+ public:
+  typedef std::vector<gemfire::CacheableKeyPtr> Keys;
+
+  static KeyedWorkQueue * getInstance();
+
+  // Starts the worker now or once the previous worker for the key has completed. Workers without
+  // a key aren't ordered.
+  void queue(const gemfire::RegionPtr & regionPtr,
+             const gemfire::CacheableKeyPtr & keyPtr,
+             NanAsyncWorker * worker);
+
+  // Starts the worker now or once the previous workers for all of the keys, which must be distinct,
+  // have completed.
+  void queue(const gemfire::RegionPtr & regionPtr, const Keys & keys, NanAsyncWorker * worker);
+
+  // Must be called when a queued worker completes, to start the next one for its key or keys.
+  void completed(const gemfire::RegionPtr & regionPtr, const gemfire::CacheableKeyPtr & keyPtr);
+  void completed(const gemfire::RegionPtr & regionPtr, const Keys & keys);
+
+  // Returns true if the worker can start now; otherwise it is held until next() returns it.
+  bool add(gemfire::Region * region, const gemfire::CacheableKeyPtr & keyPtr, NanAsyncWorker * worker);
+  bool add(gemfire::Region * region, const Keys & keys, NanAsyncWorker * worker);
+
+  // Returns the worker waiting behind the one that just completed, or NULL if there is none or it
+  // is still waiting behind the workers of its other keys.
+  NanAsyncWorker * next(gemfire::Region * region, const gemfire::CacheableKeyPtr & keyPtr);
+
+  unsigned int size();
+
+ private:
+  class RegionKey {
+   public:
+    RegionKey(gemfire::Region * region, const gemfire::CacheableKeyPtr & keyPtr) :
+      region(region),
+      keyPtr(keyPtr) {}
+
+    gemfire::Region * region;
+    gemfire::CacheableKeyPtr keyPtr;
+  };
+
+  class RegionKeyHash {
+   public:
+    size_t operator()(const RegionKey & regionKey) const {
+      return regionKey.keyPtr->hashcode() ^ reinterpret_cast<size_t>(regionKey.region);
+    }
+  };
+
+  class RegionKeyEqual {
+   public:
+    bool operator()(const RegionKey & a, const RegionKey & b) const {
+      return a.region == b.region && *a.keyPtr == *b.keyPtr;
+    }
+  };
+
+  // A held worker and the number of its keys it has not yet reached the front of.
+  class Waiter {
+   public:
+    explicit Waiter(NanAsyncWorker * worker) :
+      worker(worker),
+      blockingKeys(0) {}
+
+    NanAsyncWorker * worker;
+    unsigned int blockingKeys;
+  };
+
+  // A key is present while a worker for it is running or waiting for its other keys; its deque
+  // holds the workers waiting behind.
+  typedef std::tr1::unordered_map<RegionKey,
+                                  std::deque<Waiter *>,
+                                  RegionKeyHash,
+                                  RegionKeyEqual> WaitingWorkers;
+
+  static KeyedWorkQueue instance;
+  WaitingWorkers waitingWorkers;
+};
+
+}  // namespace node_gemfire
+
+#endif
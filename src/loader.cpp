@@ -0,0 +1,301 @@
+#include "loader.hpp"
+#include <gfcpp/Region.hpp>
+#include <nan.h>
+#include <uv.h>
+#include <utility>
+#include <vector>
+#include "region.hpp"
+#include "conversions.hpp"
+#include "exceptions.hpp"
+#include "events.hpp"
+#include "gemfire_worker.hpp"
+#include "keyed_work_queue.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+class LoaderPutWorker : public GemfireWorker {
+ public:
+  LoaderPutWorker(
+    const Local<Object> & regionObject,
+    Region * region,
+    unsigned int loadId,
+    const CacheableKeyPtr & keyPtr,
+    const CacheablePtr & valuePtr) :
+      GemfireWorker(NULL),
+      region(region),
+      loadId(loadId),
+      keyPtr(keyPtr),
+      valuePtr(valuePtr) {
+        SaveToPersistent("regionObject", regionObject);
+      }
+
+  void ExecuteGemfireWork() {
+    region->regionPtr->put(keyPtr, valuePtr);
+  }
+
+  void HandleOKCallback() {
+    region->loader->written(loadId);
+  }
+
+  // The value was loaded successfully, so the waiting callers still get it. Failing to write it
+  // back is reported on the region instead.
+  void HandleErrorCallback() {
+    NanScope();
+
+    emitError(GetFromPersistent("regionObject"), errorObject());
+    region->loader->written(loadId);
+  }
+
+  void WorkComplete() {
+    GemfireWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(region->regionPtr, keyPtr);
+  }
+
+ private:
+  Region * region;
+  unsigned int loadId;
+  CacheableKeyPtr keyPtr;
+  CacheablePtr valuePtr;
+};
+
+// The waiters of loads that were still pending when their region was garbage collected, because the
+// loader dropped its done function. They can't be called back during garbage collection, so they
+// are failed on a later turn of the event loop.
+class AbandonedLoads {
+ public:
+  AbandonedLoads() {
+    request.data = reinterpret_cast<void *>(this);
+  }
+
+  void fail() {
+    uv_queue_work(uv_default_loop(), &request, Execute, ExecuteComplete);
+  }
+
+  static void Execute(uv_work_t * request) {}
+
+  static void ExecuteComplete(uv_work_t * request, int status) {
+    NanScope();
+
+    AbandonedLoads * abandonedLoads = static_cast<AbandonedLoads *>(request->data);
+    Local<Value> error(v8Error("LoadAbandonedError",
+          "The region was garbage collected before the load completed."));
+
+    for (Waiters::iterator iterator(abandonedLoads->waiters.begin());
+         iterator != abandonedLoads->waiters.end();
+         ++iterator) {
+      iterator->second->loaded(iterator->first, error, Local<Value>());
+    }
+
+    delete abandonedLoads;
+  }
+
+  typedef std::vector<std::pair<CacheableKeyPtr, LoadWaiter *> > Waiters;
+
+  uv_work_t request;
+  Waiters waiters;
+};
+
+Loader::~Loader() {
+  NanDisposePersistent(loadFunction);
+
+  AbandonedLoads * abandonedLoads = new AbandonedLoads();
+
+  for (PendingLoadsById::iterator iterator(pendingLoadsById.begin());
+       iterator != pendingLoadsById.end();
+       ++iterator) {
+    PendingLoad * pendingLoad = iterator->second;
+
+    for (std::vector<LoadWaiter *>::iterator waiterIterator(pendingLoad->waiters.begin());
+         waiterIterator != pendingLoad->waiters.end();
+         ++waiterIterator) {
+      abandonedLoads->waiters.push_back(std::make_pair(pendingLoad->keyPtr, *waiterIterator));
+    }
+
+    delete pendingLoad;
+  }
+
+  if (abandonedLoads->waiters.empty()) {
+    delete abandonedLoads;
+  } else {
+    abandonedLoads->fail();
+  }
+}
+
+void Loader::setFunction(const Local<Value> & function) {
+  NanDisposePersistent(loadFunction);
+
+  if (function->IsFunction()) {
+    NanAssignPersistent(loadFunction, function.As<Function>());
+  }
+}
+
+bool Loader::enabled() {
+  return !loadFunction.IsEmpty();
+}
+
+void Loader::hit() {
+  hits++;
+}
+
+void Loader::load(const CacheableKeyPtr & keyPtr, LoadWaiter * waiter) {
+  misses++;
+
+  PendingLoadsByKey::iterator iterator(pendingLoadsByKey.find(keyPtr));
+  if (iterator != pendingLoadsByKey.end()) {
+    coalesced++;
+    iterator->second->waiters.push_back(waiter);
+    return;
+  }
+
+  PendingLoad * pendingLoad = new PendingLoad(nextLoadId++, keyPtr);
+  pendingLoad->waiters.push_back(waiter);
+  pendingLoadsByKey[keyPtr] = pendingLoad;
+  pendingLoadsById[pendingLoad->id] = pendingLoad;
+
+  start(pendingLoad);
+}
+
+void Loader::start(PendingLoad * pendingLoad) {
+  NanScope();
+
+  loads++;
+
+  // The loader may call done() synchronously, which can free pendingLoad before Call() returns.
+  unsigned int loadId = pendingLoad->id;
+  Local<Object> regionObject(NanObjectWrapHandle(region));
+
+  Local<Array> doneData(NanNew<Array>(2));
+  doneData->Set(0, regionObject);
+  doneData->Set(1, NanNew<Uint32>(loadId));
+  Local<Function> doneFunction(NanNew<FunctionTemplate>(Loader::Done, doneData)->GetFunction());
+
+  static const int argc = 2;
+  Local<Value> argv[argc] = { v8Value(pendingLoad->keyPtr), doneFunction };
+
+  TryCatch tryCatch;
+  NanNew(loadFunction)->Call(regionObject, argc, argv);
+  if (tryCatch.HasCaught()) {
+    done(loadId, tryCatch.Exception(), NanUndefined());
+  }
+}
+
+NAN_METHOD(Loader::Done) {
+  NanScope();
+
+  Local<Array> doneData(args.Data().As<Array>());
+  Region * region = node::ObjectWrap::Unwrap<Region>(doneData->Get(0)->ToObject());
+  region->loader->done(doneData->Get(1)->Uint32Value(), args[0], args[1]);
+
+  NanReturnUndefined();
+}
+
+void Loader::done(unsigned int loadId, const Local<Value> & error, const Local<Value> & value) {
+  NanScope();
+
+  PendingLoadsById::iterator iterator(pendingLoadsById.find(loadId));
+  if (iterator == pendingLoadsById.end() || iterator->second->loaded) {
+    return;
+  }
+
+  PendingLoad * pendingLoad = iterator->second;
+  pendingLoad->loaded = true;
+  totalLoadTime += uv_hrtime() - pendingLoad->startedAt;
+
+  if (!error->IsUndefined() && !error->IsNull()) {
+    loadErrors++;
+    complete(pendingLoad, error, NULLPTR);
+    return;
+  }
+
+  if (value->IsUndefined() || value->IsNull()) {
+    complete(pendingLoad, NanUndefined(), NULLPTR);
+    return;
+  }
+
+  CacheablePtr valuePtr;
+  TryCatch tryCatch;
+  try {
+    valuePtr = gemfireValue(value, region->regionPtr->getCache());
+  } catch (const gemfire::Exception & exception) {
+    loadErrors++;
+    complete(pendingLoad, v8Error(exception), NULLPTR);
+    return;
+  }
+
+  if (tryCatch.HasCaught()) {
+    loadErrors++;
+    complete(pendingLoad, tryCatch.Exception(), NULLPTR);
+    return;
+  }
+
+  if (valuePtr == NULLPTR) {
+    loadErrors++;
+    complete(pendingLoad, v8Error("InvalidValueError", "Invalid GemFire value."), NULLPTR);
+    return;
+  }
+
+  pendingLoad->valuePtr = valuePtr;
+  region->invalidate(pendingLoad->keyPtr);
+
+  LoaderPutWorker * worker = new LoaderPutWorker(
+      NanObjectWrapHandle(region), region, loadId, pendingLoad->keyPtr, valuePtr);
+  KeyedWorkQueue::getInstance()->queue(region->regionPtr, pendingLoad->keyPtr, worker);
+}
+
+void Loader::written(unsigned int loadId) {
+  PendingLoadsById::iterator iterator(pendingLoadsById.find(loadId));
+  if (iterator == pendingLoadsById.end()) {
+    return;
+  }
+
+  PendingLoad * pendingLoad = iterator->second;
+  complete(pendingLoad, NanUndefined(), pendingLoad->valuePtr);
+}
+
+void Loader::complete(PendingLoad * pendingLoad,
+                      const Local<Value> & error,
+                      const CacheablePtr & valuePtr) {
+  NanScope();
+
+  pendingLoadsByKey.erase(pendingLoad->keyPtr);
+  pendingLoadsById.erase(pendingLoad->id);
+
+  for (std::vector<LoadWaiter *>::iterator iterator(pendingLoad->waiters.begin());
+       iterator != pendingLoad->waiters.end();
+       ++iterator) {
+    if (valuePtr == NULLPTR) {
+      (*iterator)->loaded(pendingLoad->keyPtr, error, Local<Value>());
+    } else {
+      (*iterator)->loaded(pendingLoad->keyPtr, error, region->decodedValue(pendingLoad->keyPtr, valuePtr));
+    }
+  }
+
+  delete pendingLoad;
+}
+
+Local<Object> Loader::statistics() {
+  NanEscapableScope();
+
+  unsigned int lookups = hits + misses;
+  unsigned int completedLoads = loads - pendingLoadsById.size();
+  double totalLoadTimeMillis = totalLoadTime / 1e6;
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("hits"), NanNew(hits));
+  statistics->Set(NanNew("misses"), NanNew(misses));
+  statistics->Set(NanNew("hitRatio"), NanNew<Number>(lookups == 0 ? 0 : static_cast<double>(hits) / lookups));
+  statistics->Set(NanNew("loads"), NanNew(loads));
+  statistics->Set(NanNew("loadErrors"), NanNew(loadErrors));
+  statistics->Set(NanNew("coalesced"), NanNew(coalesced));
+  statistics->Set(NanNew("pending"), NanNew(static_cast<unsigned int>(pendingLoadsById.size())));
+  statistics->Set(NanNew("totalLoadTime"), NanNew<Number>(totalLoadTimeMillis));
+  statistics->Set(NanNew("averageLoadTime"),
+      NanNew<Number>(completedLoads == 0 ? 0 : totalLoadTimeMillis / completedLoads));
+
+  return NanEscapeScope(statistics);
+}
+
+}  // namespace node_gemfire
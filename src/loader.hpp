@@ -0,0 +1,105 @@
+#ifndef __LOADER_HPP__
+#define __LOADER_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/Cacheable.hpp>
+#include <stdint.h>
+#include <uv.h>
+#include <tr1/unordered_map>
+#include <map>
+#include <vector>
+#include "cacheable_key_functors.hpp"
+
+namespace node_gemfire {
+
+class Region;
+
+// Something waiting for the result of a load, such as a get() callback or the keys of a getAll().
+// An empty value means the loader didn't find the key either. Waiters manage their own lifetime.
+class LoadWaiter {
+ public:
+  virtual ~LoadWaiter() {}
+  virtual void loaded(const gemfire::CacheableKeyPtr & keyPtr,
+                      const v8::Local<v8::Value> & error,
+                      const v8::Local<v8::Value> & value) = 0;
+};
+
+// Calls a JavaScript loader function for keys that missed in a region, at most once per key no
+// matter how many callers are waiting for it. Loaded values are written back to the region before
+// the waiting callers are completed.
+//
+// Only accessed from the main thread.
+class Loader {
+ public:
+  explicit Loader(Region * region) :
+    region(region),
+    nextLoadId(0),
+    hits(0),
+    misses(0),
+    loads(0),
+    loadErrors(0),
+    coalesced(0),
+    totalLoadTime(0) {}
+
+  ~Loader();
+
+  void setFunction(const v8::Local<v8::Value> & loadFunction);
+  bool enabled();
+
+  void hit();
+  void load(const gemfire::CacheableKeyPtr & keyPtr, LoadWaiter * waiter);
+  void written(unsigned int loadId);
+
+  v8::Local<v8::Object> statistics();
+
+  static NAN_METHOD(Done);
+
+ private:
+  class PendingLoad {
+   public:
+    PendingLoad(unsigned int id, const gemfire::CacheableKeyPtr & keyPtr) :
+      id(id),
+      keyPtr(keyPtr),
+      startedAt(uv_hrtime()),
+      loaded(false) {}
+
+    unsigned int id;
+    gemfire::CacheableKeyPtr keyPtr;
+    gemfire::CacheablePtr valuePtr;
+    uint64_t startedAt;
+    bool loaded;
+    std::vector<LoadWaiter *> waiters;
+  };
+
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  PendingLoad *,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> PendingLoadsByKey;
+  typedef std::map<unsigned int, PendingLoad *> PendingLoadsById;
+
+  void start(PendingLoad * pendingLoad);
+  void done(unsigned int loadId, const v8::Local<v8::Value> & error, const v8::Local<v8::Value> & value);
+  void complete(PendingLoad * pendingLoad,
+                const v8::Local<v8::Value> & error,
+                const gemfire::CacheablePtr & valuePtr);
+
+  Region * region;
+  v8::Persistent<v8::Function> loadFunction;
+
+  PendingLoadsByKey pendingLoadsByKey;
+  PendingLoadsById pendingLoadsById;
+  unsigned int nextLoadId;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int loads;
+  unsigned int loadErrors;
+  unsigned int coalesced;
+  uint64_t totalLoadTime;
+};
+
+}  // namespace node_gemfire
+
+#endif
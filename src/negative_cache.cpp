@@ -0,0 +1,147 @@
+#include "negative_cache.hpp"
+#include <nan.h>
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+bool NegativeCache::contains(const CacheableKeyPtr & keyPtr) {
+  uv_mutex_lock(&mutex);
+
+  bool found = false;
+  EntryIndex::iterator indexIterator(entryIndex.find(keyPtr));
+  if (indexIterator != entryIndex.end()) {
+    if (indexIterator->second->expiresAt > now()) {
+      found = true;
+    } else {
+      entryList.erase(indexIterator->second);
+      entryIndex.erase(indexIterator);
+      expirations++;
+    }
+  }
+
+  if (found) {
+    hits++;
+  } else {
+    misses++;
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  return found;
+}
+
+uint64_t NegativeCache::epoch(const CacheableKeyPtr & keyPtr) {
+  uv_mutex_lock(&mutex);
+  uint64_t returnValue = currentEpoch(keyPtr);
+  uv_mutex_unlock(&mutex);
+
+  return returnValue;
+}
+
+void NegativeCache::add(const CacheableKeyPtr & keyPtr, uint64_t epoch) {
+  uv_mutex_lock(&mutex);
+
+  if (epoch == currentEpoch(keyPtr)) {
+    uint64_t currentTime = now();
+
+    while (!entryList.empty() && entryList.front().expiresAt <= currentTime) {
+      entryIndex.erase(entryList.front().keyPtr);
+      entryList.pop_front();
+      expirations++;
+    }
+
+    remove(keyPtr);
+
+    entryList.push_back(Entry(keyPtr, currentTime + ttl));
+    entryIndex[keyPtr] = --entryList.end();
+
+    while (maxEntries > 0 && entryIndex.size() > maxEntries) {
+      entryIndex.erase(entryList.front().keyPtr);
+      entryList.pop_front();
+      evictions++;
+    }
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+void NegativeCache::invalidate(const CacheableKeyPtr & keyPtr) {
+  uv_mutex_lock(&mutex);
+
+  keyEpochs[CacheableKeyHash()(keyPtr) % epochSlots]++;
+  if (remove(keyPtr)) {
+    invalidations++;
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+void NegativeCache::invalidate(const HashMapOfCacheablePtr & hashMapPtr) {
+  uv_mutex_lock(&mutex);
+
+  for (HashMapOfCacheable::Iterator iterator = hashMapPtr->begin();
+       iterator != hashMapPtr->end();
+       iterator++) {
+    keyEpochs[CacheableKeyHash()(iterator.first()) % epochSlots]++;
+    if (remove(iterator.first())) {
+      invalidations++;
+    }
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+void NegativeCache::clear() {
+  uv_mutex_lock(&mutex);
+
+  clears++;
+  invalidations += entryIndex.size();
+  entryList.clear();
+  entryIndex.clear();
+
+  uv_mutex_unlock(&mutex);
+}
+
+Local<Object> NegativeCache::statistics() {
+  NanEscapableScope();
+
+  uv_mutex_lock(&mutex);
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("entries"), NanNew(static_cast<unsigned int>(entryIndex.size())));
+  statistics->Set(NanNew("maxEntries"), NanNew(maxEntries));
+  statistics->Set(NanNew("ttl"), NanNew<Number>(ttl));
+  statistics->Set(NanNew("hits"), NanNew(hits));
+  statistics->Set(NanNew("misses"), NanNew(misses));
+  statistics->Set(NanNew("invalidations"), NanNew(invalidations));
+  statistics->Set(NanNew("expirations"), NanNew(expirations));
+  statistics->Set(NanNew("evictions"), NanNew(evictions));
+
+  uv_mutex_unlock(&mutex);
+
+  return NanEscapeScope(statistics);
+}
+
+bool NegativeCache::remove(const CacheableKeyPtr & keyPtr) {
+  EntryIndex::iterator indexIterator(entryIndex.find(keyPtr));
+  if (indexIterator == entryIndex.end()) {
+    return false;
+  }
+
+  entryList.erase(indexIterator->second);
+  entryIndex.erase(indexIterator);
+  return true;
+}
+
+// Both counts only grow, so their sum changes whenever either does.
+uint64_t NegativeCache::currentEpoch(const CacheableKeyPtr & keyPtr) {
+  return clears + keyEpochs[CacheableKeyHash()(keyPtr) % epochSlots];
+}
+
+uint64_t NegativeCache::now() {
+  return uv_hrtime() / 1000000;
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,104 @@
+#ifndef __NEGATIVE_CACHE_HPP__
+#define __NEGATIVE_CACHE_HPP__
+
+#include <v8.h>
+#include <gfcpp/SharedPtr.hpp>
+#include <gfcpp/SharedBase.hpp>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/HashMapOfCacheable.hpp>
+#include <uv.h>
+#include <stdint.h>
+#include <tr1/unordered_map>
+#include <list>
+#include "cacheable_key_functors.hpp"
+
+namespace node_gemfire {
+
+// Remembers keys that were recently found to be absent from a region, so that repeated lookups
+// of missing keys don't each cost a server round trip.
+//
+// Lookups happen on worker threads, so every operation takes the mutex.
+class NegativeCache : public gemfire::SharedBase {
+ public:
+  NegativeCache(uint64_t ttl, unsigned int maxEntries, bool undefinedOnMiss) :
+    SharedBase(),
+    ttl(ttl),
+    maxEntries(maxEntries),
+    undefinedOnMiss(undefinedOnMiss),
+    clears(0),
+    hits(0),
+    misses(0),
+    invalidations(0),
+    expirations(0),
+    evictions(0) {
+      uv_mutex_init(&mutex);
+
+      for (size_t i = 0; i < epochSlots; i++) {
+        keyEpochs[i] = 0;
+      }
+    }
+
+  virtual ~NegativeCache() {
+    uv_mutex_destroy(&mutex);
+  }
+
+  bool contains(const gemfire::CacheableKeyPtr & keyPtr);
+  uint64_t epoch(const gemfire::CacheableKeyPtr & keyPtr);
+  void add(const gemfire::CacheableKeyPtr & keyPtr, uint64_t epoch);
+  void invalidate(const gemfire::CacheableKeyPtr & keyPtr);
+  void invalidate(const gemfire::HashMapOfCacheablePtr & hashMapPtr);
+  void clear();
+
+  v8::Local<v8::Object> statistics();
+
+  const uint64_t ttl;
+  const unsigned int maxEntries;
+  const bool undefinedOnMiss;
+
+ private:
+  class Entry {
+   public:
+    Entry(const gemfire::CacheableKeyPtr & keyPtr, uint64_t expiresAt) :
+      keyPtr(keyPtr),
+      expiresAt(expiresAt) {}
+
+    gemfire::CacheableKeyPtr keyPtr;
+    uint64_t expiresAt;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  EntryList::iterator,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> EntryIndex;
+
+  bool remove(const gemfire::CacheableKeyPtr & keyPtr);
+  uint64_t currentEpoch(const gemfire::CacheableKeyPtr & keyPtr);
+  static uint64_t now();
+
+  static const size_t epochSlots = 1024;
+
+  uv_mutex_t mutex;
+
+  // A lookup that started before an invalidation of its key must not record its miss afterwards, or
+  // a key created in the meantime would be cached as missing. Keys share epochs by hash, so that
+  // writes to other keys rarely discard a miss while the epochs take a fixed amount of memory.
+  // clear() counts as an invalidation of every key.
+  uint64_t clears;
+  uint64_t keyEpochs[epochSlots];
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int invalidations;
+  unsigned int expirations;
+  unsigned int evictions;
+
+  EntryList entryList;
+  EntryIndex entryIndex;
+};
+
+typedef gemfire::SharedPtr<NegativeCache> NegativeCachePtr;
+
+}  // namespace node_gemfire
+
+#endif
@@ -0,0 +1,68 @@
+#include "operation_options.hpp"
+#include <nan.h>
+#include <uv.h>
+#include <sstream>
+
+using namespace v8;
+
+namespace node_gemfire {
+
+bool OperationOptions::parse(const Local<Value> & optionsValue, const char * methodName) {
+  NanScope();
+
+  if (!optionsValue->IsObject()) {
+    return true;
+  }
+
+  Local<Object> optionsObject(optionsValue->ToObject());
+  Local<Value> timeout(optionsObject->Get(NanNew("timeout")));
+  Local<Value> cancelToken(optionsObject->Get(NanNew("cancelToken")));
+
+  if (!timeout->IsUndefined()) {
+    if (!(timeout->IsNumber() && timeout->NumberValue() > 0)) {
+      std::stringstream errorStream;
+      errorStream << methodName << ": timeout must be a positive number of milliseconds.";
+      NanThrowError(errorStream.str().c_str());
+      return false;
+    }
+
+    deadline = uv_hrtime() + static_cast<uint64_t>(timeout->NumberValue() * 1e6);
+  }
+
+  if (!cancelToken->IsUndefined()) {
+    if (!CancelToken::HasInstance(cancelToken)) {
+      std::stringstream errorStream;
+      errorStream << methodName << ": cancelToken must be a gemfire.CancelToken.";
+      NanThrowError(errorStream.str().c_str());
+      return false;
+    }
+
+    cancelStatePtr = node::ObjectWrap::Unwrap<CancelToken>(cancelToken->ToObject())->cancelStatePtr;
+  }
+
+  return true;
+}
+
+bool OperationOptions::cancelled() const {
+  return cancelStatePtr != NULLPTR && cancelStatePtr->isCancelled();
+}
+
+bool OperationOptions::expired() const {
+  return deadline != 0 && uv_hrtime() >= deadline;
+}
+
+uint32_t OperationOptions::timeoutSeconds(uint32_t defaultTimeout) const {
+  if (deadline == 0) {
+    return defaultTimeout;
+  }
+
+  uint64_t now = uv_hrtime();
+  if (now >= deadline) {
+    return 1;
+  }
+
+  static const uint64_t nanosecondsPerSecond = 1000000000;
+  return static_cast<uint32_t>((deadline - now + nanosecondsPerSecond - 1) / nanosecondsPerSecond);
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,42 @@
+#ifndef __OPERATION_OPTIONS_HPP__
+#define __OPERATION_OPTIONS_HPP__
+
+#include <v8.h>
+#include <stdint.h>
+#include "cancel_token.hpp"
+
+namespace node_gemfire {
+
+// The timeout and cancel token that can be passed to an asynchronous operation. Work that is
+// cancelled, or whose deadline has passed, by the time a pool thread picks it up isn't started.
+class OperationOptions {
+ public:
+  OperationOptions() :
+    deadline(0),
+    cancelStatePtr(NULLPTR) {}
+
+  // Reads `timeout` and `cancelToken` from an options object. Throws and returns false if either
+  // is invalid.
+  bool parse(const v8::Local<v8::Value> & optionsValue, const char * methodName);
+
+  bool cancelled() const;
+  bool expired() const;
+
+  // True when neither a timeout nor a cancel token was given.
+  bool empty() const {
+    return deadline == 0 && cancelStatePtr == NULLPTR;
+  }
+
+  // The time left before the deadline in whole seconds, rounded up, for GemFire calls that take a
+  // timeout. Returns defaultTimeout when there is no deadline.
+  uint32_t timeoutSeconds(uint32_t defaultTimeout) const;
+
+ private:
+  // In uv_hrtime() nanoseconds; 0 means no deadline.
+  uint64_t deadline;
+  CancelStatePtr cancelStatePtr;
+};
+
+}  // namespace node_gemfire
+
+#endif
@@ -0,0 +1,132 @@
+#include "prepared_query.hpp"
+#include <gfcpp/CacheableBuiltins.hpp>
+#include <sstream>
+#include "cache.hpp"
+#include "conversions.hpp"
+#include "operation_options.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+Persistent<Function> PreparedQuery::constructor;
+
+void PreparedQuery::Init(Local<Object> exports) {
+  NanScope();
+
+  Local<FunctionTemplate> constructorTemplate(NanNew<FunctionTemplate>());
+
+  constructorTemplate->SetClassName(NanNew("PreparedQuery"));
+  constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NanSetPrototypeTemplate(constructorTemplate, "execute",
+      NanNew<FunctionTemplate>(PreparedQuery::Execute)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "inspect",
+      NanNew<FunctionTemplate>(PreparedQuery::Inspect)->GetFunction());
+
+  constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("query"), PreparedQuery::Query);
+
+  NanAssignPersistent(PreparedQuery::constructor, constructorTemplate->GetFunction());
+}
+
+Local<Object> PreparedQuery::NewInstance(const Local<Object> & cacheObject,
+                                         const QueryPtr & queryPtr,
+                                         const std::string & poolName,
+                                         const std::string & queryString) {
+  NanEscapableScope();
+
+  const unsigned int argc = 0;
+  Local<Value> argv[argc] = {};
+  Local<Object> v8Object(NanNew(PreparedQuery::constructor)->NewInstance(argc, argv));
+
+  PreparedQuery * preparedQuery = new PreparedQuery(cacheObject, queryPtr, poolName, queryString);
+  preparedQuery->Wrap(v8Object);
+
+  return NanEscapeScope(v8Object);
+}
+
+NAN_METHOD(PreparedQuery::Execute) {
+  NanScope();
+
+  int argsLength = args.Length();
+  if (argsLength == 0 || !args[argsLength - 1]->IsFunction()) {
+    NanThrowError("You must pass a function as the callback to execute().");
+    NanReturnUndefined();
+  }
+
+  Local<Value> paramsValue(NanUndefined());
+  Local<Value> optionsValue(NanUndefined());
+
+  // .execute(paramsArray, optionsHash, function) or .execute(paramsArray|optionsHash, function)
+  if (argsLength > 2) {
+    paramsValue = args[0];
+    optionsValue = args[1];
+  } else if (argsLength == 2) {
+    if (args[0]->IsArray()) {
+      paramsValue = args[0];
+    } else {
+      optionsValue = args[0];
+    }
+  }
+
+  if (!(paramsValue->IsUndefined() || paramsValue->IsNull() || paramsValue->IsArray())) {
+    NanThrowError("You must pass an array of parameters to execute().");
+    NanReturnUndefined();
+  }
+
+  OperationOptions operationOptions;
+  if (!optionsValue->IsUndefined()) {
+    if (!optionsValue->IsObject() || optionsValue->IsFunction()) {
+      NanThrowError("You must pass an options object to execute().");
+      NanReturnUndefined();
+    }
+
+    if (!operationOptions.parse(optionsValue->ToObject(), "execute()")) {
+      NanReturnUndefined();
+    }
+  }
+
+  PreparedQuery * preparedQuery = ObjectWrap::Unwrap<PreparedQuery>(args.This());
+  Local<Object> cacheObject(NanNew(preparedQuery->cacheHandle));
+  Cache * cache = ObjectWrap::Unwrap<Cache>(cacheObject);
+
+  if (cache->cachePtr->isClosed()) {
+    NanThrowError("Cannot execute query; cache is closed.");
+    NanReturnUndefined();
+  }
+
+  CacheableVectorPtr queryParamsPtr(NULLPTR);
+  if (paramsValue->IsArray()) {
+    queryParamsPtr = gemfireVector(paramsValue.As<Array>(), cache->cachePtr);
+  }
+
+  NanCallback * callback = new NanCallback(args[argsLength - 1].As<Function>());
+  if (!cache->queueQuery(cacheObject, preparedQuery->queryPtr, preparedQuery->poolName, paramsValue,
+                         queryParamsPtr, operationOptions, callback)) {
+    NanReturnUndefined();
+  }
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(PreparedQuery::Inspect) {
+  NanScope();
+
+  PreparedQuery * preparedQuery = ObjectWrap::Unwrap<PreparedQuery>(args.This());
+
+  std::stringstream inspectStream;
+  inspectStream << "[PreparedQuery query=\"" << preparedQuery->queryString << "\"]";
+
+  NanReturnValue(NanNew(inspectStream.str().c_str()));
+}
+
+NAN_GETTER(PreparedQuery::Query) {
+  NanScope();
+
+  PreparedQuery * preparedQuery = ObjectWrap::Unwrap<PreparedQuery>(args.This());
+
+  NanReturnValue(NanNew(preparedQuery->queryString.c_str()));
+}
+
+}  // namespace node_gemfire
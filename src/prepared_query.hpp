@@ -0,0 +1,50 @@
+#ifndef __PREPARED_QUERY_HPP__
+#define __PREPARED_QUERY_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <node.h>
+#include <gfcpp/Query.hpp>
+#include <string>
+
+namespace node_gemfire {
+
+// The handle returned by cache.prepareQuery(). It keeps its GemFire query for good, and each
+// execution only binds the parameters passed to it.
+class PreparedQuery : public node::ObjectWrap {
+ public:
+  PreparedQuery(const v8::Local<v8::Object> & cacheObject,
+                const gemfire::QueryPtr & queryPtr,
+                const std::string & poolName,
+                const std::string & queryString) :
+    queryPtr(queryPtr),
+    poolName(poolName),
+    queryString(queryString) {
+      NanAssignPersistent(cacheHandle, cacheObject);
+    }
+
+  virtual ~PreparedQuery() {
+    NanDisposePersistent(cacheHandle);
+  }
+
+  static void Init(v8::Local<v8::Object> exports);
+  static v8::Local<v8::Object> NewInstance(const v8::Local<v8::Object> & cacheObject,
+                                           const gemfire::QueryPtr & queryPtr,
+                                           const std::string & poolName,
+                                           const std::string & queryString);
+  static NAN_METHOD(Execute);
+  static NAN_METHOD(Inspect);
+  static NAN_GETTER(Query);
+
+ private:
+  gemfire::QueryPtr queryPtr;
+  std::string poolName;
+  std::string queryString;
+  v8::Persistent<v8::Object> cacheHandle;
+
+  static v8::Persistent<v8::Function> constructor;
+};
+
+}  // namespace node_gemfire
+
+#endif
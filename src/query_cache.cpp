@@ -0,0 +1,74 @@
+#include "query_cache.hpp"
+#include <nan.h>
+#include <uv.h>
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+QueryPtr QueryCache::get(const QueryServicePtr & queryServicePtr,
+                         const std::string & poolName,
+                         const std::string & queryString) {
+  // Pool names can't contain a newline, so the key is unambiguous.
+  std::string key(poolName + "\n" + queryString);
+
+  EntryIndex::iterator indexIterator(entryIndex.find(key));
+  if (indexIterator != entryIndex.end()) {
+    entryList.splice(entryList.begin(), entryList, indexIterator->second);
+    hits++;
+    return indexIterator->second->queryPtr;
+  }
+
+  misses++;
+
+  uint64_t startedAt = uv_hrtime();
+  QueryPtr queryPtr(queryServicePtr->newQuery(queryString.c_str()));
+  totalCompileTime += uv_hrtime() - startedAt;
+
+  entryList.push_front(Entry(key, queryPtr));
+  entryIndex[key] = entryList.begin();
+
+  evict();
+
+  return queryPtr;
+}
+
+void QueryCache::clear() {
+  entryList.clear();
+  entryIndex.clear();
+}
+
+unsigned int QueryCache::size() {
+  return entryIndex.size();
+}
+
+void QueryCache::evict() {
+  while (entryIndex.size() > maxEntries) {
+    entryIndex.erase(entryList.back().key);
+    entryList.pop_back();
+    evictions++;
+  }
+}
+
+Local<Object> QueryCache::statistics() {
+  NanEscapableScope();
+
+  unsigned int lookups = hits + misses;
+  double totalCompileTimeMs = totalCompileTime / 1e6;
+  double averageCompileTimeMs = (misses == 0) ? 0 : totalCompileTimeMs / misses;
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("entries"), NanNew(size()));
+  statistics->Set(NanNew("maxEntries"), NanNew(maxEntries));
+  statistics->Set(NanNew("hits"), NanNew(hits));
+  statistics->Set(NanNew("misses"), NanNew(misses));
+  statistics->Set(NanNew("hitRatio"), NanNew<Number>(lookups == 0 ? 0 : static_cast<double>(hits) / lookups));
+  statistics->Set(NanNew("evictions"), NanNew(evictions));
+  statistics->Set(NanNew("totalCompileTime"), NanNew<Number>(totalCompileTimeMs));
+  statistics->Set(NanNew("averageCompileTime"), NanNew<Number>(averageCompileTimeMs));
+
+  return NanEscapeScope(statistics);
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,67 @@
+#ifndef __QUERY_CACHE_HPP__
+#define __QUERY_CACHE_HPP__
+
+#include <v8.h>
+#include <gfcpp/QueryService.hpp>
+#include <gfcpp/Query.hpp>
+#include <stdint.h>
+#include <tr1/unordered_map>
+#include <list>
+#include <string>
+
+namespace node_gemfire {
+
+// An LRU cache of GemFire queries, keyed by pool and OQL text, so that a query that runs over and
+// over is only created once. Parameters are bound at execution, so one query serves every set of
+// parameter values.
+//
+// Only accessed from the main thread.
+class QueryCache {
+ public:
+  explicit QueryCache(unsigned int maxEntries) :
+    maxEntries(maxEntries),
+    hits(0),
+    misses(0),
+    evictions(0),
+    totalCompileTime(0) {}
+
+  // Returns the cached query, or creates it through the query service. An empty pool name stands
+  // for the default query service. Throws GemFire exceptions.
+  gemfire::QueryPtr get(const gemfire::QueryServicePtr & queryServicePtr,
+                        const std::string & poolName,
+                        const std::string & queryString);
+  void clear();
+  unsigned int size();
+
+  v8::Local<v8::Object> statistics();
+
+ private:
+  class Entry {
+   public:
+    Entry(const std::string & key, const gemfire::QueryPtr & queryPtr) :
+      key(key),
+      queryPtr(queryPtr) {}
+
+    std::string key;
+    gemfire::QueryPtr queryPtr;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::tr1::unordered_map<std::string, EntryList::iterator> EntryIndex;
+
+  void evict();
+
+  unsigned int maxEntries;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+  uint64_t totalCompileTime;
+
+  EntryList entryList;
+  EntryIndex entryIndex;
+};
+
+}  // namespace node_gemfire
+
+#endif
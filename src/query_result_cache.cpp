@@ -0,0 +1,250 @@
+#include "query_result_cache.hpp"
+#include <nan.h>
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <utility>
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+std::string QueryResultCache::key(const std::string & scope,
+                                  const std::string & queryString,
+                                  const Local<Value> & parameters) {
+  NanScope();
+
+  std::ostringstream parametersKey;
+
+  // Only strings, numbers and booleans are told apart reliably. Each is tagged with its type, and
+  // strings with their length, so that "1" and 1 or "a,b" and "a", "b" don't share a key. Queries
+  // bound to anything else, such as Dates, nulls or objects, aren't cached.
+  if (!parameters.IsEmpty() && !parameters->IsUndefined() && !parameters->IsNull()) {
+    if (!parameters->IsArray()) {
+      return std::string();
+    }
+
+    Local<Array> parametersArray(parameters.As<Array>());
+    for (unsigned int i = 0; i < parametersArray->Length(); i++) {
+      Local<Value> parameter(parametersArray->Get(i));
+
+      if (parameter->IsString()) {
+        std::string value(*NanUtf8String(parameter));
+        parametersKey << "s" << value.size() << ":" << value;
+      } else if (parameter->IsNumber()) {
+        parametersKey << "n" << *NanUtf8String(parameter) << ";";
+      } else if (parameter->IsBoolean()) {
+        parametersKey << (parameter->BooleanValue() ? "t" : "f");
+      } else {
+        return std::string();
+      }
+    }
+  }
+
+  // Neither pool names nor region paths can contain a newline, so the key is unambiguous.
+  return scope + "\n" + queryString + "\n" + parametersKey.str();
+}
+
+static inline bool isRegionNameCharacter(char character) {
+  return isalnum(static_cast<unsigned char>(character)) || character == '_' || character == '-';
+}
+
+std::vector<std::string> QueryResultCache::regionPaths(const std::string & queryString) {
+  std::vector<std::string> paths;
+  bool quoted = false;
+
+  for (std::string::size_type i = 0; i < queryString.size(); i++) {
+    char character = queryString[i];
+
+    // String literals may contain slashes. A doubled quote inside one toggles twice.
+    if (character == '\'') {
+      quoted = !quoted;
+      continue;
+    }
+
+    if (quoted || character != '/' || i + 1 == queryString.size() ||
+        !isRegionNameCharacter(queryString[i + 1])) {
+      continue;
+    }
+
+    // Paths end at the first character that can't be part of one, such as the dot of
+    // "/region.entries".
+    std::string::size_type end = i + 1;
+    while (end < queryString.size() &&
+           (isRegionNameCharacter(queryString[end]) || queryString[end] == '/')) {
+      end++;
+    }
+
+    std::string path(queryString.substr(i, end - i));
+    if (path[path.size() - 1] == '/') {
+      path.erase(path.size() - 1);
+    }
+
+    if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+      paths.push_back(path);
+    }
+
+    i = end - 1;
+  }
+
+  return paths;
+}
+
+bool QueryResultCache::get(const std::string & key, SelectResultsPtr & selectResultsPtr) {
+  uv_mutex_lock(&mutex);
+
+  bool found = false;
+  EntryIndex::iterator indexIterator(entryIndex.find(key));
+  if (indexIterator != entryIndex.end()) {
+    EntryList::iterator entryIterator(indexIterator->second);
+
+    if (entryIterator->expiresAt > now()) {
+      entryList.splice(entryList.begin(), entryList, entryIterator);
+      selectResultsPtr = entryIterator->selectResultsPtr;
+      found = true;
+    } else {
+      remove(entryIterator);
+      expirations++;
+    }
+  }
+
+  if (found) {
+    hits++;
+  } else {
+    misses++;
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  return found;
+}
+
+QueryResultCache::Epochs QueryResultCache::epochs(const std::vector<std::string> & regionPaths) {
+  uv_mutex_lock(&mutex);
+  Epochs returnValue(currentEpochs(regionPaths));
+  uv_mutex_unlock(&mutex);
+
+  return returnValue;
+}
+
+void QueryResultCache::add(const std::string & key,
+                           const std::vector<std::string> & regionPaths,
+                           const SelectResultsPtr & selectResultsPtr,
+                           const Epochs & epochs) {
+  uv_mutex_lock(&mutex);
+
+  if (epochs == currentEpochs(regionPaths)) {
+    EntryIndex::iterator indexIterator(entryIndex.find(key));
+    if (indexIterator != entryIndex.end()) {
+      remove(indexIterator->second);
+    }
+
+    entryList.push_front(Entry(key, regionPaths, selectResultsPtr, now() + ttl));
+    entryIndex[key] = entryList.begin();
+
+    for (std::vector<std::string>::const_iterator iterator(regionPaths.begin());
+         iterator != regionPaths.end();
+         ++iterator) {
+      regionIndex.insert(std::make_pair(*iterator, entryList.begin()));
+    }
+
+    while (entryIndex.size() > maxEntries) {
+      remove(--entryList.end());
+      evictions++;
+    }
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+void QueryResultCache::invalidate(const std::string & regionPath) {
+  uv_mutex_lock(&mutex);
+
+  regionEpochs[regionPath]++;
+
+  std::pair<RegionIndex::iterator, RegionIndex::iterator> range(regionIndex.equal_range(regionPath));
+  while (range.first != range.second) {
+    EntryList::iterator entryIterator(range.first->second);
+    remove(entryIterator);
+    invalidations++;
+
+    range = regionIndex.equal_range(regionPath);
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+void QueryResultCache::clear() {
+  uv_mutex_lock(&mutex);
+
+  clears++;
+  regionEpochs.clear();
+  invalidations += entryIndex.size();
+  entryList.clear();
+  entryIndex.clear();
+  regionIndex.clear();
+
+  uv_mutex_unlock(&mutex);
+}
+
+Local<Object> QueryResultCache::statistics() {
+  NanEscapableScope();
+
+  uv_mutex_lock(&mutex);
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("entries"), NanNew(static_cast<unsigned int>(entryIndex.size())));
+  statistics->Set(NanNew("maxEntries"), NanNew(maxEntries));
+  statistics->Set(NanNew("ttl"), NanNew<Number>(ttl));
+  statistics->Set(NanNew("hits"), NanNew(hits));
+  statistics->Set(NanNew("misses"), NanNew(misses));
+  statistics->Set(NanNew("invalidations"), NanNew(invalidations));
+  statistics->Set(NanNew("expirations"), NanNew(expirations));
+  statistics->Set(NanNew("evictions"), NanNew(evictions));
+
+  uv_mutex_unlock(&mutex);
+
+  return NanEscapeScope(statistics);
+}
+
+void QueryResultCache::remove(EntryList::iterator entryIterator) {
+  for (std::vector<std::string>::iterator pathIterator(entryIterator->regionPaths.begin());
+       pathIterator != entryIterator->regionPaths.end();
+       ++pathIterator) {
+    std::pair<RegionIndex::iterator, RegionIndex::iterator> range(
+        regionIndex.equal_range(*pathIterator));
+
+    for (RegionIndex::iterator iterator(range.first); iterator != range.second; ++iterator) {
+      if (iterator->second == entryIterator) {
+        regionIndex.erase(iterator);
+        break;
+      }
+    }
+  }
+
+  entryIndex.erase(entryIterator->key);
+  entryList.erase(entryIterator);
+}
+
+QueryResultCache::Epochs QueryResultCache::currentEpochs(
+    const std::vector<std::string> & regionPaths) {
+  Epochs returnValue;
+  returnValue.reserve(regionPaths.size() + 1);
+  returnValue.push_back(clears);
+
+  for (std::vector<std::string>::const_iterator iterator(regionPaths.begin());
+       iterator != regionPaths.end();
+       ++iterator) {
+    RegionEpochs::iterator epochIterator(regionEpochs.find(*iterator));
+    returnValue.push_back(epochIterator == regionEpochs.end() ? 0 : epochIterator->second);
+  }
+
+  return returnValue;
+}
+
+uint64_t QueryResultCache::now() {
+  return uv_hrtime() / 1000000;
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,121 @@
+#ifndef __QUERY_RESULT_CACHE_HPP__
+#define __QUERY_RESULT_CACHE_HPP__
+
+#include <v8.h>
+#include <gfcpp/SharedPtr.hpp>
+#include <gfcpp/SharedBase.hpp>
+#include <gfcpp/SelectResults.hpp>
+#include <uv.h>
+#include <stdint.h>
+#include <tr1/unordered_map>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace node_gemfire {
+
+// Remembers the results of queries, keyed by scope, OQL text and parameters, so that a query that
+// is repeated while its regions don't change is answered without a server round trip.
+//
+// Entries are dropped when an event or a local write reaches one of the regions their query
+// refers to, and at the latest after the ttl. Lookups happen on worker threads, so every operation
+// takes the mutex.
+class QueryResultCache : public gemfire::SharedBase {
+ public:
+  QueryResultCache(uint64_t ttl, unsigned int maxEntries) :
+    SharedBase(),
+    ttl(ttl),
+    maxEntries(maxEntries),
+    clears(0),
+    hits(0),
+    misses(0),
+    invalidations(0),
+    expirations(0),
+    evictions(0) {
+      uv_mutex_init(&mutex);
+    }
+
+  virtual ~QueryResultCache() {
+    uv_mutex_destroy(&mutex);
+  }
+
+  // Called from the main thread. Returns an empty string for parameters other than strings, numbers
+  // and booleans, which can't be told apart reliably and whose results must not be cached.
+  static std::string key(const std::string & scope,
+                         const std::string & queryString,
+                         const v8::Local<v8::Value> & parameters);
+
+  // The full paths of the regions a query refers to, such as "/orders" in
+  // "SELECT * FROM /orders o WHERE o.total > 10".
+  static std::vector<std::string> regionPaths(const std::string & queryString);
+
+  // The epochs of a query's regions when it started, preceded by the number of times the cache has
+  // been cleared.
+  typedef std::vector<uint64_t> Epochs;
+
+  bool get(const std::string & key, gemfire::SelectResultsPtr & selectResultsPtr);
+  Epochs epochs(const std::vector<std::string> & regionPaths);
+  void add(const std::string & key,
+           const std::vector<std::string> & regionPaths,
+           const gemfire::SelectResultsPtr & selectResultsPtr,
+           const Epochs & epochs);
+  void invalidate(const std::string & regionPath);
+  void clear();
+
+  v8::Local<v8::Object> statistics();
+
+  const uint64_t ttl;
+  const unsigned int maxEntries;
+
+ private:
+  class Entry {
+   public:
+    Entry(const std::string & key,
+          const std::vector<std::string> & regionPaths,
+          const gemfire::SelectResultsPtr & selectResultsPtr,
+          uint64_t expiresAt) :
+      key(key),
+      regionPaths(regionPaths),
+      selectResultsPtr(selectResultsPtr),
+      expiresAt(expiresAt) {}
+
+    std::string key;
+    std::vector<std::string> regionPaths;
+    gemfire::SelectResultsPtr selectResultsPtr;
+    uint64_t expiresAt;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::tr1::unordered_map<std::string, EntryList::iterator> EntryIndex;
+  typedef std::tr1::unordered_multimap<std::string, EntryList::iterator> RegionIndex;
+  typedef std::tr1::unordered_map<std::string, uint64_t> RegionEpochs;
+
+  void remove(EntryList::iterator entryIterator);
+  Epochs currentEpochs(const std::vector<std::string> & regionPaths);
+  static uint64_t now();
+
+  uv_mutex_t mutex;
+
+  // Incremented by every invalidation of a region, and by clear() for all of them. A query that
+  // started before an invalidation of one of its regions must not record its results afterwards,
+  // since they may predate the change. Regions that were never invalidated are at epoch 0.
+  uint64_t clears;
+  RegionEpochs regionEpochs;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int invalidations;
+  unsigned int expirations;
+  unsigned int evictions;
+
+  // Most recently used first.
+  EntryList entryList;
+  EntryIndex entryIndex;
+  RegionIndex regionIndex;
+};
+
+typedef gemfire::SharedPtr<QueryResultCache> QueryResultCachePtr;
+
+}  // namespace node_gemfire
+
+#endif
@@ -1,6 +1,7 @@
 #include "region.hpp"
 #include <gfcpp/Region.hpp>
 #include <uv.h>
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -11,6 +12,8 @@
 #include "events.hpp"
 #include "functions.hpp"
 #include "region_event_registry.hpp"
+#include "keyed_work_queue.hpp"
+#include "operation_options.hpp"
 #include "dependencies.hpp"
 
 using namespace v8;
@@ -20,10 +23,18 @@ namespace node_gemfire {
 
 Persistent<Function> Region::constructor;
 
+static const unsigned int defaultMaxEventBatchSize = 1000;
+
 inline bool isFunctionOrUndefined(const Local<Value> & value) {
   return value->IsUndefined() || value->IsFunction();
 }
 
+// Options objects are accepted before the callback, so anything that is an object but not a
+// function is taken to be one.
+inline bool isOptionsObject(const Local<Value> & value) {
+  return value->IsObject() && !value->IsFunction();
+}
+
 inline NanCallback * getCallback(const Local<Value> & value) {
   if (value->IsUndefined()) {
     return NULL;
@@ -38,15 +49,218 @@ Local<Value> Region::New(Local<Object> cacheObject, RegionPtr regionPtr) {
     return NanEscapeScope(NanUndefined());
   }
 
+  // Every lookup of a region returns the same wrapper, so that its listeners and settings are shared
+  // and each event is dispatched to a single object.
+  Region * existingRegion = RegionEventRegistry::getInstance()->find(regionPtr);
+  if (existingRegion != NULL) {
+    return NanEscapeScope(NanObjectWrapHandle(existingRegion));
+  }
+
   Local<Object> regionObject(NanNew(Region::constructor)->NewInstance(0, NULL));
   node_gemfire::Region * region =
     new node_gemfire::Region(regionObject, cacheObject, regionPtr);
 
+  region->Ref();
   RegionEventRegistry::getInstance()->add(region);
 
   return NanEscapeScope(regionObject);
 }
 
+bool Region::hasListeners(const char * eventName) {
+  NanScope();
+
+  // EventEmitter keeps its listeners in _events, keyed by event name.
+  Local<Value> events(NanObjectWrapHandle(this)->Get(NanNew("_events")));
+  if (!events->IsObject()) {
+    return false;
+  }
+
+  Local<Value> listeners(events->ToObject()->Get(NanNew(eventName)));
+  return !(listeners->IsUndefined() || listeners->IsNull());
+}
+
+void Region::updateEventSubscriptions() {
+  unsigned int subscriptions = 0;
+
+  bool watched = (keyWatchers != NULL && !keyWatchers->empty());
+  bool cached = (decodedValueCache != NULL || negativeCachePtr != NULLPTR || queryResultCachePtr != NULLPTR);
+  if (cached || watched) {
+    subscriptions = RegionEventListener::ALL;
+  } else if (maxEventBatchSize > 0) {
+    if (hasListeners("events")) {
+      subscriptions = RegionEventListener::ALL;
+    }
+  } else {
+    if (hasListeners("create")) {
+      subscriptions |= RegionEventListener::CREATE;
+    }
+    if (hasListeners("update")) {
+      subscriptions |= RegionEventListener::UPDATE;
+    }
+    if (hasListeners("destroy")) {
+      subscriptions |= RegionEventListener::DESTROY;
+    }
+  }
+
+  eventListenerPtr->subscriptions = subscriptions;
+
+  bool attach = (subscriptions != 0);
+  if (attach == eventListenerAttached || regionPtr->isDestroyed()) {
+    return;
+  }
+
+  AttributesMutatorPtr attrMutatorPtr(regionPtr->getAttributesMutator());
+  if (attach) {
+    attrMutatorPtr->setCacheListener(eventListenerPtr);
+  } else {
+    attrMutatorPtr->setCacheListener(NULLPTR);
+  }
+  eventListenerAttached = attach;
+}
+
+void Region::unintern() {
+  if (RegionEventRegistry::getInstance()->remove(this)) {
+    Unref();
+  }
+}
+
+Local<Value> Region::decodedValue(const CacheableKeyPtr & keyPtr, const CacheablePtr & valuePtr) {
+  NanEscapableScope();
+
+  if (decodedValueCache == NULL || valuePtr == NULLPTR) {
+    return NanEscapeScope(v8Value(valuePtr));
+  }
+
+  Local<Value> cachedValue(decodedValueCache->get(keyPtr, valuePtr));
+  if (!cachedValue.IsEmpty()) {
+    return NanEscapeScope(cachedValue);
+  }
+
+  TryCatch tryCatch;
+  Local<Value> value(v8Value(valuePtr));
+  if (tryCatch.HasCaught()) {
+    tryCatch.ReThrow();
+    return NanEscapeScope(value);
+  }
+
+  decodedValueCache->set(keyPtr, valuePtr, DecodedValueCache::freeze(value));
+  return NanEscapeScope(value);
+}
+
+void Region::invalidate(const CacheableKeyPtr & keyPtr) {
+  if (decodedValueCache != NULL) {
+    decodedValueCache->invalidate(keyPtr);
+  }
+
+  if (negativeCachePtr != NULLPTR) {
+    negativeCachePtr->invalidate(keyPtr);
+  }
+
+  invalidateQueryResults();
+}
+
+void Region::invalidate(const HashMapOfCacheablePtr & hashMapPtr) {
+  if (hashMapPtr == NULLPTR) {
+    return;
+  }
+
+  if (decodedValueCache != NULL) {
+    for (HashMapOfCacheable::Iterator iterator = hashMapPtr->begin();
+         iterator != hashMapPtr->end();
+         iterator++) {
+      decodedValueCache->invalidate(iterator.first());
+    }
+  }
+
+  if (negativeCachePtr != NULLPTR) {
+    negativeCachePtr->invalidate(hashMapPtr);
+  }
+
+  invalidateQueryResults();
+}
+
+void Region::invalidate(const VectorOfCacheableKeyPtr & keysPtr) {
+  if (keysPtr == NULLPTR) {
+    return;
+  }
+
+  for (VectorOfCacheableKey::Iterator iterator(keysPtr->begin());
+       iterator != keysPtr->end();
+       ++iterator) {
+    invalidate(*iterator);
+  }
+}
+
+void Region::invalidateAll() {
+  if (decodedValueCache != NULL) {
+    decodedValueCache->clear();
+  }
+
+  invalidateQueryResults();
+}
+
+void Region::invalidateQueryResults() {
+  if (queryResultCachePtr != NULLPTR) {
+    queryResultCachePtr->invalidate(regionPtr->getFullPath());
+  }
+}
+
+CacheablePtr Region::bufferedValue(const CacheableKeyPtr & keyPtr) {
+  if (writeBehindBuffer == NULL || keyPtr == NULLPTR) {
+    return NULLPTR;
+  }
+
+  return writeBehindBuffer->get(keyPtr);
+}
+
+void Region::applyBufferedValues(const VectorOfCacheableKeyPtr & keysPtr,
+                                 const HashMapOfCacheablePtr & resultsPtr) {
+  if (writeBehindBuffer == NULL || keysPtr == NULLPTR) {
+    return;
+  }
+
+  for (VectorOfCacheableKey::Iterator iterator(keysPtr->begin());
+       iterator != keysPtr->end();
+       ++iterator) {
+    CacheablePtr valuePtr(writeBehindBuffer->get(*iterator));
+    if (valuePtr != NULLPTR) {
+      resultsPtr->erase(*iterator);
+      resultsPtr->insert(*iterator, valuePtr);
+    }
+  }
+}
+
+bool Region::queueWorker(const Local<Object> & regionObject,
+                         GemfireWorker * worker,
+                         const CacheableKeyPtr & keyPtr) {
+  KeyedWorkQueue::Keys keys;
+  if (keyPtr != NULLPTR) {
+    keys.push_back(keyPtr);
+  }
+
+  return queueWorker(regionObject, worker, keys);
+}
+
+bool Region::queueWorker(const Local<Object> & regionObject,
+                         GemfireWorker * worker,
+                         const KeyedWorkQueue::Keys & keys) {
+  NanScope();
+
+  LimitedWork * work = new LimitedWork(worker, regionPtr, keys);
+
+  if (limiterPtr != NULLPTR) {
+    work->addLimiter(limiterPtr, regionObject);
+  }
+
+  Local<Object> cacheObject(NanNew(cacheHandle));
+  Cache * cache = ObjectWrap::Unwrap<Cache>(cacheObject);
+  if (cache->limiterPtr != NULLPTR) {
+    work->addLimiter(cache->limiterPtr, cacheObject);
+  }
+
+  return work->start();
+}
+
 class GemfireEventedWorker : public GemfireWorker {
  public:
   GemfireEventedWorker(
@@ -80,9 +294,11 @@ class ClearWorker : public GemfireEventedWorker {
   ClearWorker(
     const Local<Object> & regionObject,
     Region * region,
+    const KeyedWorkQueue::Keys & keys,
     NanCallback * callback) :
       GemfireEventedWorker(regionObject, callback),
-      region(region) {}
+      region(region),
+      keys(keys) {}
 
   void ExecuteGemfireWork() {
     // Workaround: We don't want to call clear on the region if the cache is closed.
@@ -92,7 +308,13 @@ class ClearWorker : public GemfireEventedWorker {
     region->regionPtr->clear();
   }
 
+  void WorkComplete() {
+    GemfireEventedWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(region->regionPtr, keys);
+  }
+
   Region * region;
+  KeyedWorkQueue::Keys keys;
 };
 
 NAN_METHOD(Region::Clear) {
@@ -104,10 +326,20 @@ NAN_METHOD(Region::Clear) {
   }
 
   Region * region = ObjectWrap::Unwrap<Region>(args.This());
+  region->invalidateAll();
+
+  // The clear waits for the keys of a flush in flight, which would otherwise write them back after it.
+  KeyedWorkQueue::Keys keys;
+  if (region->writeBehindBuffer != NULL) {
+    region->writeBehindBuffer->clear();
+    keys = region->writeBehindBuffer->keysInFlight();
+  }
 
   NanCallback * callback = getCallback(args[0]);
-  ClearWorker * worker = new ClearWorker(args.This(), region, callback);
-  NanAsyncQueueWorker(worker);
+  ClearWorker * worker = new ClearWorker(args.This(), region, keys, callback);
+  if (!region->queueWorker(args.This(), worker, keys)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -156,6 +388,11 @@ class PutWorker : public GemfireEventedWorker {
     region->regionPtr->put(keyPtr, valuePtr);
   }
 
+  void WorkComplete() {
+    GemfireEventedWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(region->regionPtr, keyPtr);
+  }
+
   Region * region;
   CacheableKeyPtr keyPtr;
   CacheablePtr valuePtr;
@@ -170,7 +407,17 @@ NAN_METHOD(Region::Put) {
     NanThrowError("You must pass a key and value to put().");
     NanReturnUndefined();
   }
-  if (!isFunctionOrUndefined(args[2])) {
+
+  OperationOptions operationOptions;
+  int callbackIndex = 2;
+  if (isOptionsObject(args[2])) {
+    if (!operationOptions.parse(args[2], "put()")) {
+      NanReturnUndefined();
+    }
+    callbackIndex = 3;
+  }
+
+  if (!isFunctionOrUndefined(args[callbackIndex])) {
     NanThrowError("You must pass a function as the callback to put().");
     NanReturnUndefined();
   }
@@ -182,12 +429,32 @@ NAN_METHOD(Region::Put) {
     NanReturnUndefined();
   }
 
+  // Buffered puts are written in batches, which a timeout or cancel token of one put can't stop.
+  if (region->writeBehindBuffer != NULL && !operationOptions.empty()) {
+    NanThrowError("put: timeout and cancelToken can't be used while write-behind is enabled.");
+    NanReturnUndefined();
+  }
+
   CacheableKeyPtr keyPtr(gemfireKey(args[0], cachePtr));
   CacheablePtr valuePtr(gemfireValue(args[1], cachePtr));
 
-  NanCallback * callback = getCallback(args[2]);
+  if (keyPtr != NULLPTR) {
+    region->invalidate(keyPtr);
+  }
+
+  NanCallback * callback = getCallback(args[callbackIndex]);
+
+  // Invalid keys and values still go through PutWorker, which reports them.
+  if (region->writeBehindBuffer != NULL && keyPtr != NULLPTR && valuePtr != NULLPTR) {
+    region->writeBehindBuffer->put(args.This(), keyPtr, valuePtr, callback);
+    NanReturnValue(args.This());
+  }
+
   PutWorker * putWorker = new PutWorker(args.This(), region, keyPtr, valuePtr, callback);
-  NanAsyncQueueWorker(putWorker);
+  putWorker->setOperationOptions(operationOptions);
+  if (!region->queueWorker(args.This(), putWorker, keyPtr)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -221,18 +488,69 @@ NAN_METHOD(Region::PutSync) {
     NanThrowError("Invalid GemFire value.");
     NanReturnUndefined();
   }
+
+  region->invalidate(keyPtr);
+
+  if (region->writeBehindBuffer != NULL) {
+    region->writeBehindBuffer->remove(keyPtr);
+  }
+
   region->regionPtr->put(keyPtr, valuePtr);
   NanReturnValue(args.This());
 }
 
+class GetLoadWaiter : public LoadWaiter {
+ public:
+  GetLoadWaiter(NanCallback * callback, bool undefinedOnMiss) :
+    callback(callback),
+    undefinedOnMiss(undefinedOnMiss) {}
+
+  ~GetLoadWaiter() {
+    delete callback;
+  }
+
+  void loaded(const CacheableKeyPtr & keyPtr, const Local<Value> & error, const Local<Value> & value) {
+    NanScope();
+
+    static const int argc = 2;
+
+    if (!error->IsUndefined()) {
+      Local<Value> argv[argc] = { error, NanUndefined() };
+      callback->Call(argc, argv);
+    } else if (!value.IsEmpty()) {
+      Local<Value> argv[argc] = { NanUndefined(), value };
+      callback->Call(argc, argv);
+    } else if (undefinedOnMiss) {
+      Local<Value> argv[argc] = { NanUndefined(), NanUndefined() };
+      callback->Call(argc, argv);
+    } else {
+      Local<Value> argv[argc] = { v8Error("KeyNotFoundError", "Key not found in region."), NanUndefined() };
+      callback->Call(argc, argv);
+    }
+
+    delete this;
+  }
+
+ private:
+  NanCallback * callback;
+  bool undefinedOnMiss;
+};
+
 class GetWorker : public GemfireWorker {
  public:
   GetWorker(NanCallback * callback,
-           const RegionPtr & regionPtr,
+           const Local<Object> & regionObject,
+           Region * region,
            const CacheableKeyPtr & keyPtr) :
       GemfireWorker(callback),
-      regionPtr(regionPtr),
-      keyPtr(keyPtr) {}
+      region(region),
+      regionPtr(region->regionPtr),
+      negativeCachePtr(region->negativeCachePtr),
+      keyPtr(keyPtr),
+      valuePtr(region->bufferedValue(keyPtr)),
+      missed(false) {
+        SaveToPersistent("regionObject", regionObject);
+      }
 
   void ExecuteGemfireWork() {
     if (keyPtr == NULLPTR) {
@@ -240,9 +558,25 @@ class GetWorker : public GemfireWorker {
       return;
     }
 
-    valuePtr = regionPtr->get(keyPtr);
+    // Found in the write-behind buffer.
+    if (valuePtr != NULLPTR) {
+      return;
+    }
 
-    if (valuePtr == NULLPTR) {
+    if (negativeCachePtr == NULLPTR) {
+      valuePtr = regionPtr->get(keyPtr);
+    } else if (!negativeCachePtr->contains(keyPtr)) {
+      uint64_t epoch = negativeCachePtr->epoch(keyPtr);
+      valuePtr = regionPtr->get(keyPtr);
+
+      if (valuePtr == NULLPTR) {
+        negativeCachePtr->add(keyPtr, epoch);
+      }
+    }
+
+    missed = (valuePtr == NULLPTR);
+
+    if (missed && !undefinedOnMiss()) {
       SetError("KeyNotFoundError", "Key not found in region.");
     }
   }
@@ -250,14 +584,58 @@ class GetWorker : public GemfireWorker {
   void HandleOKCallback() {
     NanScope();
 
+    if (missed && load()) {
+      return;
+    }
+
     static const int argc = 2;
-    Local<Value> argv[argc] = { NanUndefined(), v8Value(valuePtr) };
+
+    if (valuePtr == NULLPTR) {
+      Local<Value> argv[argc] = { NanUndefined(), NanUndefined() };
+      callback->Call(argc, argv);
+      return;
+    }
+
+    if (region->loader->enabled()) {
+      region->loader->hit();
+    }
+
+    Local<Value> argv[argc] = { NanUndefined(), region->decodedValue(keyPtr, valuePtr) };
     callback->Call(argc, argv);
   }
 
+  void HandleErrorCallback() {
+    NanScope();
+
+    if (missed && load()) {
+      return;
+    }
+
+    GemfireWorker::HandleErrorCallback();
+  }
+
+ private:
+  bool undefinedOnMiss() {
+    return negativeCachePtr != NULLPTR && negativeCachePtr->undefinedOnMiss;
+  }
+
+  // Hands the callback over to the region's loader, if it has one.
+  bool load() {
+    if (!region->loader->enabled()) {
+      return false;
+    }
+
+    region->loader->load(keyPtr, new GetLoadWaiter(callback, undefinedOnMiss()));
+    callback = NULL;
+    return true;
+  }
+
+  Region * region;
   RegionPtr regionPtr;
+  NegativeCachePtr negativeCachePtr;
   CacheableKeyPtr keyPtr;
   CacheablePtr valuePtr;
+  bool missed;
 };
 
 NAN_METHOD(Region::Get) {
@@ -265,16 +643,22 @@ NAN_METHOD(Region::Get) {
 
   unsigned int argsLength = args.Length();
 
-  if (argsLength != 2) {
+  if (argsLength != 2 && argsLength != 3) {
     NanThrowError("You must pass a key and a callback to get().");
     NanReturnUndefined();
   }
 
-  if (!args[1]->IsFunction()) {
+  Local<Value> callbackFunction(args[argsLength - 1]);
+  if (!callbackFunction->IsFunction()) {
     NanThrowError("You must pass a function as the callback to get().");
     NanReturnUndefined();
   }
 
+  OperationOptions operationOptions;
+  if (argsLength == 3 && !operationOptions.parse(args[1], "get()")) {
+    NanReturnUndefined();
+  }
+
   Region * region = ObjectWrap::Unwrap<Region>(args.This());
   RegionPtr regionPtr(region->regionPtr);
 
@@ -285,9 +669,12 @@ NAN_METHOD(Region::Get) {
 
   CacheableKeyPtr keyPtr(gemfireKey(args[0], cachePtr));
 
-  NanCallback * callback = new NanCallback(args[1].As<Function>());
-  GetWorker * getWorker = new GetWorker(callback, regionPtr, keyPtr);
-  NanAsyncQueueWorker(getWorker);
+  NanCallback * callback = new NanCallback(callbackFunction.As<Function>());
+  GetWorker * getWorker = new GetWorker(callback, args.This(), region, keyPtr);
+  getWorker->setOperationOptions(operationOptions);
+  if (!region->queueWorker(args.This(), getWorker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -311,24 +698,91 @@ NAN_METHOD(Region::GetSync) {
   }
 
   CacheableKeyPtr keyPtr(gemfireKey(args[0], cachePtr));
-  CacheablePtr valuePtr = regionPtr->get(keyPtr);
+  NegativeCachePtr negativeCachePtr(region->negativeCachePtr);
+  CacheablePtr valuePtr(region->bufferedValue(keyPtr));
+
+  if (valuePtr != NULLPTR) {
+    NanReturnValue(region->decodedValue(keyPtr, valuePtr));
+  }
+
+  if (negativeCachePtr == NULLPTR || keyPtr == NULLPTR) {
+    valuePtr = regionPtr->get(keyPtr);
+  } else if (!negativeCachePtr->contains(keyPtr)) {
+    uint64_t epoch = negativeCachePtr->epoch(keyPtr);
+    valuePtr = regionPtr->get(keyPtr);
+
+    if (valuePtr == NULLPTR) {
+      negativeCachePtr->add(keyPtr, epoch);
+    }
+  }
 
   if (valuePtr == NULLPTR) {
-    NanThrowError("Key not found in region.");
+    if (negativeCachePtr == NULLPTR || !negativeCachePtr->undefinedOnMiss) {
+      NanThrowError("Key not found in region.");
+    }
+    NanReturnUndefined();
   }
 
-  NanReturnValue(v8Value(valuePtr));
+  NanReturnValue(region->decodedValue(keyPtr, valuePtr));
 }
 
+class GetAllLoadWaiter : public LoadWaiter {
+ public:
+  GetAllLoadWaiter(NanCallback * callback, const Local<Object> & results, unsigned int remaining) :
+    callback(callback),
+    remaining(remaining) {
+      NanAssignPersistent(this->results, results);
+    }
+
+  ~GetAllLoadWaiter() {
+    NanDisposePersistent(results);
+    NanDisposePersistent(error);
+    delete callback;
+  }
+
+  void loaded(const CacheableKeyPtr & keyPtr, const Local<Value> & error, const Local<Value> & value) {
+    NanScope();
+
+    if (!error->IsUndefined() && this->error.IsEmpty()) {
+      NanAssignPersistent(this->error, error);
+    }
+
+    NanNew(results)->Set(v8Value(keyPtr), value.IsEmpty() ? NanNull() : value);
+
+    if (--remaining > 0) {
+      return;
+    }
+
+    static const int argc = 2;
+    Local<Value> argv[argc] = {
+      this->error.IsEmpty() ? NanUndefined() : NanNew(this->error),
+      NanNew(results)
+    };
+    callback->Call(argc, argv);
+
+    delete this;
+  }
+
+ private:
+  NanCallback * callback;
+  Persistent<Object> results;
+  Persistent<Value> error;
+  unsigned int remaining;
+};
+
 class GetAllWorker : public GemfireWorker {
  public:
   GetAllWorker(
-      const RegionPtr & regionPtr,
+      const Local<Object> & regionObject,
+      Region * region,
       const VectorOfCacheableKeyPtr & gemfireKeysPtr,
       NanCallback * callback) :
     GemfireWorker(callback),
-    regionPtr(regionPtr),
-    gemfireKeysPtr(gemfireKeysPtr) {}
+    region(region),
+    regionPtr(region->regionPtr),
+    gemfireKeysPtr(gemfireKeysPtr) {
+      SaveToPersistent("regionObject", regionObject);
+    }
 
   void ExecuteGemfireWork() {
     resultsPtr = new HashMapOfCacheable();
@@ -348,12 +802,44 @@ class GetAllWorker : public GemfireWorker {
   void HandleOKCallback() {
     NanScope();
 
-    static const int argc = 2;
-    Local<Value> argv[argc] = { NanUndefined(), v8Value(resultsPtr) };
-    callback->Call(argc, argv);
+    region->applyBufferedValues(gemfireKeysPtr, resultsPtr);
+
+    Local<Object> results(v8Value(resultsPtr));
+    std::vector<CacheableKeyPtr> missingKeys;
+
+    Loader * loader = region->loader;
+    if (loader->enabled()) {
+      for (VectorOfCacheableKey::Iterator iterator(gemfireKeysPtr->begin());
+           iterator != gemfireKeysPtr->end();
+           ++iterator) {
+        HashMapOfCacheable::Iterator found(resultsPtr->find(*iterator));
+        if (found == resultsPtr->end() || found.second() == NULLPTR) {
+          missingKeys.push_back(*iterator);
+        } else {
+          loader->hit();
+        }
+      }
+    }
+
+    if (missingKeys.empty()) {
+      static const int argc = 2;
+      Local<Value> argv[argc] = { NanUndefined(), results };
+      callback->Call(argc, argv);
+      return;
+    }
+
+    GetAllLoadWaiter * waiter = new GetAllLoadWaiter(callback, results, missingKeys.size());
+    callback = NULL;
+
+    for (std::vector<CacheableKeyPtr>::iterator iterator(missingKeys.begin());
+         iterator != missingKeys.end();
+         ++iterator) {
+      loader->load(*iterator, waiter);
+    }
   }
 
  private:
+  Region * region;
   RegionPtr regionPtr;
   VectorOfCacheableKeyPtr gemfireKeysPtr;
   HashMapOfCacheablePtr resultsPtr;
@@ -372,7 +858,16 @@ NAN_METHOD(Region::GetAll) {
     NanReturnUndefined();
   }
 
-  if (!args[1]->IsFunction()) {
+  OperationOptions operationOptions;
+  int callbackIndex = 1;
+  if (args.Length() > 2 && isOptionsObject(args[1])) {
+    if (!operationOptions.parse(args[1], "getAll()")) {
+      NanReturnUndefined();
+    }
+    callbackIndex = 2;
+  }
+
+  if (!args[callbackIndex]->IsFunction()) {
     NanThrowError("You must pass a function as the callback to getAll().");
     NanReturnUndefined();
   }
@@ -387,10 +882,13 @@ NAN_METHOD(Region::GetAll) {
 
   VectorOfCacheableKeyPtr gemfireKeysPtr(gemfireKeys(Local<Array>::Cast(args[0]), cachePtr));
 
-  NanCallback * callback = new NanCallback(args[1].As<Function>());
+  NanCallback * callback = new NanCallback(args[callbackIndex].As<Function>());
 
-  GetAllWorker * worker = new GetAllWorker(regionPtr, gemfireKeysPtr, callback);
-  NanAsyncQueueWorker(worker);
+  GetAllWorker * worker = new GetAllWorker(args.This(), region, gemfireKeysPtr, callback);
+  worker->setOperationOptions(operationOptions);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -424,6 +922,8 @@ NAN_METHOD(Region::GetAllSync) {
   }
 
   regionPtr->getAll(*gemfireKeysPtr, resultsPtr, NULLPTR);
+  region->applyBufferedValues(gemfireKeysPtr, resultsPtr);
+
   NanReturnValue(v8Value(resultsPtr));
 }
 
@@ -433,10 +933,12 @@ class PutAllWorker : public GemfireEventedWorker {
       const Local<Object> & regionObject,
       const RegionPtr & regionPtr,
       const HashMapOfCacheablePtr & hashMapPtr,
+      const KeyedWorkQueue::Keys & keys,
       NanCallback * callback) :
     GemfireEventedWorker(regionObject, callback),
     regionPtr(regionPtr),
-    hashMapPtr(hashMapPtr) { }
+    hashMapPtr(hashMapPtr),
+    keys(keys) { }
 
   void ExecuteGemfireWork() {
     if (hashMapPtr == NULLPTR) {
@@ -447,9 +949,15 @@ class PutAllWorker : public GemfireEventedWorker {
     regionPtr->putAll(*hashMapPtr);
   }
 
+  void WorkComplete() {
+    GemfireEventedWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(regionPtr, keys);
+  }
+
  private:
   RegionPtr regionPtr;
   HashMapOfCacheablePtr hashMapPtr;
+  KeyedWorkQueue::Keys keys;
 };
 
 NAN_METHOD(Region::PutAll) {
@@ -460,7 +968,16 @@ NAN_METHOD(Region::PutAll) {
     NanReturnUndefined();
   }
 
-  if (!isFunctionOrUndefined(args[1])) {
+  OperationOptions operationOptions;
+  int callbackIndex = 1;
+  if (isOptionsObject(args[1])) {
+    if (!operationOptions.parse(args[1], "putAll()")) {
+      NanReturnUndefined();
+    }
+    callbackIndex = 2;
+  }
+
+  if (!isFunctionOrUndefined(args[callbackIndex])) {
     NanThrowError("You must pass a function as the callback to putAll().");
     NanReturnUndefined();
   }
@@ -474,9 +991,28 @@ NAN_METHOD(Region::PutAll) {
   }
 
   HashMapOfCacheablePtr hashMapPtr(gemfireHashMap(args[0]->ToObject(), cachePtr));
-  NanCallback * callback = getCallback(args[1]);
-  PutAllWorker * worker = new PutAllWorker(args.This(), regionPtr, hashMapPtr, callback);
-  NanAsyncQueueWorker(worker);
+  region->invalidate(hashMapPtr);
+
+  if (region->writeBehindBuffer != NULL) {
+    region->writeBehindBuffer->remove(hashMapPtr);
+  }
+
+  // Like a put, the putAll waits for earlier writes of each of its keys.
+  KeyedWorkQueue::Keys keys;
+  if (hashMapPtr != NULLPTR) {
+    for (HashMapOfCacheable::Iterator iterator = hashMapPtr->begin();
+         iterator != hashMapPtr->end();
+         iterator++) {
+      keys.push_back(iterator.first());
+    }
+  }
+
+  NanCallback * callback = getCallback(args[callbackIndex]);
+  PutAllWorker * worker = new PutAllWorker(args.This(), regionPtr, hashMapPtr, keys, callback);
+  worker->setOperationOptions(operationOptions);
+  if (!region->queueWorker(args.This(), worker, keys)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -502,6 +1038,13 @@ NAN_METHOD(Region::PutAllSync) {
     NanThrowError("Invalid GemFire value.");
     NanReturnUndefined();
   }
+
+  region->invalidate(hashMapPtr);
+
+  if (region->writeBehindBuffer != NULL) {
+    region->writeBehindBuffer->remove(hashMapPtr);
+  }
+
   regionPtr->putAll(*hashMapPtr);
 
   NanReturnValue(args.This());
@@ -531,60 +1074,348 @@ class RemoveWorker : public GemfireEventedWorker {
     }
   }
 
-  RegionPtr regionPtr;
-  CacheableKeyPtr keyPtr;
-};
+  void WorkComplete() {
+    GemfireEventedWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(regionPtr, keyPtr);
+  }
+
+  RegionPtr regionPtr;
+  CacheableKeyPtr keyPtr;
+};
+
+NAN_METHOD(Region::Remove) {
+  NanScope();
+
+  if (args.Length() < 1) {
+    NanThrowError("You must pass a key to remove().");
+    NanReturnUndefined();
+  }
+
+  OperationOptions operationOptions;
+  int callbackIndex = 1;
+  if (isOptionsObject(args[1])) {
+    if (!operationOptions.parse(args[1], "remove()")) {
+      NanReturnUndefined();
+    }
+    callbackIndex = 2;
+  }
+
+  if (!isFunctionOrUndefined(args[callbackIndex])) {
+    NanThrowError("You must pass a function as the callback to remove().");
+    NanReturnUndefined();
+  }
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+  RegionPtr regionPtr(region->regionPtr);
+
+  CachePtr cachePtr(getCacheFromRegion(region->regionPtr));
+  if (cachePtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  CacheableKeyPtr keyPtr(gemfireKey(args[0], cachePtr));
+  if (keyPtr != NULLPTR) {
+    region->invalidate(keyPtr);
+
+    if (region->writeBehindBuffer != NULL) {
+      region->writeBehindBuffer->remove(keyPtr);
+    }
+  }
+
+  NanCallback * callback = getCallback(args[callbackIndex]);
+  RemoveWorker * worker = new RemoveWorker(args.This(), regionPtr, keyPtr, callback);
+  worker->setOperationOptions(operationOptions);
+  if (!region->queueWorker(args.This(), worker, keyPtr)) {
+    NanReturnUndefined();
+  }
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::ExecuteFunction) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+  RegionPtr regionPtr(region->regionPtr);
+
+  CachePtr cachePtr(getCacheFromRegion(region->regionPtr));
+  if (cachePtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  try {
+    ExecutionPtr executionPtr(FunctionService::onRegion(regionPtr));
+    NanReturnValue(executeFunction(args, cachePtr, executionPtr));
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+}
+
+NAN_METHOD(Region::SetValueCache) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    delete region->decodedValueCache;
+    region->decodedValueCache = NULL;
+    region->updateEventSubscriptions();
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setValueCache().");
+    NanReturnUndefined();
+  }
+
+  // Cached values are validated against the value the region holds locally, so a region that
+  // doesn't cache locally would return a new GemFire value for every read and never hit.
+  if (!region->regionPtr->getAttributes()->getCachingEnabled()) {
+    NanThrowError("setValueCache: The region must cache values locally.");
+    NanReturnUndefined();
+  }
+
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> maxEntries(optionsObject->Get(NanNew("maxEntries")));
+  Local<Value> maxBytes(optionsObject->Get(NanNew("maxBytes")));
+
+  if (!maxEntries->IsUndefined() && !(maxEntries->IsUint32() && maxEntries->Uint32Value() > 0)) {
+    NanThrowError("setValueCache: maxEntries must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  if (!maxBytes->IsUndefined() && !(maxBytes->IsUint32() && maxBytes->Uint32Value() > 0)) {
+    NanThrowError("setValueCache: maxBytes must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  if (maxEntries->IsUndefined() && maxBytes->IsUndefined()) {
+    NanThrowError("setValueCache: You must pass maxEntries, maxBytes or both.");
+    NanReturnUndefined();
+  }
+
+  delete region->decodedValueCache;
+  region->decodedValueCache = new DecodedValueCache(
+      maxEntries->IsUndefined() ? 0 : maxEntries->Uint32Value(),
+      maxBytes->IsUndefined() ? 0 : maxBytes->Uint32Value());
+  region->updateEventSubscriptions();
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::SetNegativeCache) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    region->negativeCachePtr = NULLPTR;
+    region->updateEventSubscriptions();
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setNegativeCache().");
+    NanReturnUndefined();
+  }
+
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> ttl(optionsObject->Get(NanNew("ttl")));
+  Local<Value> maxEntries(optionsObject->Get(NanNew("maxEntries")));
+  Local<Value> undefinedOnMiss(optionsObject->Get(NanNew("undefinedOnMiss")));
+
+  if (!(ttl->IsUint32() && ttl->Uint32Value() > 0)) {
+    NanThrowError("setNegativeCache: ttl must be a positive number of milliseconds.");
+    NanReturnUndefined();
+  }
+
+  if (!(maxEntries->IsUint32() && maxEntries->Uint32Value() > 0)) {
+    NanThrowError("setNegativeCache: maxEntries must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  if (!undefinedOnMiss->IsUndefined() && !undefinedOnMiss->IsBoolean()) {
+    NanThrowError("setNegativeCache: undefinedOnMiss must be true or false.");
+    NanReturnUndefined();
+  }
+
+  region->negativeCachePtr = new NegativeCache(ttl->Uint32Value(),
+                                               maxEntries->Uint32Value(),
+                                               undefinedOnMiss->IsTrue());
+  region->updateEventSubscriptions();
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::SetLoader) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (args.Length() == 0 || !(args[0]->IsFunction() || args[0]->IsNull())) {
+    NanThrowError("You must pass a function or null to setLoader().");
+    NanReturnUndefined();
+  }
+
+  region->loader->setFunction(args[0]);
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::SetWriteBehind) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    if (region->writeBehindBuffer != NULL) {
+      region->writeBehindBuffer->close();
+      region->writeBehindBuffer = NULL;
+    }
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setWriteBehind().");
+    NanReturnUndefined();
+  }
+
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> interval(optionsObject->Get(NanNew("interval")));
+  Local<Value> maxEntries(optionsObject->Get(NanNew("maxEntries")));
+
+  if (!(interval->IsUint32() && interval->Uint32Value() > 0)) {
+    NanThrowError("setWriteBehind: interval must be a positive number of milliseconds.");
+    NanReturnUndefined();
+  }
+
+  if (!(maxEntries->IsUint32() && maxEntries->Uint32Value() > 0)) {
+    NanThrowError("setWriteBehind: maxEntries must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  // Puts buffered under the previous settings are flushed in the background.
+  if (region->writeBehindBuffer != NULL) {
+    region->writeBehindBuffer->close();
+  }
+
+  region->writeBehindBuffer = new WriteBehindBuffer(region->regionPtr,
+                                                    interval->Uint32Value(),
+                                                    maxEntries->Uint32Value());
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::Flush) {
+  NanScope();
+
+  if (!isFunctionOrUndefined(args[0])) {
+    NanThrowError("You must pass a function as the callback to flush().");
+    NanReturnUndefined();
+  }
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (region->writeBehindBuffer == NULL) {
+    NanThrowError("You must enable write-behind with setWriteBehind() before calling flush().");
+    NanReturnUndefined();
+  }
+
+  region->writeBehindBuffer->flush(args.This(), getCallback(args[0]));
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::SetLimits) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  // Operations admitted under the previous limits still release them when they complete.
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    region->limiterPtr = NULLPTR;
+    NanReturnValue(args.This());
+  }
+
+  WorkLimiterPtr limiterPtr;
+  if (!WorkLimiter::parse(args[0], "region", limiterPtr)) {
+    NanReturnUndefined();
+  }
+
+  region->limiterPtr = limiterPtr;
 
-NAN_METHOD(Region::Remove) {
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::SetEventOptions) {
   NanScope();
 
-  if (args.Length() < 1) {
-    NanThrowError("You must pass a key to remove().");
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  if (args.Length() == 0 || args[0]->IsNull() || args[0]->IsUndefined() || args[0]->IsFalse()) {
+    region->maxEventBatchSize = 0;
+    region->conflateEvents = false;
+    region->eventListenerPtr->withOldValues = true;
+    region->updateEventSubscriptions();
+    NanReturnValue(args.This());
+  }
+
+  if (!args[0]->IsObject()) {
+    NanThrowError("You must pass an options object or null to setEventOptions().");
     NanReturnUndefined();
   }
 
-  if (!isFunctionOrUndefined(args[1])) {
-    NanThrowError("You must pass a function as the callback to remove().");
+  Local<Object> optionsObject(args[0]->ToObject());
+  Local<Value> batch(optionsObject->Get(NanNew("batch")));
+  Local<Value> maxBatchSize(optionsObject->Get(NanNew("maxBatchSize")));
+  Local<Value> conflate(optionsObject->Get(NanNew("conflate")));
+  Local<Value> oldValues(optionsObject->Get(NanNew("oldValues")));
+
+  if (!batch->IsUndefined() && !batch->IsBoolean()) {
+    NanThrowError("setEventOptions: batch must be true or false.");
     NanReturnUndefined();
   }
 
-  Region * region = ObjectWrap::Unwrap<Region>(args.This());
-  RegionPtr regionPtr(region->regionPtr);
+  if (!conflate->IsUndefined() && !conflate->IsBoolean()) {
+    NanThrowError("setEventOptions: conflate must be true or false.");
+    NanReturnUndefined();
+  }
 
-  CachePtr cachePtr(getCacheFromRegion(region->regionPtr));
-  if (cachePtr == NULLPTR) {
+  if (!oldValues->IsUndefined() && !oldValues->IsBoolean()) {
+    NanThrowError("setEventOptions: oldValues must be true or false.");
     NanReturnUndefined();
   }
 
-  CacheableKeyPtr keyPtr(gemfireKey(args[0], cachePtr));
-  NanCallback * callback = getCallback(args[1]);
-  RemoveWorker * worker = new RemoveWorker(args.This(), regionPtr, keyPtr, callback);
-  NanAsyncQueueWorker(worker);
+  if (!maxBatchSize->IsUndefined() && !(maxBatchSize->IsUint32() && maxBatchSize->Uint32Value() > 0)) {
+    NanThrowError("setEventOptions: maxBatchSize must be a positive integer.");
+    NanReturnUndefined();
+  }
+
+  if (!batch->IsTrue()) {
+    region->maxEventBatchSize = 0;
+  } else if (maxBatchSize->IsUndefined()) {
+    region->maxEventBatchSize = defaultMaxEventBatchSize;
+  } else {
+    region->maxEventBatchSize = maxBatchSize->Uint32Value();
+  }
+
+  region->conflateEvents = conflate->IsTrue();
+  region->eventListenerPtr->withOldValues = !oldValues->IsFalse();
+  region->updateEventSubscriptions();
 
   NanReturnValue(args.This());
 }
 
-NAN_METHOD(Region::ExecuteFunction) {
+NAN_METHOD(Region::UpdateEventSubscriptions) {
   NanScope();
 
   Region * region = ObjectWrap::Unwrap<Region>(args.This());
-  RegionPtr regionPtr(region->regionPtr);
+  region->updateEventSubscriptions();
 
-  CachePtr cachePtr(getCacheFromRegion(region->regionPtr));
-  if (cachePtr == NULLPTR) {
-    NanReturnUndefined();
-  }
-
-  try {
-    ExecutionPtr executionPtr(FunctionService::onRegion(regionPtr));
-    NanReturnValue(executeFunction(args, cachePtr, executionPtr));
-  } catch (const gemfire::Exception & exception) {
-    ThrowGemfireException(exception);
-    NanReturnUndefined();
-  }
+  NanReturnUndefined();
 }
 
-
 NAN_METHOD(Region::Inspect) {
   NanScope();
 
@@ -687,6 +1518,77 @@ NAN_GETTER(Region::Attributes) {
   NanReturnValue(returnValue);
 }
 
+NAN_GETTER(Region::Statistics) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  Local<Object> returnValue(NanNew<Object>());
+
+  if (region->decodedValueCache == NULL) {
+    returnValue->Set(NanNew("valueCache"), NanNull());
+  } else {
+    returnValue->Set(NanNew("valueCache"), region->decodedValueCache->statistics());
+  }
+
+  if (region->negativeCachePtr == NULLPTR) {
+    returnValue->Set(NanNew("negativeCache"), NanNull());
+  } else {
+    returnValue->Set(NanNew("negativeCache"), region->negativeCachePtr->statistics());
+  }
+
+  if (!region->loader->enabled()) {
+    returnValue->Set(NanNew("loader"), NanNull());
+  } else {
+    returnValue->Set(NanNew("loader"), region->loader->statistics());
+  }
+
+  if (region->writeBehindBuffer == NULL) {
+    returnValue->Set(NanNew("writeBehind"), NanNull());
+  } else {
+    returnValue->Set(NanNew("writeBehind"), region->writeBehindBuffer->statistics());
+  }
+
+  bool withOldValues = region->eventListenerPtr->withOldValues;
+  if (region->maxEventBatchSize == 0 && !region->conflateEvents && withOldValues) {
+    returnValue->Set(NanNew("events"), NanNull());
+  } else {
+    Local<Object> events(NanNew<Object>());
+    events->Set(NanNew("maxBatchSize"), NanNew(region->maxEventBatchSize));
+    events->Set(NanNew("conflate"), NanNew(region->conflateEvents));
+    events->Set(NanNew("oldValues"), NanNew(withOldValues));
+    events->Set(NanNew("conflated"), NanNew(region->conflatedEvents));
+    returnValue->Set(NanNew("events"), events);
+  }
+
+  if (region->keyWatchers == NULL || region->keyWatchers->empty()) {
+    returnValue->Set(NanNew("watchers"), NanNull());
+  } else {
+    returnValue->Set(NanNew("watchers"), region->keyWatchers->statistics());
+  }
+
+  if (region->limiterPtr == NULLPTR) {
+    returnValue->Set(NanNew("limits"), NanNull());
+  } else {
+    returnValue->Set(NanNew("limits"), region->limiterPtr->statistics());
+  }
+
+  unsigned int subscriptions = region->eventListenerAttached ? region->eventListenerPtr->subscriptions : 0;
+  Local<Array> subscribedEvents(NanNew<Array>());
+  if (subscriptions & RegionEventListener::CREATE) {
+    subscribedEvents->Set(subscribedEvents->Length(), NanNew("create"));
+  }
+  if (subscriptions & RegionEventListener::UPDATE) {
+    subscribedEvents->Set(subscribedEvents->Length(), NanNew("update"));
+  }
+  if (subscriptions & RegionEventListener::DESTROY) {
+    subscribedEvents->Set(subscribedEvents->Length(), NanNew("destroy"));
+  }
+  returnValue->Set(NanNew("subscriptions"), subscribedEvents);
+
+  NanReturnValue(returnValue);
+}
+
 template <typename T>
 class AbstractQueryWorker : public GemfireWorker {
  public:
@@ -715,15 +1617,36 @@ class QueryWorker : public AbstractQueryWorker<SelectResultsPtr> {
       const RegionPtr & regionPtr,
       const std::string & queryPredicate,
       NanCallback * callback) :
-    AbstractQueryWorker<SelectResultsPtr>(regionPtr, queryPredicate, callback) {}
+    AbstractQueryWorker<SelectResultsPtr>(regionPtr, queryPredicate, callback),
+    queryResultCachePtr(NULLPTR) {}
+
+  void setQueryResultCache(const QueryResultCachePtr & queryResultCachePtr,
+                           const std::string & resultKey,
+                           const std::vector<std::string> & regionPaths) {
+    this->queryResultCachePtr = queryResultCachePtr;
+    this->resultKey = resultKey;
+    this->regionPaths = regionPaths;
+  }
 
   void ExecuteGemfireWork() {
-    resultPtr = regionPtr->query(queryPredicate.c_str());
+    if (queryResultCachePtr == NULLPTR) {
+      resultPtr = regionPtr->query(queryPredicate.c_str(),
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
+    } else if (!queryResultCachePtr->get(resultKey, resultPtr)) {
+      QueryResultCache::Epochs epochs(queryResultCachePtr->epochs(regionPaths));
+      resultPtr = regionPtr->query(queryPredicate.c_str(),
+          operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
+      queryResultCachePtr->add(resultKey, regionPaths, resultPtr, epochs);
+    }
   }
 
   static std::string name() {
     return "query()";
   }
+
+  QueryResultCachePtr queryResultCachePtr;
+  std::string resultKey;
+  std::vector<std::string> regionPaths;
 };
 
 class SelectValueWorker : public AbstractQueryWorker<CacheablePtr> {
@@ -735,7 +1658,8 @@ class SelectValueWorker : public AbstractQueryWorker<CacheablePtr> {
     AbstractQueryWorker<CacheablePtr>(regionPtr, queryPredicate, callback) {}
 
   void ExecuteGemfireWork() {
-    resultPtr = regionPtr->selectValue(queryPredicate.c_str());
+    resultPtr = regionPtr->selectValue(queryPredicate.c_str(),
+        operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
   }
 
   static std::string name() {
@@ -752,7 +1676,8 @@ class ExistsValueWorker : public AbstractQueryWorker<bool> {
     AbstractQueryWorker<bool>(regionPtr, queryPredicate, callback) {}
 
   void ExecuteGemfireWork() {
-    resultPtr = regionPtr->existsValue(queryPredicate.c_str());
+    resultPtr = regionPtr->existsValue(queryPredicate.c_str(),
+        operationOptions.timeoutSeconds(DEFAULT_QUERY_RESPONSE_TIMEOUT));
   }
 
   static std::string name() {
@@ -760,6 +1685,28 @@ class ExistsValueWorker : public AbstractQueryWorker<bool> {
   }
 };
 
+// Only the results of query() are cached; selectValue() and existsValue() always ask the server.
+template<typename T>
+inline void useQueryResultCache(T * worker, const Local<Object> & cacheObject, Region * region) {}
+
+inline void useQueryResultCache(QueryWorker * worker, const Local<Object> & cacheObject, Region * region) {
+  Cache * cache = ObjectWrap::Unwrap<Cache>(cacheObject);
+  if (cache->queryResultCachePtr == NULLPTR) {
+    return;
+  }
+
+  std::string regionPath(region->regionPtr->getFullPath());
+  std::vector<std::string> regionPaths(QueryResultCache::regionPaths(worker->queryPredicate));
+  if (std::find(regionPaths.begin(), regionPaths.end(), regionPath) == regionPaths.end()) {
+    regionPaths.insert(regionPaths.begin(), regionPath);
+  }
+
+  cache->attachQueryResultCache(cacheObject, regionPaths);
+  worker->setQueryResultCache(cache->queryResultCachePtr,
+      QueryResultCache::key("region " + regionPath, worker->queryPredicate, NanUndefined()),
+      regionPaths);
+}
+
 template<typename T>
 NAN_METHOD(Region::Query) {
   NanScope();
@@ -771,7 +1718,16 @@ NAN_METHOD(Region::Query) {
     NanReturnUndefined();
   }
 
-  if (!args[1]->IsFunction()) {
+  OperationOptions operationOptions;
+  int callbackIndex = 1;
+  if (args.Length() > 2 && isOptionsObject(args[1])) {
+    if (!operationOptions.parse(args[1], T::name().c_str())) {
+      NanReturnUndefined();
+    }
+    callbackIndex = 2;
+  }
+
+  if (!args[callbackIndex]->IsFunction()) {
     std::stringstream errorStream;
     errorStream << "You must pass a function as the callback to " << T::name() << ".";
     NanThrowError(errorStream.str().c_str());
@@ -781,10 +1737,14 @@ NAN_METHOD(Region::Query) {
   Region * region = ObjectWrap::Unwrap<Region>(args.This());
 
   std::string queryPredicate(*NanUtf8String(args[0]));
-  NanCallback * callback = new NanCallback(args[1].As<Function>());
+  NanCallback * callback = new NanCallback(args[callbackIndex].As<Function>());
 
   T * worker = new T(region->regionPtr, queryPredicate, callback);
-  NanAsyncQueueWorker(worker);
+  worker->setOperationOptions(operationOptions);
+  useQueryResultCache(worker, NanNew(region->cacheHandle), region);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -830,7 +1790,9 @@ NAN_METHOD(Region::ServerKeys) {
   NanCallback * callback = new NanCallback(args[0].As<Function>());
 
   ServerKeysWorker * worker = new ServerKeysWorker(region->regionPtr, callback);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnUndefined();
 }
@@ -876,7 +1838,9 @@ NAN_METHOD(Region::Keys) {
   NanCallback * callback = new NanCallback(args[0].As<Function>());
 
   KeysWorker * worker = new KeysWorker(region->regionPtr, callback);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnUndefined();
 }
@@ -907,6 +1871,233 @@ NAN_METHOD(Region::UnregisterAllKeys) {
   NanReturnUndefined();
 }
 
+// Reads the options of registerKeys() and registerRegex(). Returns false after throwing if they are
+// invalid.
+static bool interestOptions(const Local<Value> & optionsValue,
+                            const std::string & methodName,
+                            bool & getInitialValues) {
+  NanScope();
+
+  getInitialValues = false;
+
+  if (optionsValue->IsUndefined()) {
+    return true;
+  }
+
+  if (!optionsValue->IsObject()) {
+    NanThrowError(("You must pass an options object to " + methodName + "().").c_str());
+    return false;
+  }
+
+  Local<Value> initialValues(optionsValue->ToObject()->Get(NanNew("initialValues")));
+  if (!initialValues->IsUndefined() && !initialValues->IsBoolean()) {
+    NanThrowError((methodName + ": initialValues must be true or false.").c_str());
+    return false;
+  }
+
+  getInitialValues = initialValues->IsTrue();
+  return true;
+}
+
+// Interest registration keys are passed the same way as getAllSync() keys. Returns NULLPTR after
+// throwing if they are invalid.
+static VectorOfCacheableKeyPtr interestKeys(const Region * region,
+                                            const Local<Value> & keysValue,
+                                            const std::string & methodName) {
+  if (!keysValue->IsArray()) {
+    NanThrowError(("You must pass an array of keys to " + methodName + "().").c_str());
+    return NULLPTR;
+  }
+
+  CachePtr cachePtr(getCacheFromRegion(region->regionPtr));
+  if (cachePtr == NULLPTR) {
+    return NULLPTR;
+  }
+
+  VectorOfCacheableKeyPtr keysPtr(gemfireKeys(Local<Array>::Cast(keysValue), cachePtr));
+  if (keysPtr == NULLPTR) {
+    NanThrowError("Invalid GemFire key.");
+    return NULLPTR;
+  }
+
+  if (keysPtr->size() == 0) {
+    NanThrowError(("You must pass at least one key to " + methodName + "().").c_str());
+    return NULLPTR;
+  }
+
+  return keysPtr;
+}
+
+// Interest registration patterns are strings or regular expressions, evaluated by the server.
+static bool interestPattern(const Local<Value> & patternValue,
+                            const std::string & methodName,
+                            std::string & pattern) {
+  NanScope();
+
+  if (patternValue->IsRegExp()) {
+    pattern = *NanUtf8String(Local<RegExp>::Cast(patternValue)->GetSource());
+    return true;
+  }
+
+  if (!patternValue->IsString()) {
+    NanThrowError(("You must pass a regular expression to " + methodName + "().").c_str());
+    return false;
+  }
+
+  pattern = *NanUtf8String(patternValue);
+  return true;
+}
+
+NAN_METHOD(Region::RegisterKeys) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  VectorOfCacheableKeyPtr keysPtr(interestKeys(region, args[0], "registerKeys"));
+  if (keysPtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  bool getInitialValues;
+  if (!interestOptions(args[1], "registerKeys", getInitialValues)) {
+    NanReturnUndefined();
+  }
+
+  try {
+    region->regionPtr->registerKeys(*keysPtr, false, getInitialValues);
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+
+  // Initial values replace local entries without necessarily raising events.
+  if (getInitialValues) {
+    region->invalidate(keysPtr);
+  }
+
+  NanReturnUndefined();
+}
+
+NAN_METHOD(Region::UnregisterKeys) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  VectorOfCacheableKeyPtr keysPtr(interestKeys(region, args[0], "unregisterKeys"));
+  if (keysPtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  try {
+    region->regionPtr->unregisterKeys(*keysPtr);
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+  }
+
+  NanReturnUndefined();
+}
+
+NAN_METHOD(Region::RegisterRegex) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  std::string pattern;
+  if (!interestPattern(args[0], "registerRegex", pattern)) {
+    NanReturnUndefined();
+  }
+
+  bool getInitialValues;
+  if (!interestOptions(args[1], "registerRegex", getInitialValues)) {
+    NanReturnUndefined();
+  }
+
+  VectorOfCacheableKeyPtr keysPtr(NULLPTR);
+  if (getInitialValues) {
+    keysPtr = new VectorOfCacheableKey();
+  }
+
+  try {
+    region->regionPtr->registerRegex(pattern.c_str(), false, keysPtr, getInitialValues);
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+    NanReturnUndefined();
+  }
+
+  if (getInitialValues) {
+    region->invalidate(keysPtr);
+  }
+
+  NanReturnUndefined();
+}
+
+NAN_METHOD(Region::UnregisterRegex) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  std::string pattern;
+  if (!interestPattern(args[0], "unregisterRegex", pattern)) {
+    NanReturnUndefined();
+  }
+
+  try {
+    region->regionPtr->unregisterRegex(pattern.c_str());
+  } catch (const gemfire::Exception & exception) {
+    ThrowGemfireException(exception);
+  }
+
+  NanReturnUndefined();
+}
+
+NAN_METHOD(Region::Watch) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  VectorOfCacheableKeyPtr keysPtr(interestKeys(region, args[0], "watch"));
+  if (keysPtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  if (!args[1]->IsFunction()) {
+    NanThrowError("You must pass a function as the listener to watch().");
+    NanReturnUndefined();
+  }
+
+  if (region->keyWatchers == NULL) {
+    region->keyWatchers = new KeyWatchers();
+  }
+
+  region->keyWatchers->watch(keysPtr, args[1].As<Function>());
+  region->updateEventSubscriptions();
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Region::Unwatch) {
+  NanScope();
+
+  Region * region = ObjectWrap::Unwrap<Region>(args.This());
+
+  VectorOfCacheableKeyPtr keysPtr(interestKeys(region, args[0], "unwatch"));
+  if (keysPtr == NULLPTR) {
+    NanReturnUndefined();
+  }
+
+  if (!args[1]->IsFunction()) {
+    NanThrowError("You must pass a function as the listener to unwatch().");
+    NanReturnUndefined();
+  }
+
+  if (region->keyWatchers != NULL) {
+    region->keyWatchers->unwatch(keysPtr, args[1].As<Function>());
+    region->updateEventSubscriptions();
+  }
+
+  NanReturnValue(args.This());
+}
+
 class ValuesWorker : public GemfireWorker {
  public:
   ValuesWorker(
@@ -948,7 +2139,9 @@ NAN_METHOD(Region::Values) {
   NanCallback * callback = new NanCallback(args[0].As<Function>());
 
   ValuesWorker * worker = new ValuesWorker(region->regionPtr, callback);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnUndefined();
 }
@@ -998,7 +2191,9 @@ NAN_METHOD(Region::Entries) {
   NanCallback * callback = new NanCallback(args[0].As<Function>());
 
   EntriesWorker * worker = new EntriesWorker(region->regionPtr, callback, true);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnUndefined();
 }
@@ -1022,6 +2217,11 @@ class DestroyRegionWorker : public GemfireEventedWorker {
     }
   }
 
+  void HandleOKCallback() {
+    region->unintern();
+    GemfireEventedWorker::HandleOKCallback();
+  }
+
  private:
   Region * region;
   bool local;
@@ -1039,7 +2239,9 @@ NAN_METHOD(Region::DestroyRegion) {
 
   NanCallback * callback = getCallback(args[0]);
   DestroyRegionWorker * worker = new DestroyRegionWorker(args.This(), region, callback, false);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -1056,7 +2258,9 @@ NAN_METHOD(Region::LocalDestroyRegion) {
 
   NanCallback * callback = getCallback(args[0]);
   DestroyRegionWorker * worker = new DestroyRegionWorker(args.This(), region, callback);
-  NanAsyncQueueWorker(worker);
+  if (!region->queueWorker(args.This(), worker, NULLPTR)) {
+    NanReturnUndefined();
+  }
 
   NanReturnValue(args.This());
 }
@@ -1111,13 +2315,42 @@ void Region::Init(Local<Object> exports) {
       NanNew<FunctionTemplate>(Region::RegisterAllKeys)->GetFunction());
   NanSetPrototypeTemplate(constructorTemplate, "unregisterAllKeys",
       NanNew<FunctionTemplate>(Region::UnregisterAllKeys)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "registerKeys",
+      NanNew<FunctionTemplate>(Region::RegisterKeys)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "unregisterKeys",
+      NanNew<FunctionTemplate>(Region::UnregisterKeys)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "registerRegex",
+      NanNew<FunctionTemplate>(Region::RegisterRegex)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "unregisterRegex",
+      NanNew<FunctionTemplate>(Region::UnregisterRegex)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "watch",
+      NanNew<FunctionTemplate>(Region::Watch)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "unwatch",
+      NanNew<FunctionTemplate>(Region::Unwatch)->GetFunction());
   NanSetPrototypeTemplate(constructorTemplate, "destroyRegion",
       NanNew<FunctionTemplate>(Region::DestroyRegion)->GetFunction());
   NanSetPrototypeTemplate(constructorTemplate, "localDestroyRegion",
       NanNew<FunctionTemplate>(Region::LocalDestroyRegion)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setValueCache",
+      NanNew<FunctionTemplate>(Region::SetValueCache)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setNegativeCache",
+      NanNew<FunctionTemplate>(Region::SetNegativeCache)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setLoader",
+      NanNew<FunctionTemplate>(Region::SetLoader)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setWriteBehind",
+      NanNew<FunctionTemplate>(Region::SetWriteBehind)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "flush",
+      NanNew<FunctionTemplate>(Region::Flush)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setLimits",
+      NanNew<FunctionTemplate>(Region::SetLimits)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "setEventOptions",
+      NanNew<FunctionTemplate>(Region::SetEventOptions)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "_updateEventSubscriptions",
+      NanNew<FunctionTemplate>(Region::UpdateEventSubscriptions)->GetFunction());
 
   constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("name"), Region::Name);
   constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("attributes"), Region::Attributes);
+  constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("statistics"), Region::Statistics);
 
   NanAssignPersistent(Region::constructor, constructorTemplate->GetFunction());
   exports->Set(NanNew("Region"), NanNew(Region::constructor));
@@ -6,15 +6,37 @@
 #include <node.h>
 #include <gfcpp/Region.hpp>
 #include "region_event_registry.hpp"
+#include "decoded_value_cache.hpp"
+#include "negative_cache.hpp"
+#include "loader.hpp"
+#include "write_behind_buffer.hpp"
+#include "work_limiter.hpp"
+#include "keyed_work_queue.hpp"
+#include "key_watchers.hpp"
+#include "query_result_cache.hpp"
 
 namespace node_gemfire {
 
+class GemfireWorker;
+
 class Region : public node::ObjectWrap {
  public:
   Region(v8::Local<v8::Object> regionHandle,
          v8::Local<v8::Object> cacheHandle,
          gemfire::RegionPtr regionPtr) :
-    regionPtr(regionPtr) {
+    regionPtr(regionPtr),
+    negativeCachePtr(NULLPTR),
+    loader(new Loader(this)),
+    decodedValueCache(NULL),
+    writeBehindBuffer(NULL),
+    maxEventBatchSize(0),
+    conflateEvents(false),
+    conflatedEvents(0),
+    eventListenerPtr(new RegionEventListener),
+    eventListenerAttached(false),
+    keyWatchers(NULL),
+    queryResultCachePtr(NULLPTR),
+    limiterPtr(NULLPTR) {
       Wrap(regionHandle);
       NanAssignPersistent(this->cacheHandle, cacheHandle);
     }
@@ -22,6 +44,13 @@ class Region : public node::ObjectWrap {
   virtual ~Region() {
     RegionEventRegistry::getInstance()->remove(this);
     NanDisposePersistent(cacheHandle);
+    delete decodedValueCache;
+    delete loader;
+    delete keyWatchers;
+
+    if (writeBehindBuffer != NULL) {
+      writeBehindBuffer->close();
+    }
   }
 
   static void Init(v8::Local<v8::Object> exports);
@@ -44,18 +73,86 @@ class Region : public node::ObjectWrap {
   static NAN_METHOD(ExecuteFunction);
   static NAN_METHOD(RegisterAllKeys);
   static NAN_METHOD(UnregisterAllKeys);
+  static NAN_METHOD(RegisterKeys);
+  static NAN_METHOD(UnregisterKeys);
+  static NAN_METHOD(RegisterRegex);
+  static NAN_METHOD(UnregisterRegex);
+  static NAN_METHOD(Watch);
+  static NAN_METHOD(Unwatch);
   static NAN_METHOD(DestroyRegion);
   static NAN_METHOD(LocalDestroyRegion);
+  static NAN_METHOD(SetValueCache);
+  static NAN_METHOD(SetNegativeCache);
+  static NAN_METHOD(SetLoader);
+  static NAN_METHOD(SetWriteBehind);
+  static NAN_METHOD(Flush);
+  static NAN_METHOD(SetLimits);
+  static NAN_METHOD(SetEventOptions);
+  static NAN_METHOD(UpdateEventSubscriptions);
   static NAN_METHOD(Inspect);
   static NAN_GETTER(Name);
   static NAN_GETTER(Attributes);
+  static NAN_GETTER(Statistics);
 
   template<typename T>
   static NAN_METHOD(Query);
 
+  bool hasListeners(const char * eventName);
+
+  // Attaches the event listener to the GemFire region while events are wanted, either by listeners
+  // or to keep the value, negative and query result caches up to date, and detaches it otherwise.
+  void updateEventSubscriptions();
+
+  // Forgets the wrapper once its region has been destroyed, so that it can be collected.
+  void unintern();
+
+  v8::Local<v8::Value> decodedValue(const gemfire::CacheableKeyPtr & keyPtr,
+                                    const gemfire::CacheablePtr & valuePtr);
+  void invalidate(const gemfire::CacheableKeyPtr & keyPtr);
+  void invalidate(const gemfire::HashMapOfCacheablePtr & hashMapPtr);
+  void invalidate(const gemfire::VectorOfCacheableKeyPtr & keysPtr);
+  void invalidateAll();
+  void invalidateQueryResults();
+
+  gemfire::CacheablePtr bufferedValue(const gemfire::CacheableKeyPtr & keyPtr);
+  void applyBufferedValues(const gemfire::VectorOfCacheableKeyPtr & keysPtr,
+                           const gemfire::HashMapOfCacheablePtr & resultsPtr);
+
+  // Starts the worker under the limits of the region and of its cache, in order behind earlier
+  // writes to the same keys. Returns false after throwing if the limits reject it.
+  bool queueWorker(const v8::Local<v8::Object> & regionObject,
+                   GemfireWorker * worker,
+                   const gemfire::CacheableKeyPtr & keyPtr);
+  bool queueWorker(const v8::Local<v8::Object> & regionObject,
+                   GemfireWorker * worker,
+                   const KeyedWorkQueue::Keys & keys);
+
   gemfire::RegionPtr regionPtr;
+  NegativeCachePtr negativeCachePtr;
+  Loader * loader;
+
+  // When non-zero, entry events are delivered in arrays of at most this many as "events".
+  unsigned int maxEventBatchSize;
+
+  // When set, only the net effect of the events for a key that arrive together is delivered.
+  bool conflateEvents;
+  unsigned int conflatedEvents;
+
+  RegionEventListenerPtr eventListenerPtr;
+  bool eventListenerAttached;
+
+  // The listeners passed to watch(), or NULL if nothing was ever watched.
+  KeyWatchers * keyWatchers;
+
+  // The query result cache of the cache, once it holds results of a query on this region. Changes
+  // to the region invalidate those results.
+  QueryResultCachePtr queryResultCachePtr;
 
  private:
+  DecodedValueCache * decodedValueCache;
+  WriteBehindBuffer * writeBehindBuffer;
+  WorkLimiterPtr limiterPtr;
+
   v8::Persistent<v8::Object> cacheHandle;
   static v8::Persistent<v8::Function> constructor;
 };
@@ -6,15 +6,27 @@ using namespace gemfire;
 namespace node_gemfire {
 
 void RegionEventListener::afterCreate(const EntryEvent & event) {
-  RegionEventRegistry::getInstance()->emit("create", event);
+  if (!(subscriptions & CREATE)) {
+    return;
+  }
+
+  RegionEventRegistry::getInstance()->emit("create", event, withOldValues);
 }
 
 void RegionEventListener::afterUpdate(const EntryEvent & event) {
-  RegionEventRegistry::getInstance()->emit("update", event);
+  if (!(subscriptions & UPDATE)) {
+    return;
+  }
+
+  RegionEventRegistry::getInstance()->emit("update", event, withOldValues);
 }
 
 void RegionEventListener::afterDestroy(const EntryEvent & event) {
-  RegionEventRegistry::getInstance()->emit("destroy", event);
+  if (!(subscriptions & DESTROY)) {
+    return;
+  }
+
+  RegionEventRegistry::getInstance()->emit("destroy", event, withOldValues);
 }
 
 RegionEventRegistry RegionEventRegistry::instance = RegionEventRegistry();
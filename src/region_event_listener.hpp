@@ -2,17 +2,29 @@
 #define __REGION_EVENT_LISTENER_HPP__
 
 #include <gfcpp/CacheListener.hpp>
+#include <gfcpp/SharedPtr.hpp>
 
 namespace node_gemfire {
 
+// Each region gets its own listener, so that GemFire's threads can read the event options of the
+// region without looking it up. It is only attached to the region while some event is subscribed.
 class RegionEventListener : public gemfire::CacheListener {
  public:
-  RegionEventListener() {}
+  enum Subscription { CREATE = 1, UPDATE = 2, DESTROY = 4, ALL = CREATE | UPDATE | DESTROY };
+
+  RegionEventListener() :
+    subscriptions(0),
+    withOldValues(true) {}
   virtual void afterCreate(const gemfire::EntryEvent & event);
   virtual void afterUpdate(const gemfire::EntryEvent & event);
   virtual void afterDestroy(const gemfire::EntryEvent & event);
+
+  volatile unsigned int subscriptions;
+  volatile bool withOldValues;
 };
 
+typedef gemfire::SharedPtr<RegionEventListener> RegionEventListenerPtr;
+
 }  // namespace node_gemfire
 
 #endif
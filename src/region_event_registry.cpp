@@ -1,10 +1,11 @@
 #include "region_event_registry.hpp"
 
-#include <string>
 #include <cassert>
-#include <set>
+#include <tr1/unordered_map>
+#include <utility>
 #include <vector>
 #include "events.hpp"
+#include "cacheable_key_functors.hpp"
 
 using namespace v8;
 using namespace gemfire;
@@ -14,18 +15,36 @@ namespace node_gemfire {
 void RegionEventRegistry::add(node_gemfire::Region * region) {
   assert(region->regionPtr != NULLPTR);
 
-  AttributesMutatorPtr attrMutatorPtr(region->regionPtr->getAttributesMutator());
-  attrMutatorPtr->setCacheListener(listener);
+  regions[region->regionPtr.ptr()] = region;
+}
+
+bool RegionEventRegistry::remove(node_gemfire::Region * region) {
+  std::tr1::unordered_map<gemfire::Region *, node_gemfire::Region *>::iterator iterator(
+      regions.find(region->regionPtr.ptr()));
+  if (iterator == regions.end() || iterator->second != region) {
+    return false;
+  }
 
-  regionSet.insert(region);
+  regions.erase(iterator);
+  return true;
 }
 
-void RegionEventRegistry::remove(node_gemfire::Region * region) {
-  regionSet.erase(region);
+node_gemfire::Region * RegionEventRegistry::find(const RegionPtr & regionPtr) {
+  std::tr1::unordered_map<gemfire::Region *, node_gemfire::Region *>::iterator iterator(
+      regions.find(regionPtr.ptr()));
+  if (iterator == regions.end()) {
+    return NULL;
+  }
+
+  return iterator->second;
 }
 
-void RegionEventRegistry::emit(const std::string & eventName, const EntryEvent & event) {
-  eventStream->add(new EventStream::Event(eventName, event));
+void RegionEventRegistry::emit(const char * eventName, const EntryEvent & event, bool withOldValue) {
+  eventStream->add(eventName, event, withOldValue);
+}
+
+EventStream * RegionEventRegistry::getEventStream() {
+  return eventStream;
 }
 
 RegionEventRegistry * RegionEventRegistry::getInstance() {
@@ -37,28 +56,152 @@ void RegionEventRegistry::emitCallback(uv_async_t * async, int status) {
   regionEventRegistry->publishEvents();
 }
 
+// Collects the events of regions that take them in batches during one callback. A batch is emitted
+// as soon as it is full, and whatever is left once the callback has drained the stream.
+class EventBatches {
+ public:
+  EventBatches() :
+    batches(NanNew<Array>()) {}
+
+  void add(Region * region, const Local<Object> & eventPayload) {
+    BatchIndex::iterator iterator(batchIndex.find(region));
+
+    unsigned int index;
+    if (iterator == batchIndex.end()) {
+      index = batchIndex.size();
+      batchIndex[region] = index;
+      batches->Set(index, NanNew<Array>());
+    } else {
+      index = iterator->second;
+    }
+
+    Local<Array> batch(batches->Get(index).As<Array>());
+    batch->Set(batch->Length(), eventPayload);
+
+    if (batch->Length() >= region->maxEventBatchSize) {
+      batches->Set(index, NanNew<Array>());
+      emitEvent(NanObjectWrapHandle(region), "events", batch);
+    }
+  }
+
+  void emitAll() {
+    for (BatchIndex::iterator iterator(batchIndex.begin());
+         iterator != batchIndex.end();
+         ++iterator) {
+      Local<Array> batch(batches->Get(iterator->second).As<Array>());
+      if (batch->Length() > 0) {
+        emitEvent(NanObjectWrapHandle(iterator->first), "events", batch);
+      }
+    }
+  }
+
+ private:
+  typedef std::tr1::unordered_map<Region *, unsigned int> BatchIndex;
+
+  BatchIndex batchIndex;
+  Local<Array> batches;
+};
+
+// Folds together the events for the same key of regions that conflate them, before any of them
+// is converted to JavaScript. Each key keeps the place of its first event.
+class EventConflater {
+ public:
+  // Returns false if the event was folded into an earlier one and can be released.
+  bool add(Region * region, EventStream::Event * event) {
+    KeyIndex & keyIndex(keyIndexes[region]);
+
+    KeyIndex::iterator iterator(keyIndex.find(event->getKey()));
+    if (iterator == keyIndex.end()) {
+      keyIndex[event->getKey()] = event;
+      return true;
+    }
+
+    iterator->second->conflate(event);
+    region->conflatedEvents++;
+    return false;
+  }
+
+ private:
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  EventStream::Event *,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> KeyIndex;
+
+  std::tr1::unordered_map<Region *, KeyIndex> keyIndexes;
+};
+
 void RegionEventRegistry::publishEvents() {
   NanScope();
 
-  std::vector<EventStream::Event *> eventVector(eventStream->nextEvents());
+  std::vector<EventStream::Event *> streamEvents;
+  streamEvents.reserve(maxEventsPerCallback);
+  eventStream->nextEvents(streamEvents, maxEventsPerCallback);
 
-  for (std::vector<EventStream::Event *>::iterator iterator(eventVector.begin());
-       iterator != eventVector.end();
+  std::vector<std::pair<Region *, EventStream::Event *> > events;
+  EventConflater eventConflater;
+
+  for (std::vector<EventStream::Event *>::iterator iterator(streamEvents.begin());
+       iterator != streamEvents.end();
        ++iterator) {
     EventStream::Event * event(*iterator);
-    Local<Object> eventPayload(event->v8Object());
 
-    for (std::set<Region *>::iterator iterator(regionSet.begin());
-         iterator != regionSet.end();
-         ++iterator) {
-      Region * region(*iterator);
-      Local<Object> regionObject(NanObjectWrapHandle(region));
-      if (region->regionPtr == event->getRegion()) {
-        emitEvent(regionObject, event->getName().c_str(), eventPayload);
+    Region * region(find(event->getRegion()));
+    if (region == NULL) {
+      eventStream->release(event);
+      continue;
+    }
+
+    region->invalidate(event->getKey());
+
+    if (region->conflateEvents && !eventConflater.add(region, event)) {
+      eventStream->release(event);
+      continue;
+    }
+
+    events.push_back(std::make_pair(region, event));
+  }
+
+  EventBatches eventBatches;
+
+  for (std::vector<std::pair<Region *, EventStream::Event *> >::iterator iterator(events.begin());
+       iterator != events.end();
+       ++iterator) {
+    Region * region(iterator->first);
+    EventStream::Event * event(iterator->second);
+
+    // A create and a destroy of the same key that arrived together cancel out.
+    const char * eventName(event->getName());
+    if (eventName == NULL) {
+      region->conflatedEvents++;
+      eventStream->release(event);
+      continue;
+    }
+
+    // Building the payload costs more than checking for listeners, so skip it when nobody listens.
+    if (region->maxEventBatchSize > 0) {
+      if (region->hasListeners("events")) {
+        Local<Object> eventPayload(event->v8Object());
+        eventPayload->Set(NanNew("type"), NanNew(eventName));
+        eventBatches.add(region, eventPayload);
       }
+    } else if (region->hasListeners(eventName)) {
+      emitEvent(NanObjectWrapHandle(region), eventName, event->v8Object());
     }
 
-    delete event;
+    // Watchers get a payload of their own, since it carries the event type.
+    if (region->keyWatchers != NULL && region->keyWatchers->watching(event->getKey())) {
+      Local<Object> eventPayload(event->v8Object());
+      eventPayload->Set(NanNew("type"), NanNew(eventName));
+      region->keyWatchers->emit(NanObjectWrapHandle(region), event->getKey(), eventPayload);
+    }
+
+    eventStream->release(event);
+  }
+
+  eventBatches.emitAll();
+
+  if (streamEvents.size() == maxEventsPerCallback) {
+    eventStream->wake();
   }
 }
 
@@ -3,8 +3,7 @@
 
 #include <gfcpp/Region.hpp>
 #include <gfcpp/EntryEvent.hpp>
-#include <string>
-#include <set>
+#include <tr1/unordered_map>
 #include "region_event_listener.hpp"
 #include "event_stream.hpp"
 
@@ -15,22 +14,28 @@ class Region;
 class RegionEventRegistry {
  public:
   RegionEventRegistry() :
-    listener(new RegionEventListener),
-    eventStream(new EventStream(this, (uv_async_cb) emitCallback)) {}
+    eventStream(new EventStream(this, (uv_async_cb) emitCallback, uv_default_loop())) {}
 
   static void emitCallback(uv_async_t * async, int status);
 
+  // There is at most one wrapper per GemFire region; find() returns it, or NULL if there is none.
   void add(node_gemfire::Region * region);
-  void remove(node_gemfire::Region * region);
-  void emit(const std::string & eventName, const gemfire::EntryEvent & event);
+  bool remove(node_gemfire::Region * region);
+  node_gemfire::Region * find(const gemfire::RegionPtr & regionPtr);
+
+  void emit(const char * eventName, const gemfire::EntryEvent & event, bool withOldValue);
+  EventStream * getEventStream();
   static RegionEventRegistry * getInstance();
 
  private:
   void publishEvents();
 
-  gemfire::CacheListenerPtr listener;
+  // Events that keep arriving while a batch is emitted wait for the next callback, so that an
+  // event storm can't starve the rest of the event loop.
+  static const unsigned int maxEventsPerCallback = 1024;
+
   static RegionEventRegistry instance;
-  std::set<node_gemfire::Region *> regionSet;
+  std::tr1::unordered_map<gemfire::Region *, node_gemfire::Region *> regions;
   EventStream * eventStream;
 };
 
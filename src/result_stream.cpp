@@ -4,49 +4,80 @@ using namespace gemfire;
 
 namespace node_gemfire {
 
-void ResultStream::add(const CacheablePtr & resultPtr) {
-  uv_mutex_lock(&resultsMutex);
-  resultsPtr->push_back(resultPtr);
-  uv_mutex_unlock(&resultsMutex);
-  uv_async_send(resultsAsync);
+ResultStream::ResultStream(void * target,
+                           uv_async_cb callback,
+                           uv_loop_t * loop,
+                           size_t highWaterMark) :
+    async(new uv_async_t),
+    highWaterMark(highWaterMark),
+    ended(false),
+    closed(false) {
+  uv_mutex_init(&mutex);
+  uv_cond_init(&resultsTaken);
+  uv_async_init(loop, async, callback);
+  async->data = target;
 }
 
-void ResultStream::end() {
-  uv_mutex_lock(&resultsProcessedMutex);
-  while (resultsPtr->size() > 0) {
-    uv_cond_wait(&resultsProcessedCond, &resultsProcessedMutex);
-  }
-  uv_mutex_unlock(&resultsProcessedMutex);
-
-  uv_async_send(endAsync);
+ResultStream::~ResultStream() {
+  uv_close(reinterpret_cast<uv_handle_t *>(async), deleteHandle);
+  uv_cond_destroy(&resultsTaken);
+  uv_mutex_destroy(&mutex);
 }
 
-void ResultStream::resultsProcessed() {
-  uv_mutex_lock(&resultsProcessedMutex);
-  uv_cond_signal(&resultsProcessedCond);
-  uv_mutex_unlock(&resultsProcessedMutex);
-}
+void ResultStream::add(const CacheablePtr & resultPtr) {
+  uv_mutex_lock(&mutex);
+
+  while (highWaterMark > 0 && results.size() >= highWaterMark && !closed) {
+    uv_cond_wait(&resultsTaken, &mutex);
+  }
 
-CacheableVectorPtr ResultStream::nextResults() {
-  uv_mutex_lock(&resultsMutex);
+  if (closed) {
+    uv_mutex_unlock(&mutex);
+    return;
+  }
 
-  CacheableVectorPtr returnValue = CacheableVector::create();
+  bool wasEmpty = results.empty();
+  results.push_back(resultPtr);
+  uv_mutex_unlock(&mutex);
 
-  for (CacheableVector::Iterator iterator(resultsPtr->begin());
-       iterator != resultsPtr->end();
-       ++iterator) {
-    returnValue->push_back(*iterator);
+  // Otherwise the main thread has yet to take the earlier results, and takes these with them.
+  if (wasEmpty) {
+    uv_async_send(async);
   }
+}
+
+void ResultStream::end() {
+  uv_mutex_lock(&mutex);
+  ended = true;
+  uv_mutex_unlock(&mutex);
 
-  resultsPtr->clear();
+  uv_async_send(async);
+}
 
-  uv_mutex_unlock(&resultsMutex);
+bool ResultStream::nextResults(std::vector<CacheablePtr> & results) {
+  uv_mutex_lock(&mutex);
+  this->results.swap(results);
+  bool returnValue = ended;
+  uv_cond_broadcast(&resultsTaken);
+  uv_mutex_unlock(&mutex);
 
   return returnValue;
 }
 
+void ResultStream::wake() {
+  uv_async_send(async);
+}
+
+void ResultStream::close() {
+  uv_mutex_lock(&mutex);
+  closed = true;
+  results.clear();
+  uv_cond_broadcast(&resultsTaken);
+  uv_mutex_unlock(&mutex);
+}
+
 void ResultStream::deleteHandle(uv_handle_t * handle) {
-  delete handle;
+  delete reinterpret_cast<uv_async_t *>(handle);
 }
 
 }  // namespace node_gemfire
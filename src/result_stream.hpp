@@ -3,52 +3,55 @@
 
 #include <gfcpp/CacheableBuiltins.hpp>
 #include <uv.h>
+#include <vector>
 
 namespace node_gemfire {
 
+// Carries function results from the GemFire thread that collects them to the main thread.
+//
+// The collector appends to one buffer while the main thread works through the other, and taking
+// the results swaps the two, so neither side copies them and both keep their capacity. The
+// collector only wakes the main thread when it adds to an empty buffer, and end() doesn't wait for
+// the main thread: the end is reported along with the last results.
+//
+// With a high-water mark, add() waits while the collector's buffer is full until the main thread
+// takes it, so a consumer that stops reading holds back the function instead of letting its results
+// pile up in memory.
 class ResultStream {
  public:
-  explicit ResultStream(void * worker,
-                        uv_async_cb resultsCallback,
-                        uv_async_cb endCallback) :
-    resultsAsync(new uv_async_t),
-    endAsync(new uv_async_t),
-    resultsPtr(gemfire::CacheableVector::create()) {
-      uv_mutex_init(&resultsMutex);
-      uv_mutex_init(&resultsProcessedMutex);
-      uv_cond_init(&resultsProcessedCond);
-      resultsAsync->data = worker;
-      endAsync->data = worker;
-      uv_async_init(uv_default_loop(), resultsAsync, resultsCallback);
-      uv_async_init(uv_default_loop(), endAsync, endCallback);
-    }
-
-  ~ResultStream() {
-    uv_close(reinterpret_cast<uv_handle_t *>(endAsync), deleteHandle);
-    uv_close(reinterpret_cast<uv_handle_t *>(resultsAsync), deleteHandle);
-    uv_mutex_destroy(&resultsMutex);
-    uv_mutex_destroy(&resultsProcessedMutex);
-    uv_cond_destroy(&resultsProcessedCond);
-  }
+  ResultStream(void * target, uv_async_cb callback, uv_loop_t * loop, size_t highWaterMark = 0);
+  ~ResultStream();
 
+  // Called from the collecting thread.
   void add(const gemfire::CacheablePtr & resultPtr);
   void end();
-  void resultsProcessed();
 
-  gemfire::CacheableVectorPtr nextResults();
+  // Called from the main thread. Swaps the waiting results into `results`, which must be empty, and
+  // returns true once the stream has ended, in which case no more results will follow.
+  bool nextResults(std::vector<gemfire::CacheablePtr> & results);
+
+  // Schedules another callback, for a consumer that stopped before processing every result.
+  void wake();
+
+  // Drops the waiting results and any that are added later, releasing a collector that waits for
+  // room. The end is still reported.
+  void close();
 
  private:
   static void deleteHandle(uv_handle_t * handle);
 
-  uv_mutex_t resultsMutex;
-  uv_mutex_t resultsProcessedMutex;
-
-  uv_async_t * resultsAsync;
-  uv_async_t * endAsync;
+  // Allocated separately so that it can outlive the stream until its close callback has run.
+  uv_async_t * async;
 
-  uv_cond_t resultsProcessedCond;
+  // 0 for no limit.
+  const size_t highWaterMark;
 
-  gemfire::CacheableVectorPtr resultsPtr;
+  // Guards everything below.
+  uv_mutex_t mutex;
+  uv_cond_t resultsTaken;
+  std::vector<gemfire::CacheablePtr> results;
+  bool ended;
+  bool closed;
 };
 
 }  // namespace node_gemfire
@@ -1,7 +1,16 @@
 #include <gfcpp/SelectResultsIterator.hpp>
+#include <gfcpp/Struct.hpp>
+#include <gfcpp/CacheableBuiltins.hpp>
+#include <gfcpp/CacheableDate.hpp>
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <vector>
 #include "conversions.hpp"
 #include "select_results.hpp"
+#include "aggregation.hpp"
+#include "gemfire_worker.hpp"
 
 using namespace v8;
 using namespace gemfire;
@@ -22,10 +31,21 @@ void SelectResults::Init(Local<Object> exports) {
       NanNew<FunctionTemplate>(SelectResults::ToArray)->GetFunction());
   NanSetPrototypeTemplate(constructorTemplate, "each",
       NanNew<FunctionTemplate>(SelectResults::Each)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "slice",
+      NanNew<FunctionTemplate>(SelectResults::Slice)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "toColumns",
+      NanNew<FunctionTemplate>(SelectResults::ToColumns)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "aggregate",
+      NanNew<FunctionTemplate>(SelectResults::Aggregate)->GetFunction());
+  NanSetPrototypeTemplate(constructorTemplate, "release",
+      NanNew<FunctionTemplate>(SelectResults::Release)->GetFunction());
   NanSetPrototypeTemplate(constructorTemplate, "inspect",
       NanNew<FunctionTemplate>(SelectResults::Inspect)->GetFunction());
 
+  constructorTemplate->PrototypeTemplate()->SetAccessor(NanNew("length"), SelectResults::Length);
+
   NanAssignPersistent(SelectResults::constructor, constructorTemplate->GetFunction());
+  exports->Set(NanNew("SelectResults"), constructorTemplate->GetFunction());
 }
 
 Local<Object> SelectResults::NewInstance(const SelectResultsPtr & selectResultsPtr) {
@@ -45,6 +65,10 @@ NAN_METHOD(SelectResults::ToArray) {
   NanScope();
 
   SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
   SelectResultsPtr selectResultsPtr(selectResults->selectResultsPtr);
 
   unsigned int length = selectResultsPtr->size();
@@ -66,6 +90,10 @@ NAN_METHOD(SelectResults::Each) {
   }
 
   SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
   SelectResultsPtr selectResultsPtr(selectResults->selectResultsPtr);
 
   SelectResultsIterator iterator(selectResultsPtr->getIterator());
@@ -80,12 +108,287 @@ NAN_METHOD(SelectResults::Each) {
   NanReturnValue(args.This());
 }
 
+// Follows Array.prototype.slice: negative indexes count from the end, and `end` defaults to the
+// length. Only the rows in the slice are converted.
+NAN_METHOD(SelectResults::Slice) {
+  NanScope();
+
+  SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
+  SelectResultsPtr selectResultsPtr(selectResults->selectResultsPtr);
+  int64_t length = selectResultsPtr->size();
+
+  int64_t bounds[2] = { 0, length };
+  for (unsigned int i = 0; i < 2; i++) {
+    if (args[i]->IsUndefined()) {
+      continue;
+    }
+
+    if (!args[i]->IsNumber()) {
+      NanThrowError("slice: start and end must be numbers.");
+      NanReturnUndefined();
+    }
+
+    int64_t bound = args[i]->IntegerValue();
+    if (bound < 0) {
+      bound += length;
+    }
+    bounds[i] = std::max(static_cast<int64_t>(0), std::min(bound, length));
+  }
+
+  int32_t start = bounds[0];
+  int32_t end = std::max(bounds[0], bounds[1]);
+
+  Local<Array> array(NanNew<Array>(end - start));
+  for (int32_t i = start; i < end; i++) {
+    array->Set(i - start, v8Value((*selectResultsPtr)[i]));
+  }
+
+  NanReturnValue(array);
+}
+
+enum ColumnType { EMPTY_COLUMN, NUMBER_COLUMN, DATE_COLUMN, VALUE_COLUMN };
+
+// A column is numeric or a date only if every value in it is, apart from nulls.
+static ColumnType columnType(const SelectResultsPtr & selectResultsPtr, int32_t field) {
+  ColumnType type = EMPTY_COLUMN;
+
+  int32_t length = selectResultsPtr->size();
+  for (int32_t row = 0; row < length; row++) {
+    CacheablePtr valuePtr((*static_cast<StructPtr>((*selectResultsPtr)[row]))[field]);
+    if (valuePtr == NULLPTR || valuePtr->typeId() == GemfireTypeIds::CacheableUndefined) {
+      continue;
+    }
+
+    double number;
+    ColumnType valueType;
+    if (numberValue(valuePtr, number)) {
+      valueType = NUMBER_COLUMN;
+    } else if (valuePtr->typeId() == GemfireTypeIds::CacheableDate) {
+      valueType = DATE_COLUMN;
+    } else {
+      return VALUE_COLUMN;
+    }
+
+    if (type != EMPTY_COLUMN && type != valueType) {
+      return VALUE_COLUMN;
+    }
+    type = valueType;
+  }
+
+  return (type == EMPTY_COLUMN) ? VALUE_COLUMN : type;
+}
+
+// Fills a Float64Array through its backing store when V8 exposes it, which it does for all but
+// the smallest arrays.
+static Local<Object> float64Column(const SelectResultsPtr & selectResultsPtr,
+                                   int32_t field,
+                                   ColumnType type) {
+  NanEscapableScope();
+
+  int32_t length = selectResultsPtr->size();
+
+  Local<Function> float64ArrayConstructor(
+      NanGetCurrentContext()->Global()->Get(NanNew("Float64Array")).As<Function>());
+  static const int argc = 1;
+  Local<Value> argv[argc] = { NanNew<Number>(length) };
+  Local<Object> column(float64ArrayConstructor->NewInstance(argc, argv));
+
+  double * data = NULL;
+  if (column->HasIndexedPropertiesInExternalArrayData()) {
+    data = static_cast<double *>(column->GetIndexedPropertiesExternalArrayData());
+  }
+
+  for (int32_t row = 0; row < length; row++) {
+    CacheablePtr valuePtr((*static_cast<StructPtr>((*selectResultsPtr)[row]))[field]);
+
+    double value = NAN;
+    if (type == DATE_COLUMN) {
+      if (valuePtr != NULLPTR && valuePtr->typeId() == GemfireTypeIds::CacheableDate) {
+        value = static_cast<CacheableDatePtr>(valuePtr)->milliseconds();
+      }
+    } else {
+      numberValue(valuePtr, value);
+    }
+
+    if (data != NULL) {
+      data[row] = value;
+    } else {
+      column->Set(row, NanNew<Number>(value));
+    }
+  }
+
+  return NanEscapeScope(column);
+}
+
+static Local<Array> valueColumn(const SelectResultsPtr & selectResultsPtr, int32_t field) {
+  NanEscapableScope();
+
+  int32_t length = selectResultsPtr->size();
+  Local<Array> column(NanNew<Array>(length));
+
+  for (int32_t row = 0; row < length; row++) {
+    column->Set(row, v8Value((*static_cast<StructPtr>((*selectResultsPtr)[row]))[field]));
+  }
+
+  return NanEscapeScope(column);
+}
+
+NAN_METHOD(SelectResults::ToColumns) {
+  NanScope();
+
+  SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
+  SelectResultsPtr selectResultsPtr(selectResults->selectResultsPtr);
+
+  Local<Array> columns(NanNew<Array>());
+  Local<Object> types(NanNew<Object>());
+  Local<Object> data(NanNew<Object>());
+
+  Local<Object> returnValue(NanNew<Object>());
+  returnValue->Set(NanNew("columns"), columns);
+  returnValue->Set(NanNew("types"), types);
+  returnValue->Set(NanNew("data"), data);
+
+  if (selectResultsPtr->size() == 0) {
+    NanReturnValue(returnValue);
+  }
+
+  SerializablePtr firstRowPtr((*selectResultsPtr)[0]);
+  if (firstRowPtr == NULLPTR || firstRowPtr->typeId() != GemfireTypeIds::Struct) {
+    NanThrowError("toColumns: the query must select fields, as in SELECT r.a, r.b FROM /region r.");
+    NanReturnUndefined();
+  }
+
+  StructPtr firstStructPtr(static_cast<StructPtr>(firstRowPtr));
+  int32_t fieldCount = firstStructPtr->length();
+
+  for (int32_t field = 0; field < fieldCount; field++) {
+    Local<String> name(NanNew(firstStructPtr->getFieldName(field)));
+    columns->Set(field, name);
+
+    switch (columnType(selectResultsPtr, field)) {
+      case NUMBER_COLUMN:
+        types->Set(name, NanNew("number"));
+        data->Set(name, float64Column(selectResultsPtr, field, NUMBER_COLUMN));
+        break;
+      case DATE_COLUMN:
+        types->Set(name, NanNew("date"));
+        data->Set(name, float64Column(selectResultsPtr, field, DATE_COLUMN));
+        break;
+      default:
+        types->Set(name, NanNew("value"));
+        data->Set(name, valueColumn(selectResultsPtr, field));
+        break;
+    }
+  }
+
+  NanReturnValue(returnValue);
+}
+
+class AggregateWorker : public GemfireWorker {
+ public:
+  AggregateWorker(const SelectResultsPtr & selectResultsPtr,
+                  Aggregation * aggregation,
+                  NanCallback * callback) :
+      GemfireWorker(callback),
+      selectResultsPtr(selectResultsPtr),
+      aggregation(aggregation) {}
+
+  ~AggregateWorker() {
+    delete aggregation;
+  }
+
+  void ExecuteGemfireWork() {
+    std::string error;
+    if (!aggregation->run(selectResultsPtr, error)) {
+      SetError("TypeError", error.c_str());
+    }
+  }
+
+  void HandleOKCallback() {
+    NanScope();
+
+    static const int argc = 2;
+    Local<Value> argv[argc] = { NanUndefined(), aggregation->v8Result() };
+    callback->Call(argc, argv);
+  }
+
+  SelectResultsPtr selectResultsPtr;
+  Aggregation * aggregation;
+};
+
+NAN_METHOD(SelectResults::Aggregate) {
+  NanScope();
+
+  if (args.Length() < 2 || !args[1]->IsFunction()) {
+    NanThrowError("You must pass an aggregation object and a callback to aggregate().");
+    NanReturnUndefined();
+  }
+
+  SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
+  Aggregation * aggregation = new Aggregation();
+  if (!aggregation->parse(args[0])) {
+    delete aggregation;
+    NanReturnUndefined();
+  }
+
+  // The worker keeps the results alive even if they are released in the meantime.
+  NanCallback * callback = new NanCallback(args[1].As<Function>());
+  NanAsyncQueueWorker(new AggregateWorker(selectResults->selectResultsPtr, aggregation, callback));
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(SelectResults::Release) {
+  NanScope();
+
+  SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  selectResults->selectResultsPtr = NULLPTR;
+
+  NanReturnUndefined();
+}
+
+NAN_GETTER(SelectResults::Length) {
+  NanScope();
+
+  SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
+  if (!selectResults->available()) {
+    NanReturnUndefined();
+  }
+
+  NanReturnValue(NanNew(selectResults->selectResultsPtr->size()));
+}
+
+bool SelectResults::available() {
+  if (selectResultsPtr == NULLPTR) {
+    NanThrowError("You cannot use SelectResults after release().");
+    return false;
+  }
+
+  return true;
+}
+
 NAN_METHOD(SelectResults::Inspect) {
   NanScope();
 
   SelectResults * selectResults = ObjectWrap::Unwrap<SelectResults>(args.This());
   SelectResultsPtr selectResultsPtr(selectResults->selectResultsPtr);
 
+  if (selectResultsPtr == NULLPTR) {
+    NanReturnValue(NanNew("[SelectResults released]"));
+  }
+
   std::stringstream inspectStream;
   inspectStream << "[SelectResults size=" << selectResultsPtr->size() << "]";
 
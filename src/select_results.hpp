@@ -18,9 +18,17 @@ class SelectResults : public node::ObjectWrap {
       const gemfire::SelectResultsPtr & selectResultsPtr);
   static NAN_METHOD(ToArray);
   static NAN_METHOD(Each);
+  static NAN_METHOD(Slice);
+  static NAN_METHOD(ToColumns);
+  static NAN_METHOD(Aggregate);
+  static NAN_METHOD(Release);
   static NAN_METHOD(Inspect);
+  static NAN_GETTER(Length);
 
  private:
+  // Returns false after throwing if the results have been released.
+  bool available();
+
   gemfire::SelectResultsPtr selectResultsPtr;
   static v8::Persistent<v8::Function> constructor;
 };
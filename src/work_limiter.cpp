@@ -0,0 +1,206 @@
+#include "work_limiter.hpp"
+#include <sstream>
+#include "gemfire_worker.hpp"
+#include "keyed_work_queue.hpp"
+#include "events.hpp"
+#include "exceptions.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+bool WorkLimiter::parse(const Local<Value> & optionsValue,
+                        const char * subject,
+                        WorkLimiterPtr & limiterPtr) {
+  NanScope();
+
+  if (!optionsValue->IsObject()) {
+    NanThrowError("You must pass an options object or null to setLimits().");
+    return false;
+  }
+
+  Local<Object> optionsObject(optionsValue->ToObject());
+  Local<Value> maxInFlight(optionsObject->Get(NanNew("maxInFlight")));
+  Local<Value> maxQueued(optionsObject->Get(NanNew("maxQueued")));
+  Local<Value> policy(optionsObject->Get(NanNew("policy")));
+
+  if (!(maxInFlight->IsUint32() && maxInFlight->Uint32Value() > 0)) {
+    NanThrowError("setLimits: maxInFlight must be a positive integer.");
+    return false;
+  }
+
+  std::string policyName(policy->IsUndefined() ? "fail" : *NanUtf8String(policy));
+  if (!(policy->IsUndefined() || policy->IsString()) || (policyName != "fail" && policyName != "queue")) {
+    NanThrowError("setLimits: policy must be \"fail\" or \"queue\".");
+    return false;
+  }
+
+  bool queueWhenFull = (policyName == "queue");
+
+  if (queueWhenFull && !(maxQueued->IsUint32() && maxQueued->Uint32Value() > 0)) {
+    NanThrowError("setLimits: maxQueued must be a positive integer when the policy is \"queue\".");
+    return false;
+  }
+
+  if (!queueWhenFull && !maxQueued->IsUndefined()) {
+    NanThrowError("setLimits: maxQueued can only be used with the \"queue\" policy.");
+    return false;
+  }
+
+  limiterPtr = new WorkLimiter(subject,
+                               maxInFlight->Uint32Value(),
+                               queueWhenFull ? maxQueued->Uint32Value() : 0,
+                               queueWhenFull);
+  return true;
+}
+
+WorkLimiter::Admission WorkLimiter::admit(LimitedWork * work, const Local<Object> & emitter) {
+  hold(emitter);
+
+  if (inFlight < maxInFlight && heldWork.empty()) {
+    inFlight++;
+    return ADMITTED;
+  }
+
+  if (queueWhenFull && heldWork.size() < maxQueued) {
+    heldWork.push_back(work);
+    setFull();
+    return HELD;
+  }
+
+  rejected++;
+  setFull();
+  return REJECTED;
+}
+
+void WorkLimiter::release() {
+  NanScope();
+
+  inFlight--;
+
+  // A held worker that is rejected by a later limiter releases this one again while it is being
+  // started below. The loop already accounts for that.
+  if (releasing) {
+    return;
+  }
+
+  releasing = true;
+  while (!heldWork.empty() && inFlight < maxInFlight) {
+    LimitedWork * work = heldWork.front();
+    heldWork.pop_front();
+    inFlight++;
+
+    work->admitted();
+    if (work->advance() == REJECTED) {
+      work->reject();
+    }
+  }
+  releasing = false;
+
+  Local<Object> emitterObject(NanNew(emitter));
+
+  if (full && heldWork.empty() && inFlight < maxInFlight) {
+    full = false;
+    emitEvent(emitterObject, "drain");
+  }
+
+  if (!busy()) {
+    NanDisposePersistent(emitter);
+  }
+}
+
+std::string WorkLimiter::rejectionMessage() {
+  std::stringstream messageStream;
+  messageStream << "Too many operations are " << (queueWhenFull ? "queued" : "in flight")
+                << " for this " << subject << ".";
+  return messageStream.str();
+}
+
+Local<Object> WorkLimiter::statistics() {
+  NanEscapableScope();
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("maxInFlight"), NanNew(maxInFlight));
+  statistics->Set(NanNew("maxQueued"), NanNew(maxQueued));
+  statistics->Set(NanNew("policy"), NanNew(queueWhenFull ? "queue" : "fail"));
+  statistics->Set(NanNew("inFlight"), NanNew(inFlight));
+  statistics->Set(NanNew("queued"), NanNew(static_cast<unsigned int>(heldWork.size())));
+  statistics->Set(NanNew("rejected"), NanNew(rejected));
+  statistics->Set(NanNew("full"), NanNew(full));
+
+  return NanEscapeScope(statistics);
+}
+
+bool WorkLimiter::busy() {
+  return inFlight > 0 || !heldWork.empty();
+}
+
+void WorkLimiter::hold(const Local<Object> & emitter) {
+  if (this->emitter.IsEmpty()) {
+    NanAssignPersistent(this->emitter, emitter);
+  }
+}
+
+void WorkLimiter::setFull() {
+  if (full) {
+    return;
+  }
+
+  full = true;
+  emitEvent(NanNew(emitter), "full");
+}
+
+void LimitedWork::addLimiter(const WorkLimiterPtr & limiterPtr, const Local<Object> & emitter) {
+  NanScope();
+
+  NanNew(emitters)->Set(limiterPtrs.size(), emitter);
+  limiterPtrs.push_back(limiterPtr);
+}
+
+bool LimitedWork::start() {
+  if (advance() != WorkLimiter::REJECTED) {
+    return true;
+  }
+
+  std::string message(limiterPtrs[nextLimiter]->rejectionMessage());
+
+  worker->releaseLimits();
+  delete worker;
+  delete this;
+
+  NanThrowError(v8Error("LimitExceededError", message.c_str()));
+  return false;
+}
+
+WorkLimiter::Admission LimitedWork::advance() {
+  NanScope();
+
+  while (nextLimiter < limiterPtrs.size()) {
+    Local<Object> emitter(NanNew(emitters)->Get(nextLimiter)->ToObject());
+
+    WorkLimiter::Admission admission = limiterPtrs[nextLimiter]->admit(this, emitter);
+    if (admission != WorkLimiter::ADMITTED) {
+      return admission;
+    }
+
+    admitted();
+  }
+
+  KeyedWorkQueue::getInstance()->queue(regionPtr, keys, worker);
+  delete this;
+  return WorkLimiter::ADMITTED;
+}
+
+void LimitedWork::admitted() {
+  worker->admittedBy(limiterPtrs[nextLimiter]);
+  nextLimiter++;
+}
+
+void LimitedWork::reject() {
+  worker->reject("LimitExceededError", limiterPtrs[nextLimiter]->rejectionMessage().c_str());
+  delete worker;
+  delete this;
+}
+
+}  // namespace node_gemfire
@@ -0,0 +1,139 @@
+#ifndef __WORK_LIMITER_HPP__
+#define __WORK_LIMITER_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <gfcpp/SharedPtr.hpp>
+#include <gfcpp/SharedBase.hpp>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/Region.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+#include "keyed_work_queue.hpp"
+
+namespace node_gemfire {
+
+class GemfireWorker;
+class LimitedWork;
+
+// Bounds the number of asynchronous operations of a region or a cache that are in flight at once.
+//
+// When `maxInFlight` operations are already in flight, a new one is either rejected right away or,
+// with the "queue" policy, held until an earlier one completes. At most `maxQueued` operations are
+// held; any more are rejected. The emitter gets a "full" event when operations stop starting right
+// away and a "drain" event once they do again, so that callers can slow down upstream.
+//
+// Only accessed from the main thread.
+class WorkLimiter : public gemfire::SharedBase {
+ public:
+  enum Admission { ADMITTED, HELD, REJECTED };
+
+  WorkLimiter(const char * subject, unsigned int maxInFlight, unsigned int maxQueued, bool queueWhenFull) :
+    SharedBase(),
+    subject(subject),
+    maxInFlight(maxInFlight),
+    maxQueued(maxQueued),
+    queueWhenFull(queueWhenFull),
+    inFlight(0),
+    rejected(0),
+    full(false),
+    releasing(false) {}
+
+  virtual ~WorkLimiter() {
+    NanDisposePersistent(emitter);
+  }
+
+  // Parses the options passed to setLimits(). Returns false after throwing if they are invalid.
+  static bool parse(const v8::Local<v8::Value> & optionsValue,
+                    const char * subject,
+                    gemfire::SharedPtr<WorkLimiter> & limiterPtr);
+
+  Admission admit(LimitedWork * work, const v8::Local<v8::Object> & emitter);
+
+  // Must be called when an admitted operation completes, to start the next held one.
+  void release();
+
+  std::string rejectionMessage();
+  v8::Local<v8::Object> statistics();
+
+  const std::string subject;
+  const unsigned int maxInFlight;
+  const unsigned int maxQueued;
+  const bool queueWhenFull;
+
+ private:
+  bool busy();
+  void hold(const v8::Local<v8::Object> & emitter);
+  void setFull();
+
+  // The region or cache object is kept alive while any of its operations are in flight or held.
+  v8::Persistent<v8::Object> emitter;
+
+  std::deque<LimitedWork *> heldWork;
+  unsigned int inFlight;
+  unsigned int rejected;
+  bool full;
+  bool releasing;
+};
+
+typedef gemfire::SharedPtr<WorkLimiter> WorkLimiterPtr;
+
+// A worker on its way through the limiters of its region and its cache. It is started once every
+// limiter has admitted it, in order behind earlier writes to the same keys.
+class LimitedWork {
+ public:
+  LimitedWork(GemfireWorker * worker,
+              const gemfire::RegionPtr & regionPtr,
+              const gemfire::CacheableKeyPtr & keyPtr) :
+    worker(worker),
+    regionPtr(regionPtr),
+    keys(),
+    nextLimiter(0) {
+      if (keyPtr != NULLPTR) {
+        keys.push_back(keyPtr);
+      }
+
+      NanAssignPersistent(emitters, NanNew<v8::Array>());
+    }
+
+  LimitedWork(GemfireWorker * worker,
+              const gemfire::RegionPtr & regionPtr,
+              const KeyedWorkQueue::Keys & keys) :
+    worker(worker),
+    regionPtr(regionPtr),
+    keys(keys),
+    nextLimiter(0) {
+      NanAssignPersistent(emitters, NanNew<v8::Array>());
+    }
+
+  ~LimitedWork() {
+    NanDisposePersistent(emitters);
+  }
+
+  void addLimiter(const WorkLimiterPtr & limiterPtr, const v8::Local<v8::Object> & emitter);
+
+  // Starts the worker or leaves it held by a limiter. Deletes the worker and throws a
+  // LimitExceededError if a limiter rejects it, returning false. Either way this object is no
+  // longer owned by the caller.
+  bool start();
+
+ private:
+  friend class WorkLimiter;
+
+  WorkLimiter::Admission advance();
+  void admitted();
+  void reject();
+
+  GemfireWorker * worker;
+  gemfire::RegionPtr regionPtr;
+  KeyedWorkQueue::Keys keys;
+
+  std::vector<WorkLimiterPtr> limiterPtrs;
+  v8::Persistent<v8::Array> emitters;
+  unsigned int nextLimiter;
+};
+
+}  // namespace node_gemfire
+
+#endif
@@ -0,0 +1,378 @@
+#include "write_behind_buffer.hpp"
+#include <gfcpp/Region.hpp>
+#include <nan.h>
+#include <uv.h>
+#include "events.hpp"
+#include "exceptions.hpp"
+#include "gemfire_worker.hpp"
+#include "keyed_work_queue.hpp"
+
+using namespace v8;
+using namespace gemfire;
+
+namespace node_gemfire {
+
+class WriteBehindFlushWorker : public GemfireWorker {
+ public:
+  WriteBehindFlushWorker(
+    WriteBehindBuffer * writeBehindBuffer,
+    const RegionPtr & regionPtr,
+    const HashMapOfCacheablePtr & hashMapPtr,
+    const KeyedWorkQueue::Keys & keys) :
+      GemfireWorker(NULL),
+      writeBehindBuffer(writeBehindBuffer),
+      regionPtr(regionPtr),
+      hashMapPtr(hashMapPtr),
+      keys(keys) {}
+
+  void ExecuteGemfireWork() {
+    if (hashMapPtr->size() == 0) {
+      return;
+    }
+
+    regionPtr->putAll(*hashMapPtr);
+  }
+
+  void HandleOKCallback() {
+    NanScope();
+    writeBehindBuffer->flushed(NanUndefined());
+  }
+
+  void HandleErrorCallback() {
+    NanScope();
+    writeBehindBuffer->flushed(errorObject());
+  }
+
+  void WorkComplete() {
+    GemfireWorker::WorkComplete();
+    KeyedWorkQueue::getInstance()->completed(regionPtr, keys);
+  }
+
+ private:
+  WriteBehindBuffer * writeBehindBuffer;
+  RegionPtr regionPtr;
+  HashMapOfCacheablePtr hashMapPtr;
+  KeyedWorkQueue::Keys keys;
+};
+
+// Calls the callbacks of discarded puts on a later tick, like the callbacks of any other operation.
+class DroppedPutsWorker : public NanAsyncWorker {
+ public:
+  explicit DroppedPutsWorker(const std::vector<NanCallback *> & callbacks) :
+      NanAsyncWorker(NULL),
+      callbacks(callbacks) {}
+
+  ~DroppedPutsWorker() {
+    for (std::vector<NanCallback *>::iterator iterator(callbacks.begin());
+         iterator != callbacks.end();
+         ++iterator) {
+      delete *iterator;
+    }
+  }
+
+  void Execute() {}
+
+  void HandleOKCallback() {
+    NanScope();
+
+    for (std::vector<NanCallback *>::iterator iterator(callbacks.begin());
+         iterator != callbacks.end();
+         ++iterator) {
+      static const int argc = 1;
+      Local<Value> argv[argc] = {
+        v8Error("SupersededError", "The buffered put was discarded before it was written.")
+      };
+      (*iterator)->Call(argc, argv);
+    }
+  }
+
+ private:
+  std::vector<NanCallback *> callbacks;
+};
+
+WriteBehindBuffer::WriteBehindBuffer(const RegionPtr & regionPtr,
+                                     uint64_t interval,
+                                     unsigned int maxEntries) :
+  interval(interval),
+  maxEntries(maxEntries),
+  regionPtr(regionPtr),
+  timer(new uv_timer_t),
+  timerActive(false),
+  flushing(false),
+  flushRequested(false),
+  closing(false),
+  puts(0),
+  conflated(0),
+  flushes(0),
+  flushedEntries(0),
+  flushErrors(0) {
+    uv_timer_init(uv_default_loop(), timer);
+    timer->data = this;
+  }
+
+WriteBehindBuffer::~WriteBehindBuffer() {
+  uv_timer_stop(timer);
+  uv_close(reinterpret_cast<uv_handle_t *>(timer), deleteTimer);
+
+  NanDisposePersistent(regionObject);
+}
+
+void WriteBehindBuffer::put(const Local<Object> & regionObject,
+                            const CacheableKeyPtr & keyPtr,
+                            const CacheablePtr & valuePtr,
+                            NanCallback * callback) {
+  hold(regionObject);
+
+  puts++;
+
+  Entries::iterator iterator(entries.find(keyPtr));
+  if (iterator == entries.end()) {
+    entries[keyPtr] = valuePtr;
+  } else {
+    iterator->second = valuePtr;
+    conflated++;
+  }
+
+  if (callback != NULL) {
+    callbacks.push_back(std::make_pair(keyPtr, callback));
+  }
+
+  if (entries.size() >= maxEntries) {
+    requestFlush();
+  } else if (!timerActive && !flushing) {
+    uv_timer_start(timer, timerCallback, interval, 0);
+    timerActive = true;
+  }
+}
+
+CacheablePtr WriteBehindBuffer::get(const CacheableKeyPtr & keyPtr) {
+  Entries::iterator iterator(entries.find(keyPtr));
+  if (iterator != entries.end()) {
+    return iterator->second;
+  }
+
+  iterator = flushingEntries.find(keyPtr);
+  if (iterator != flushingEntries.end()) {
+    return iterator->second;
+  }
+
+  return NULLPTR;
+}
+
+void WriteBehindBuffer::remove(const CacheableKeyPtr & keyPtr) {
+  flushingEntries.erase(keyPtr);
+
+  if (entries.erase(keyPtr) > 0) {
+    dropCallbacks(keyPtr);
+    failDroppedCallbacks();
+  }
+}
+
+void WriteBehindBuffer::remove(const HashMapOfCacheablePtr & hashMapPtr) {
+  if (hashMapPtr == NULLPTR) {
+    return;
+  }
+
+  for (HashMapOfCacheable::Iterator iterator = hashMapPtr->begin();
+       iterator != hashMapPtr->end();
+       iterator++) {
+    flushingEntries.erase(iterator.first());
+
+    if (entries.erase(iterator.first()) > 0) {
+      dropCallbacks(iterator.first());
+    }
+  }
+
+  failDroppedCallbacks();
+}
+
+void WriteBehindBuffer::clear() {
+  entries.clear();
+  flushingEntries.clear();
+  dropCallbacks(NULLPTR);
+  failDroppedCallbacks();
+}
+
+const KeyedWorkQueue::Keys & WriteBehindBuffer::keysInFlight() {
+  return flushingKeys;
+}
+
+void WriteBehindBuffer::flush(const Local<Object> & regionObject, NanCallback * callback) {
+  hold(regionObject);
+
+  if (callback != NULL) {
+    callbacks.push_back(std::make_pair(CacheableKeyPtr(NULLPTR), callback));
+  }
+
+  requestFlush();
+}
+
+void WriteBehindBuffer::close() {
+  closing = true;
+
+  if (!busy()) {
+    delete this;
+    return;
+  }
+
+  requestFlush();
+}
+
+bool WriteBehindBuffer::busy() {
+  return flushing || !entries.empty() || !callbacks.empty();
+}
+
+void WriteBehindBuffer::hold(const Local<Object> & regionObject) {
+  if (this->regionObject.IsEmpty()) {
+    NanAssignPersistent(this->regionObject, regionObject);
+  }
+}
+
+// Moves the callbacks of the puts of a key, or of every put when keyPtr is NULLPTR, to the dropped
+// callbacks. Flush callbacks stay.
+void WriteBehindBuffer::dropCallbacks(const CacheableKeyPtr & keyPtr) {
+  CacheableKeyEqual equal;
+  Callbacks remaining;
+  remaining.reserve(callbacks.size());
+
+  for (Callbacks::iterator iterator(callbacks.begin()); iterator != callbacks.end(); ++iterator) {
+    bool dropped = iterator->first != NULLPTR &&
+      (keyPtr == NULLPTR || equal(iterator->first, keyPtr));
+
+    if (dropped) {
+      droppedCallbacks.push_back(iterator->second);
+    } else {
+      remaining.push_back(*iterator);
+    }
+  }
+
+  callbacks.swap(remaining);
+}
+
+void WriteBehindBuffer::failDroppedCallbacks() {
+  if (droppedCallbacks.empty()) {
+    return;
+  }
+
+  NanAsyncQueueWorker(new DroppedPutsWorker(droppedCallbacks));
+  droppedCallbacks.clear();
+}
+
+void WriteBehindBuffer::requestFlush() {
+  if (flushing) {
+    flushRequested = true;
+    return;
+  }
+
+  startFlush();
+}
+
+void WriteBehindBuffer::startFlush() {
+  if (timerActive) {
+    uv_timer_stop(timer);
+    timerActive = false;
+  }
+
+  flushing = true;
+  flushRequested = false;
+  flushingEntries.swap(entries);
+  flushingCallbacks.swap(callbacks);
+
+  HashMapOfCacheablePtr hashMapPtr(new HashMapOfCacheable());
+  for (Entries::iterator iterator(flushingEntries.begin());
+       iterator != flushingEntries.end();
+       ++iterator) {
+    hashMapPtr->insert(iterator->first, iterator->second);
+    flushingKeys.push_back(iterator->first);
+  }
+
+  KeyedWorkQueue::getInstance()->queue(regionPtr,
+                                       flushingKeys,
+                                       new WriteBehindFlushWorker(this, regionPtr, hashMapPtr, flushingKeys));
+}
+
+void WriteBehindBuffer::flushed(const Local<Value> & error) {
+  NanScope();
+
+  Local<Object> regionObjectHandle(NanNew(regionObject));
+  bool failed = !error->IsUndefined();
+
+  flushes++;
+  if (failed) {
+    flushErrors++;
+  } else {
+    flushedEntries += flushingKeys.size();
+  }
+
+  Callbacks callbacksToCall;
+  callbacksToCall.swap(flushingCallbacks);
+  flushingEntries.clear();
+  flushingKeys.clear();
+  flushing = false;
+
+  if ((flushRequested || closing || entries.size() >= maxEntries) &&
+      (!entries.empty() || !callbacks.empty())) {
+    startFlush();
+  } else if (!entries.empty() && !timerActive) {
+    uv_timer_start(timer, timerCallback, interval, 0);
+    timerActive = true;
+  }
+
+  if (!busy()) {
+    NanDisposePersistent(regionObject);
+
+    if (closing) {
+      delete this;
+    }
+  }
+
+  // Nothing below may touch the buffer; the callbacks can re-enter it, and it may be gone.
+  if (failed && callbacksToCall.empty()) {
+    emitError(regionObjectHandle, error);
+  }
+
+  for (Callbacks::iterator iterator(callbacksToCall.begin());
+       iterator != callbacksToCall.end();
+       ++iterator) {
+    NanCallback * callback(iterator->second);
+
+    if (failed) {
+      static const int argc = 1;
+      Local<Value> argv[argc] = { error };
+      callback->Call(argc, argv);
+    } else {
+      callback->Call(0, NULL);
+    }
+
+    delete callback;
+  }
+}
+
+void WriteBehindBuffer::timerCallback(uv_timer_t * timer, int status) {
+  WriteBehindBuffer * writeBehindBuffer = reinterpret_cast<WriteBehindBuffer *>(timer->data);
+  writeBehindBuffer->timerActive = false;
+  writeBehindBuffer->requestFlush();
+}
+
+void WriteBehindBuffer::deleteTimer(uv_handle_t * handle) {
+  delete reinterpret_cast<uv_timer_t *>(handle);
+}
+
+Local<Object> WriteBehindBuffer::statistics() {
+  NanEscapableScope();
+
+  Local<Object> statistics(NanNew<Object>());
+  statistics->Set(NanNew("interval"), NanNew<Number>(interval));
+  statistics->Set(NanNew("maxEntries"), NanNew(maxEntries));
+  statistics->Set(NanNew("buffered"), NanNew(static_cast<unsigned int>(entries.size())));
+  statistics->Set(NanNew("flushing"), NanNew(static_cast<unsigned int>(flushingKeys.size())));
+  statistics->Set(NanNew("puts"), NanNew(puts));
+  statistics->Set(NanNew("conflated"), NanNew(conflated));
+  statistics->Set(NanNew("flushes"), NanNew(flushes));
+  statistics->Set(NanNew("flushedEntries"), NanNew(flushedEntries));
+  statistics->Set(NanNew("flushErrors"), NanNew(flushErrors));
+
+  return NanEscapeScope(statistics);
+}
+
+}  // namespace node_gemfire
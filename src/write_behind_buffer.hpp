@@ -0,0 +1,112 @@
+#ifndef __WRITE_BEHIND_BUFFER_HPP__
+#define __WRITE_BEHIND_BUFFER_HPP__
+
+#include <v8.h>
+#include <nan.h>
+#include <gfcpp/CacheableKey.hpp>
+#include <gfcpp/Cacheable.hpp>
+#include <gfcpp/HashMapOfCacheable.hpp>
+#include <gfcpp/Region.hpp>
+#include <uv.h>
+#include <stdint.h>
+#include <tr1/unordered_map>
+#include <utility>
+#include <vector>
+#include "cacheable_key_functors.hpp"
+#include "keyed_work_queue.hpp"
+
+namespace node_gemfire {
+
+// Collects puts for a region and writes them to the server in batches with putAll. Repeated puts
+// of the same key before a flush are conflated, so only the latest value is sent.
+//
+// A flush starts when the oldest buffered put is `interval` milliseconds old, when `maxEntries`
+// keys are buffered, or when flush() is called. Only one flush runs at a time, so batches reach
+// the server in the order they were buffered. A flush holds its keys in the KeyedWorkQueue, so
+// writes of those keys made after it started, and clears, run once it has finished.
+//
+// Puts discarded by a remove, a direct write of their key or a clear before they were flushed never
+// reach the server, and their callbacks are called with a SupersededError. Puts discarded while
+// their flush is running are still written, but are no longer returned by get().
+//
+// Only accessed from the main thread.
+class WriteBehindBuffer {
+ public:
+  WriteBehindBuffer(const gemfire::RegionPtr & regionPtr, uint64_t interval, unsigned int maxEntries);
+
+  void put(const v8::Local<v8::Object> & regionObject,
+           const gemfire::CacheableKeyPtr & keyPtr,
+           const gemfire::CacheablePtr & valuePtr,
+           NanCallback * callback);
+  gemfire::CacheablePtr get(const gemfire::CacheableKeyPtr & keyPtr);
+  void remove(const gemfire::CacheableKeyPtr & keyPtr);
+  void remove(const gemfire::HashMapOfCacheablePtr & hashMapPtr);
+  void clear();
+
+  // The keys held by the flush in flight, for a clear to wait behind.
+  const KeyedWorkQueue::Keys & keysInFlight();
+
+  void flush(const v8::Local<v8::Object> & regionObject, NanCallback * callback);
+
+  // Flushes whatever is still buffered and deletes the buffer once that flush has finished.
+  void close();
+
+  void flushed(const v8::Local<v8::Value> & error);
+
+  v8::Local<v8::Object> statistics();
+
+  const uint64_t interval;
+  const unsigned int maxEntries;
+
+ private:
+  typedef std::tr1::unordered_map<gemfire::CacheableKeyPtr,
+                                  gemfire::CacheablePtr,
+                                  CacheableKeyHash,
+                                  CacheableKeyEqual> Entries;
+  // The key of the put a callback belongs to, or NULLPTR for the callback of a flush.
+  typedef std::vector<std::pair<gemfire::CacheableKeyPtr, NanCallback *> > Callbacks;
+
+  ~WriteBehindBuffer();
+
+  bool busy();
+  void hold(const v8::Local<v8::Object> & regionObject);
+  void requestFlush();
+  void startFlush();
+  void dropCallbacks(const gemfire::CacheableKeyPtr & keyPtr);
+  void failDroppedCallbacks();
+
+  static void timerCallback(uv_timer_t * timer, int status);
+  static void deleteTimer(uv_handle_t * handle);
+
+  gemfire::RegionPtr regionPtr;
+
+  // The region object is kept alive while anything is buffered or being flushed.
+  v8::Persistent<v8::Object> regionObject;
+
+  Entries entries;
+  Callbacks callbacks;
+
+  // The keys written by the flush in flight, and the values of those that weren't discarded since.
+  KeyedWorkQueue::Keys flushingKeys;
+  Entries flushingEntries;
+  Callbacks flushingCallbacks;
+
+  // Callbacks of buffered puts that were discarded before they were flushed.
+  std::vector<NanCallback *> droppedCallbacks;
+
+  uv_timer_t * timer;
+  bool timerActive;
+  bool flushing;
+  bool flushRequested;
+  bool closing;
+
+  unsigned int puts;
+  unsigned int conflated;
+  unsigned int flushes;
+  unsigned int flushedEntries;
+  unsigned int flushErrors;
+};
+
+}  // namespace node_gemfire
+
+#endif